@@ -0,0 +1,313 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			MIDI Capture / Replay for RPi - Linux
+Filename:		Capture.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Records every MIDI chunk read from the UART with its ingest timestamp,
+				and replays such a file back through the Serial read event.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Record - './MOLink -r session.mid.cap'
+	  Chunks are appended to a mmap'd window from the UART read thread, the file
+	  grows CAPTURE_CHUNK at a time and is trimmed on close. A crashed capture is
+	  still readable, replay stops at the first empty record.
+	# Replay - './MOLink -p session.mid.cap [-s speed]'
+	  Speed 1 is real time, 4 is four times faster, 0 is as fast as possible.
+	  Chunks are injected with Serial::Inject(), i.e. OnMIDIRead() sees exactly what
+	  the UART read thread delivered during the session.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <stdio.h>												// printf()
+#include <string.h>												// memcpy()
+#include <unistd.h>												// ftruncate(), pwrite()
+#include <fcntl.h>												// open()
+#include <time.h>												// clock_gettime()
+#include <sys/mman.h>											// mmap()
+#include <sys/stat.h>											// fstat()
+#include "Capture.h"											// Capture Class
+#include "Serial.h"												// Serial Class
+#include "Clock.h"												// Replay time source
+
+// ------------------------------------------------------------------------------------ //
+// Constructor
+MIDICapture::MIDICapture()
+{
+	Fd = -1;													// Initialise File Descriptor as error
+	Recording = false;											//
+	Map = NULL;													//
+	MapOfs = 0;													//
+	MapSize = 0;												//
+	Pos = 0;													//
+	Start = 0;													//
+	Records = 0;												//
+	ReplayActive = false;										//
+	ReplayJoin = false;											//
+	ReplayPort = NULL;											//
+	ReplaySpeed = REPLAY_REALTIME;								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+MIDICapture::~MIDICapture()
+{
+	Close();													// Close file & thread
+}
+
+// ------------------------------------------------------------------------------------ //
+// Open (Create) a capture file for recording
+bool MIDICapture::OpenRecord(const char *FileName)
+{
+	CaptureHeader Hdr;											//
+	struct timespec Ts;											//
+
+	Close();													//
+
+	if((Fd = open(FileName, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0){
+		printf("\r\nERROR!!! Can't Open Capture File...\r\n");
+		return false;
+	}
+
+	memset(&Hdr, 0, sizeof(Hdr));								// Header
+	Hdr.Magic = CAPTURE_MAGIC;									//
+	Hdr.Version = CAPTURE_VERSION;								//
+	clock_gettime(CLOCK_REALTIME, &Ts);							//
+	Hdr.RealStart = ((uint64_t)Ts.tv_sec * 1000000000ULL) + Ts.tv_nsec;
+	if(pwrite(Fd, &Hdr, sizeof(Hdr), 0) != sizeof(Hdr)){		// Write header
+		printf("\r\nERROR!!! Can't Write Capture File...\r\n");
+		Close();
+		return false;
+	}
+
+	Recording = true;											//
+	Pos = sizeof(CaptureHeader);								// First record
+	Records = 0;												//
+	Start = CLK->Now();											//
+	if(!MapWindow(Pos)){										// Map first window
+		Close();												//
+		return false;											//
+	}
+
+	return true;												// Return Success
+}
+
+// ------------------------------------------------------------------------------------ //
+// Record mode. Map CAPTURE_CHUNK bytes of the file from the page holding Ofs.
+bool MIDICapture::MapWindow(size_t Ofs)
+{
+	size_t Page = sysconf(_SC_PAGESIZE);						//
+
+	if(Map != NULL){											// Drop old window
+		munmap(Map, MapSize);									//
+		Map = NULL;												//
+	}
+
+	MapOfs = Ofs & ~(Page - 1);									// Window start (Page aligned)
+	MapSize = CAPTURE_CHUNK;									//
+	if(ftruncate(Fd, MapOfs + MapSize) != 0){					// Grow file
+		printf("\r\nERROR!!! Can't Size Capture File...\r\n");
+		return false;
+	}
+	Map = (uint8_t *)mmap(NULL, MapSize, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, MapOfs);
+	if(Map == MAP_FAILED){										// Mapped?
+		printf("\r\nERROR!!! Can't Map Capture File...\r\n");
+		Map = NULL;
+		return false;
+	}
+
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Open capture file for replay (Maps the whole file read only)
+bool MIDICapture::OpenReplay(const char *FileName)
+{
+	struct stat St;												//
+	const CaptureHeader *Hdr;									//
+
+	Close();													//
+
+	if(((Fd = open(FileName, O_RDONLY)) < 0)||(fstat(Fd, &St) != 0)){
+		printf("\r\nERROR!!! Can't Open Capture File...\r\n");
+		Close();
+		return false;
+	}
+	if((size_t)St.st_size < sizeof(CaptureHeader)){			// Too small?
+		printf("\r\nERROR!!! Not a Capture File...\r\n");
+		Close();
+		return false;
+	}
+
+	MapOfs = 0;													//
+	MapSize = St.st_size;										//
+	Map = (uint8_t *)mmap(NULL, MapSize, PROT_READ, MAP_PRIVATE, Fd, 0);
+	if(Map == MAP_FAILED){										// Mapped?
+		printf("\r\nERROR!!! Can't Map Capture File...\r\n");
+		Map = NULL;
+		Close();
+		return false;
+	}
+
+	Hdr = (const CaptureHeader *)Map;							//
+	if((Hdr->Magic != CAPTURE_MAGIC)||(Hdr->Version != CAPTURE_VERSION)){
+		printf("\r\nERROR!!! Unsupported Capture File...\r\n");
+		Close();
+		return false;
+	}
+
+	Recording = false;											//
+	Pos = sizeof(CaptureHeader);								// First record
+
+	return true;												// Return Success
+}
+
+// ------------------------------------------------------------------------------------ //
+// Close. Record mode trims the file and completes the header.
+void MIDICapture::Close(void)
+{
+	CaptureHeader Hdr;											//
+
+	if(ReplayJoin){												// Replay started?
+		__atomic_store_n(&ReplayActive, false, __ATOMIC_RELEASE);	// Stop & wait
+		pthread_join(ReplayThreadId, NULL);						//
+		ReplayJoin = false;										//
+	}
+
+	if(Map != NULL){											// Mapped?
+		munmap(Map, MapSize);									//
+		Map = NULL;												//
+	}
+
+	if(Fd >= 0){												// Open?
+		if(Recording){											// Finish capture file
+			if(pread(Fd, &Hdr, sizeof(Hdr), 0) == sizeof(Hdr)){	//
+				Hdr.Records = Records;							//
+				Hdr.Length = Pos - sizeof(CaptureHeader);		//
+				(void)pwrite(Fd, &Hdr, sizeof(Hdr), 0);			//
+			}
+			(void)ftruncate(Fd, Pos);							// Drop unused tail
+		}
+		close(Fd);												//
+		Fd = -1;												//
+	}
+	Recording = false;											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Record a chunk. Called from the UART read thread only.
+void MIDICapture::Record(const char *Data, int Len)
+{
+	CaptureRecord *Rec;											//
+	uint64_t Time = CLK->Now() - Start;							// Ingest time
+	size_t Size;												//
+
+	if((!Recording)||(Map == NULL)||(Len <= 0)){				// Not recording?
+		return;													//
+	}
+	if(Len > CAPTURE_LEN_MAX){									// Too large for one record?
+		Len = CAPTURE_LEN_MAX;									//
+	}
+
+	Size = CAPTURE_SIZE(Len);									//
+	if(Pos + Size > MapOfs + MapSize){							// Past window?
+		if(!MapWindow(Pos)){									// Map next window
+			Recording = false;									// Give up (Disk full?)
+			return;												//
+		}
+	}
+
+	Rec = (CaptureRecord *)&Map[Pos - MapOfs];					//
+	memcpy(Rec->Data, Data, Len);								// Data first,
+	Rec->Stamp = CAPTURE_TIME(Time) | ((uint64_t)Len << 48);	// then the stamp marks it valid
+	Pos += Size;												//
+	Records++;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Start replay thread. Speed 0 = ASAP, 1 = real time, n = n times faster.
+bool MIDICapture::StartReplay(Serial *Port, float Speed)
+{
+	if((Map == NULL)||Recording||IsReplaying()||(Port == NULL)){	// Not open for replay?
+		return false;											//
+	}
+
+	ReplayPort = Port;											//
+	ReplaySpeed = (Speed < 0) ? REPLAY_ASAP : Speed;			//
+	__atomic_store_n(&ReplayActive, true, __ATOMIC_RELEASE);	// Before the thread reads it
+	CLK->Expect("Replay");										// Virtual time: announce thread
+	if(pthread_create(&ReplayThreadId, NULL, (void* (*)(void*))&MIDICapture::ReplayThread, this) != 0){
+		printf("\r\nERROR!!! Can't create Replay Thread...\r\n");
+		__atomic_store_n(&ReplayActive, false, __ATOMIC_RELEASE);	//
+		return false;
+	}
+	ReplayJoin = true;											//
+
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Replay still running?
+bool MIDICapture::IsReplaying(void)
+{
+	return __atomic_load_n(&ReplayActive, __ATOMIC_ACQUIRE);	//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Ask the replay thread to stop after the current record (Doesn't wait)
+void MIDICapture::StopReplay(void)
+{
+	__atomic_store_n(&ReplayActive, false, __ATOMIC_RELEASE);	//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Replay Thread. Sleeps to each record's (scaled) absolute time and injects it.
+void *MIDICapture::ReplayThread(MIDICapture *C)
+{
+	const CaptureRecord *Rec;									//
+	uint64_t Due, Begin, Elapsed;								//
+	uint32_t Len, Count = 0;									//
+	uint64_t Bytes = 0;											//
+	size_t Pos = C->Pos;										//
+
+	CLK->Attach("Replay");										// Virtual time: join clock
+	Begin = CLK->Now();											//
+	while(__atomic_load_n(&C->ReplayActive, __ATOMIC_ACQUIRE) && (Pos + sizeof(CaptureRecord) <= C->MapSize)){
+		Rec = (const CaptureRecord *)&C->Map[Pos];				//
+		Len = CAPTURE_LEN(Rec->Stamp);							//
+		if((Len == 0)||(Pos + CAPTURE_SIZE(Len) > C->MapSize)){	// End of (possibly crashed) capture?
+			break;												//
+		}
+
+		if(CLK->IsVirtual()){									// Virtual time? Always paced, costs nothing
+			CLK->SleepUntil(Begin + CAPTURE_TIME(Rec->Stamp));	//
+		}else if(C->ReplaySpeed > 0){							// Paced?
+			Due = Begin + (uint64_t)(CAPTURE_TIME(Rec->Stamp) / C->ReplaySpeed);
+			CLK->SleepUntil(Due);								// Absolute deadline, no drift
+		}
+
+		C->ReplayPort->Inject((const char *)Rec->Data, Len);	// Through the read event
+		Pos += CAPTURE_SIZE(Len);								//
+		Bytes += Len;											//
+		Count++;												//
+	}
+	Elapsed = CLK->Now() - Begin;								//
+
+	printf("\r\nReplay: %u chunk(s), %llu byte(s) in %.3f s", Count, (unsigned long long)Bytes, Elapsed / 1e9);
+	if(Elapsed > 0){											//
+		printf(" (%.0f chunks/s, %.0f ns/chunk)", Count / (Elapsed / 1e9), (Count > 0) ? (double)Elapsed / Count : 0.0);
+	}
+	printf("\r\n");
+
+	__atomic_store_n(&C->ReplayActive, false, __ATOMIC_RELEASE);	// Done
+	CLK->Detach();												// Virtual time: leave clock
+	return NULL;
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
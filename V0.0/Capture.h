@@ -0,0 +1,94 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			MIDI Capture / Replay Header for RPi - Linux
+Filename:		Capture.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Records every MIDI chunk read from the UART with its ingest timestamp,
+				and replays such a file back through the Serial read event.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _CAPTURE_H
+#define _CAPTURE_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdint.h>												// Fixed width types
+#include <stddef.h>												// size_t
+#include <pthread.h>											// Threads
+#include "config.h"												// General Configuration File
+
+class Serial;													// Serial Class (Serial.h)
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define CAPTURE_MAGIC		0x314944494D4B4C4DULL				// "MLKMIDI1"
+#define CAPTURE_VERSION		1									// File format version
+#define CAPTURE_CHUNK		(1024 * 1024)						// File grows (and is mapped) 1MB at a time
+#define CAPTURE_LEN_MAX		0xFFFF								// Largest chunk in one record
+
+#define REPLAY_ASAP			0.0f								// Replay speed, as fast as possible
+#define REPLAY_REALTIME		1.0f								// Replay speed, real time
+
+// -------------------------------------------------------------------------------------
+// File Layout (All little-endian, records 8 byte aligned)
+typedef struct _captureHeader{
+	uint64_t Magic;												// CAPTURE_MAGIC
+	uint32_t Version;											// CAPTURE_VERSION
+	uint32_t Records;											// Records written (0 if not closed cleanly)
+	uint64_t RealStart;											// CLOCK_REALTIME at start (nS)
+	uint64_t Length;											// Bytes of records after the header
+} CaptureHeader;												// 32 bytes
+
+typedef struct _captureRecord{
+	uint64_t Stamp;												// Bits 0-47: nS since start, Bits 48-63: Length
+	uint8_t Data[];												// MIDI bytes, padded to 8
+} CaptureRecord;
+
+#define CAPTURE_TIME(S)		((S) & 0xFFFFFFFFFFFFULL)			// Record time (nS)
+#define CAPTURE_LEN(S)		((uint32_t)((S) >> 48))				// Record length
+#define CAPTURE_SIZE(L)		((sizeof(CaptureRecord) + (L) + 7) & ~7UL)	// Record size on disk
+
+// -------------------------------------------------------------------------------------
+// Define Capture Class
+class MIDICapture
+{
+private:
+	int Fd;														// Capture file
+	bool Recording;												// Record mode
+	uint8_t *Map;												// Mapped window / file
+	size_t MapOfs;												// File offset of Map
+	size_t MapSize;												// Size of Map
+	size_t Pos;													// Write / read position (file offset)
+	uint64_t Start;												// Monotonic start time (nS)
+	uint32_t Records;											// Records written
+
+	pthread_t ReplayThreadId;									//
+	bool ReplayActive;											//
+	bool ReplayJoin;											// Thread needs joining
+	Serial *ReplayPort;											// Replay destination
+	float ReplaySpeed;											// 0 = ASAP, 1 = real time, 2 = double...
+
+	bool MapWindow(size_t Ofs);									// Record mode, map next window
+	static void *ReplayThread(MIDICapture *);					//
+
+public:
+	MIDICapture();												//
+	~MIDICapture();												//
+
+	bool OpenRecord(const char *FileName);						// Create capture file
+	bool OpenReplay(const char *FileName);						// Open capture file for replay
+	void Close(void);											//
+
+	void Record(const char *Data, int Len);						// Append chunk (UART read thread)
+	bool StartReplay(Serial *Port, float Speed);				// Feed file to Port's read event
+	bool IsReplaying(void);										//
+	void StopReplay(void);										// Ask replay to stop (Close() waits for it)
+};
+
+// -------------------------------------------------------------------------------------
+#endif
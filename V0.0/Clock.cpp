@@ -0,0 +1,324 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			Clock for RPi - Linux
+Filename:		Clock.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Real and virtual time sources.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Clock - CLOCK_MONOTONIC, sleeps are clock_nanosleep(TIMER_ABSTIME), so a
+	  periodic loop built on SleepUntil() never drifts.
+	# VirtualClock - Deterministic. Attached threads hand a baton to each other:
+	  only one runs at a time, and when it sleeps the thread with the earliest
+	  wake up time (ties in order of going to sleep) gets the baton and virtual
+	  time jumps to its deadline. Nothing waits in real time.
+	  A thread that will attach must be announced by its creator with Expect(),
+	  so the order of events doesn't depend on how fast the OS starts it.
+	  Virtual time starts at CLOCK_VIRTUAL_START, not 0: 0 is 'never' for the
+	  times everyone keeps, and the start is on an event loop tick. The
+	  simulation log, GPIO script and time tags count from there.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <string.h>												// strncpy(), strcmp()
+#include <errno.h>												// EINTR
+#include <time.h>												// clock_gettime(), clock_nanosleep()
+#include "Clock.h"												// Clock Classes
+
+// ------------------------------------------------------------------------------------ //
+// Virtual Clock Thread States
+enum
+{
+	CLK_FREE = 0,												// Slot unused
+	CLK_EXPECTED,												// Creator announced it, not attached yet
+	CLK_READY,													// Attached, sleeping
+	CLK_RUNNING													// Holds the baton
+};
+
+// ------------------------------------------------------------------------------------ //
+// Globals
+static Clock RealTime;											// Default clock
+Clock *CLK = &RealTime;											// Global Clock
+
+static __thread int ThreadSlot = -1;							// Calling thread's Virtual Clock slot
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
+// Real Time Clock
+// ------------------------------------------------------------------------------------ //
+// Constructor
+Clock::Clock()
+{
+
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+Clock::~Clock()
+{
+
+}
+
+// ------------------------------------------------------------------------------------ //
+// CLOCK_MONOTONIC in nano seconds
+uint64_t Clock::Now(void)
+{
+	struct timespec Ts;											//
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);						//
+	return ((uint64_t)Ts.tv_sec * NS_PER_SEC) + Ts.tv_nsec;		//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Sleep until absolute time Due (nS)
+void Clock::SleepUntil(uint64_t Due)
+{
+	struct timespec Ts;											//
+
+	Ts.tv_sec = Due / NS_PER_SEC;								//
+	Ts.tv_nsec = Due % NS_PER_SEC;								//
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &Ts, NULL) == EINTR){}	// Restart on signals
+}
+
+// ------------------------------------------------------------------------------------ //
+bool Clock::IsVirtual(void)
+{
+	return false;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Real time threads don't need announcing
+void Clock::Expect(const char *Name)
+{
+	(void)Name;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+void Clock::Attach(const char *Name)
+{
+	(void)Name;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+void Clock::Detach(void)
+{
+
+}
+
+// ------------------------------------------------------------------------------------ //
+// Relative sleep (nS)
+void Clock::Sleep(uint64_t Ns)
+{
+	SleepUntil(Now() + Ns);										//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Relative sleep (mS)
+void Clock::SleepMs(int Ms)
+{
+	if(Ms > 0){													//
+		SleepUntil(Now() + ((uint64_t)Ms * NS_PER_MS));			//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
+// Virtual Clock
+// ------------------------------------------------------------------------------------ //
+// Constructor
+VirtualClock::VirtualClock(uint64_t Start)
+{
+	pthread_mutex_init(&Mutex, NULL);							//
+	pthread_cond_init(&Advance, NULL);							//
+	Time = Start;												//
+	Seq = 0;													//
+	Running = -1;												// Nobody has the baton
+	for(int Ptr = 0; Ptr < CLOCK_THREADS; Ptr++){				//
+		memset(Threads[Ptr].Name, 0, CLOCK_NAME_MAX);			//
+		Threads[Ptr].State = CLK_FREE;							//
+		Threads[Ptr].Due = 0;									//
+		Threads[Ptr].Seq = 0;									//
+		pthread_cond_init(&Threads[Ptr].Cond, NULL);			//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+VirtualClock::~VirtualClock()
+{
+	for(int Ptr = 0; Ptr < CLOCK_THREADS; Ptr++){				//
+		pthread_cond_destroy(&Threads[Ptr].Cond);				//
+	}
+	pthread_cond_destroy(&Advance);								//
+	pthread_mutex_destroy(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Virtual time in nano seconds
+uint64_t VirtualClock::Now(void)
+{
+	return __atomic_load_n(&Time, __ATOMIC_ACQUIRE);			// Only the baton holder moves it
+}
+
+// ------------------------------------------------------------------------------------ //
+bool VirtualClock::IsVirtual(void)
+{
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Pass the baton to the earliest sleeper. Mutex must be held.
+void VirtualClock::Schedule(void)
+{
+	int Best = -1;												//
+
+	for(int Ptr = 0; Ptr < CLOCK_THREADS; Ptr++){				//
+		if(Threads[Ptr].State == CLK_EXPECTED){					// Thread still starting?
+			Running = -1;										// Its Attach() will schedule
+			return;												//
+		}
+		if((Threads[Ptr].State == CLK_READY)&&((Best < 0)||
+		   (Threads[Ptr].Due < Threads[Best].Due)||
+		   ((Threads[Ptr].Due == Threads[Best].Due)&&(Threads[Ptr].Seq < Threads[Best].Seq)))){
+			Best = Ptr;											//
+		}
+	}
+	if(Best < 0){												// Nobody left?
+		Running = -1;											//
+		return;													//
+	}
+
+	if(Threads[Best].Due > Time){								// Jump forward
+		__atomic_store_n(&Time, Threads[Best].Due, __ATOMIC_RELEASE);
+		pthread_cond_broadcast(&Advance);						// Unattached sleepers
+	}
+	Running = Best;												//
+	Threads[Best].State = CLK_RUNNING;							//
+	pthread_cond_signal(&Threads[Best].Cond);					// Wake it (no-op if it's us)
+}
+
+// ------------------------------------------------------------------------------------ //
+// Sleep until virtual time Due
+void VirtualClock::SleepUntil(uint64_t Due)
+{
+	int Self = ThreadSlot;										//
+
+	pthread_mutex_lock(&Mutex);									//
+	if(Self < 0){												// Not attached? Just wait for time to pass.
+		while(Time < Due){										//
+			pthread_cond_wait(&Advance, &Mutex);				//
+		}
+		pthread_mutex_unlock(&Mutex);							//
+		return;													//
+	}
+
+	Threads[Self].Due = (Due > Time) ? Due : Time;				//
+	Threads[Self].Seq = ++Seq;									//
+	Threads[Self].State = CLK_READY;							//
+	Schedule();													// Pass the baton
+	pthread_cleanup_push(&VirtualClock::SleepCleanup, this);	// pthread_cancel() while waiting
+	while(Running != Self){										// Wait for the baton
+		pthread_cond_wait(&Threads[Self].Cond, &Mutex);			//
+	}
+	pthread_cleanup_pop(0);										//
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Thread cancelled while asleep. Leave the clock and release the mutex.
+void VirtualClock::SleepCleanup(void *Arg)
+{
+	VirtualClock *C = (VirtualClock *)Arg;						//
+	int Self = ThreadSlot;										//
+
+	C->Threads[Self].State = CLK_FREE;							//
+	ThreadSlot = -1;											//
+	if(C->Running == Self){										// Had the baton?
+		C->Schedule();											//
+	}
+	pthread_mutex_unlock(&C->Mutex);							//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Announce a thread. Called by its creator (holding the baton) before pthread_create().
+void VirtualClock::Expect(const char *Name)
+{
+	pthread_mutex_lock(&Mutex);									//
+	for(int Ptr = 0; Ptr < CLOCK_THREADS; Ptr++){				//
+		if(Threads[Ptr].State == CLK_FREE){						// Free slot?
+			strncpy(Threads[Ptr].Name, Name, CLOCK_NAME_MAX - 1);
+			Threads[Ptr].Due = Time;							// Runnable now,
+			Threads[Ptr].Seq = ++Seq;							// after everybody already waiting
+			Threads[Ptr].State = CLK_EXPECTED;					//
+			break;												//
+		}
+	}
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Calling thread joins the clock and waits for the baton
+void VirtualClock::Attach(const char *Name)
+{
+	int Self = -1;												//
+
+	pthread_mutex_lock(&Mutex);									//
+	for(int Ptr = 0; Ptr < CLOCK_THREADS; Ptr++){				// Announced?
+		if((Threads[Ptr].State == CLK_EXPECTED)&&(strcmp(Threads[Ptr].Name, Name) == 0)){
+			Self = Ptr;											//
+			break;												//
+		}
+	}
+	if(Self < 0){												// Not announced (First thread)
+		for(int Ptr = 0; Ptr < CLOCK_THREADS; Ptr++){			//
+			if(Threads[Ptr].State == CLK_FREE){					//
+				Self = Ptr;										//
+				strncpy(Threads[Ptr].Name, Name, CLOCK_NAME_MAX - 1);
+				Threads[Ptr].Due = Time;						//
+				Threads[Ptr].Seq = ++Seq;						//
+				break;											//
+			}
+		}
+	}
+	if(Self < 0){												// Full, run unattached
+		pthread_mutex_unlock(&Mutex);							//
+		return;													//
+	}
+
+	ThreadSlot = Self;											//
+	Threads[Self].State = CLK_READY;							//
+	if(Running < 0){											// Nobody running?
+		Schedule();												//
+	}
+	while(Running != Self){										// Wait for the baton
+		pthread_cond_wait(&Threads[Self].Cond, &Mutex);			//
+	}
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Calling thread leaves the clock (Before it exits)
+void VirtualClock::Detach(void)
+{
+	int Self = ThreadSlot;										//
+
+	if(Self < 0){												// Not attached?
+		return;													//
+	}
+	pthread_mutex_lock(&Mutex);									//
+	Threads[Self].State = CLK_FREE;								//
+	ThreadSlot = -1;											//
+	if(Running == Self){										// Had the baton?
+		Schedule();												//
+	}
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
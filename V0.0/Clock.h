@@ -0,0 +1,99 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			Clock Header for RPi - Linux
+Filename:		Clock.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Time source for everything that reads the time or sleeps. Clock is
+				the real CLOCK_MONOTONIC, VirtualClock runs the attached threads one
+				at a time in deadline order so a simulation is repeatable and runs
+				as fast as the CPU allows.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _CLOCK_H
+#define _CLOCK_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdint.h>												// Fixed width types
+#include <pthread.h>											// Threads
+#include "config.h"												// General Configuration File
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define CLOCK_THREADS		16									// Virtual Clock, max. attached threads
+#define CLOCK_NAME_MAX		16									// Thread name length
+
+#define NS_PER_US			1000ULL								//
+#define NS_PER_MS			1000000ULL							//
+#define NS_PER_SEC			1000000000ULL						//
+#define CLOCK_VIRTUAL_START	NS_PER_MS							// Virtual time starts at 1 mS, so 0 stays 'never'
+
+// -------------------------------------------------------------------------------------
+// Define Clock Class (Real time)
+class Clock
+{
+public:
+	Clock();													//
+	virtual ~Clock();											//
+
+	virtual uint64_t Now(void);									// Monotonic time in nS
+	virtual void SleepUntil(uint64_t Due);						// Sleep to absolute time (nS)
+	virtual bool IsVirtual(void);								//
+
+	virtual void Expect(const char *Name);						// About to create thread 'Name'
+	virtual void Attach(const char *Name);						// Calling thread joins the clock
+	virtual void Detach(void);									// Calling thread leaves the clock
+
+	void Sleep(uint64_t Ns);									// Relative sleep (nS)
+	void SleepMs(int Ms);										// Relative sleep (mS)
+};
+
+// -------------------------------------------------------------------------------------
+// Virtual Clock Participant
+typedef struct _clockThread{
+	char Name[CLOCK_NAME_MAX];									// Thread name
+	int State;													// CLK_FREE...
+	uint64_t Due;												// Wake up time
+	uint64_t Seq;												// Tie break (order of sleeping)
+	pthread_cond_t Cond;										// Wake up signal
+} ClockThread;
+
+// -------------------------------------------------------------------------------------
+// Define Virtual Clock Class
+class VirtualClock : public Clock
+{
+private:
+	pthread_mutex_t Mutex;										//
+	pthread_cond_t Advance;										// Time moved (Unattached sleepers)
+	uint64_t Time;												// Virtual time (nS)
+	uint64_t Seq;												// Sleep counter
+	int Running;												// Thread holding the baton (-1 = none)
+	ClockThread Threads[CLOCK_THREADS];							//
+
+	void Schedule(void);										// Pass the baton (Mutex held)
+	static void SleepCleanup(void *Arg);						// Thread cancelled while asleep
+
+public:
+	VirtualClock(uint64_t Start = CLOCK_VIRTUAL_START);			//
+	~VirtualClock();											//
+
+	uint64_t Now(void);											//
+	void SleepUntil(uint64_t Due);								//
+	bool IsVirtual(void);										//
+
+	void Expect(const char *Name);								//
+	void Attach(const char *Name);								//
+	void Detach(void);											//
+};
+
+// -------------------------------------------------------------------------------------
+// Global Clock (Real time unless a simulation replaces it)
+extern Clock *CLK;												//
+
+// -------------------------------------------------------------------------------------
+#endif
@@ -0,0 +1,245 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			MIDI Clock Out for RPi - Linux
+Filename:		ClockOut.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	MIDI clock generator, MOLink as the tempo master.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Every tick deadline comes from the beat phase grid (Last tap + N x tick
+	  period), never from the previous tick or from when the thread woke up, so
+	  wake up latency and tempo rounding can't add up. An hour at 120 BPM is
+	  86400 ticks and the last one is due exactly where the first one said.
+	# Error feedback: the thread wakes Lead nS before the deadline, Lead follows
+	  how late the writes are (CLOCK_OUT_LEAD_GAIN), so on average the tick goes
+	  out on its deadline rather than one scheduler latency after it. Real clock
+	  only, virtual time has no latency.
+	# Ticks skip the MIDI OUT queue (Serial::WriteRealtime()), they wait behind
+	  TX_AHEAD bytes at most however much is queued. A realtime byte may go in
+	  between the bytes of any other message.
+	# Start is held back to just before a downbeat tick (The slave starts on the
+	  first tick after Start), Continue to just before the next tick, Stop goes
+	  out at once. Ticks keep going while stopped so slaves keep the tempo.
+	# Jitter = interval between two writes - interval between their deadlines,
+	  so tempo changes and taps don't show up as jitter.
+	# Further behind than CLOCK_OUT_RESYNC (Stalled, disabled) restarts from now,
+	  the ticks in between are counted as dropped. Below that, late ticks are
+	  sent late rather than dropped, slaves count ticks.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <math.h>												// llround(), sqrt()
+#include <stdlib.h>												// llabs()
+#include "ClockOut.h"											// MIDI Clock Out Class
+#include "MIDI.h"												// MIDI Status Bytes
+#include "Clock.h"												// Time source
+#include "Trace.h"												// Flight Recorder
+
+// ------------------------------------------------------------------------------------ //
+// Constructor
+MIDIClockOut::MIDIClockOut()
+{
+	Port = NULL;												//
+	Phase = NULL;												//
+	Active = false;												//
+	Join = false;												//
+	Enabled = false;											//
+	Playing = false;											//
+	Pending = 0;												//
+	pthread_mutex_init(&Mutex, NULL);							//
+	Ticks = Dropped = Intervals = 0;							//
+	JitSq = 0;													//
+	JitMax = 0;													//
+	LateSum = 0;												//
+	LateMax = 0;												//
+	Lead = 0;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+MIDIClockOut::~MIDIClockOut()
+{
+	Close();													//
+	pthread_mutex_destroy(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Start the clock thread, ticks on Grid go to Out once enabled. Returns true if OK.
+bool MIDIClockOut::Open(Serial *Out, BeatPhase *Grid)
+{
+	if((Out == NULL)||(Grid == NULL)||Active){					//
+		return false;											//
+	}
+	Port = Out;													//
+	Phase = Grid;												//
+	Active = true;												//
+	CLK->Expect("MIDI Clock");									// Virtual time: announce thread
+	if(pthread_create(&ThreadId, NULL, (void* (*)(void*))&MIDIClockOut::ClockThread, this) != 0){
+		printf("\r\nERROR!!! Can't create MIDI Clock Thread...\r\n");
+		Active = false;											//
+		return false;											//
+	}
+	Join = true;												//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Stop the clock thread (Returns within a tick or CLOCK_OUT_IDLE)
+void MIDIClockOut::Close(void)
+{
+	__atomic_store_n(&Active, false, __ATOMIC_RELEASE);			//
+	if(Join){													// Started?
+		pthread_join(ThreadId, NULL);							//
+		Join = false;											//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Send ticks (Master) or not
+void MIDIClockOut::Enable(bool On)
+{
+	__atomic_store_n(&Enabled, On, __ATOMIC_RELEASE);			//
+}
+
+// ------------------------------------------------------------------------------------ //
+bool MIDIClockOut::IsPlaying(void)
+{
+	return __atomic_load_n(&Playing, __ATOMIC_ACQUIRE);			//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Start, sent by the clock thread just before the next downbeat tick
+void MIDIClockOut::SendStart(void)
+{
+	__atomic_store_n(&Pending, MIDI_START, __ATOMIC_RELEASE);	//
+	__atomic_store_n(&Playing, true, __ATOMIC_RELEASE);			//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Stop, at once (Cancels a Start / Continue not sent yet)
+void MIDIClockOut::SendStop(void)
+{
+	__atomic_store_n(&Pending, 0, __ATOMIC_RELEASE);			//
+	__atomic_store_n(&Playing, false, __ATOMIC_RELEASE);		//
+	if(Port != NULL){											//
+		Port->WriteRealtime(MIDI_STOP);							//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Continue, sent by the clock thread just before the next tick
+void MIDIClockOut::SendContinue(void)
+{
+	__atomic_store_n(&Pending, MIDI_CONTINUE, __ATOMIC_RELEASE);	//
+	__atomic_store_n(&Playing, true, __ATOMIC_RELEASE);			//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Print tick timing (Interval jitter, lateness vs. the deadline)
+void MIDIClockOut::Report(FILE *Out)
+{
+	pthread_mutex_lock(&Mutex);									//
+	if(Ticks > 0){												//
+		fprintf(Out, "MIDI clock out: %llu ticks, %llu dropped, jitter rms %.1f uS, max %.1f uS, late mean %.1f uS, max %.1f uS, lead %.1f uS\r\n",
+			(unsigned long long)Ticks, (unsigned long long)Dropped,
+			(Intervals > 0) ? sqrt(JitSq / Intervals) / 1e3 : 0.0, JitMax / 1e3,
+			(LateSum / Ticks) / 1e3, LateMax / 1e3, Lead / 1e3);
+	}
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI Clock Thread. Sleeps to each tick's absolute deadline on the beat phase grid.
+void *MIDIClockOut::ClockThread(MIDIClockOut *C)
+{
+	uint64_t Now, After, Tick, Next, Sent, Prev = 0, Interval = 0;	// nS
+	int64_t Late, PrevLate = 0;									// nS
+	int Index, Msg;												//
+	bool Real = !CLK->IsVirtual();								// Wake up lead only on real time
+
+	if(TRC != NULL){ TRC->SetThreadName("MIDI Clock"); }		// Claim trace ring
+	CLK->Attach("MIDI Clock");									// Virtual time: join clock
+	while(__atomic_load_n(&C->Active, __ATOMIC_ACQUIRE)){
+		Now = CLK->Now();										//
+		if(!__atomic_load_n(&C->Enabled, __ATOMIC_ACQUIRE)){	// Not the master?
+			Prev = 0;											//
+			CLK->SleepUntil(Now + (CLOCK_OUT_IDLE * NS_PER_MS));	//
+			continue;											//
+		}
+
+		After = (Prev == 0) ? Now : Prev + (Interval / 2);		// Next tick on the grid, one per interval
+		if((Prev != 0)&&(After + (CLOCK_OUT_RESYNC * NS_PER_MS) < Now)){	// Stalled? Start again from now
+			pthread_mutex_lock(&C->Mutex);						//
+			C->Dropped += (Interval > 0) ? (Now - Prev) / Interval : 1;	//
+			pthread_mutex_unlock(&C->Mutex);					//
+			After = Now;										//
+			Prev = 0;											//
+		}
+		if((Tick = C->Phase->NextTick(After, &Index)) == 0){	// No tempo yet?
+			Prev = 0;											//
+			CLK->SleepUntil(Now + (CLOCK_OUT_IDLE * NS_PER_MS));	//
+			continue;											//
+		}
+
+		CLK->SleepUntil(Tick - llround(C->Lead));				// Absolute deadline, less the wake up lead
+		while((Next = C->Phase->NextTick(After, &Index)) > Tick){	// Grid moved on meanwhile (Tap)? Not from the old one
+			Tick = Next;										//
+			CLK->SleepUntil(Tick - llround(C->Lead));			//
+		}
+		if(Next == 0){											// Tempo gone?
+			continue;											//
+		}
+		if(!__atomic_load_n(&C->Enabled, __ATOMIC_ACQUIRE)){	// Disabled meanwhile?
+			continue;											//
+		}
+		Msg = __atomic_load_n(&C->Pending, __ATOMIC_ACQUIRE);	// Transport waiting?
+		if(((Msg == MIDI_CONTINUE)||((Msg == MIDI_START)&&(Index == 0)))&&
+			__atomic_compare_exchange_n(&C->Pending, &Msg, 0, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)){	// Not stopped meanwhile?
+			C->Port->WriteRealtime((uint8_t)Msg);				// Slave starts on the tick that follows
+		}
+		C->Port->WriteRealtime(MIDI_TICK);						//
+		Sent = CLK->Now();										//
+
+		Late = (int64_t)(Sent - Tick);							// Error vs. the deadline
+		pthread_mutex_lock(&C->Mutex);							//
+		C->Ticks++;												//
+		C->LateSum += Late;										//
+		if(Late > C->LateMax){									//
+			C->LateMax = Late;									//
+		}
+		if(Prev != 0){											// Interval error
+			int64_t Jit = Late - PrevLate;						// (Sent - PrevSent) - (Tick - Prev)
+			C->Intervals++;										//
+			C->JitSq += (double)Jit * Jit;						//
+			if(llabs(Jit) > C->JitMax){							//
+				C->JitMax = llabs(Jit);							//
+			}
+		}
+		if(Real){												// Feed the error back into the wake up time
+			C->Lead += Late * CLOCK_OUT_LEAD_GAIN;				//
+			if(C->Lead < 0){									//
+				C->Lead = 0;									//
+			}else if(C->Lead > CLOCK_OUT_LEAD_MAX * NS_PER_US){	//
+				C->Lead = CLOCK_OUT_LEAD_MAX * NS_PER_US;		//
+			}
+		}
+		pthread_mutex_unlock(&C->Mutex);						//
+
+		if(Prev != 0){											//
+			Interval = Tick - Prev;								//
+		}
+		Prev = Tick;											//
+		PrevLate = Late;										//
+	}
+	CLK->Detach();												// Virtual time: leave clock
+	return NULL;
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
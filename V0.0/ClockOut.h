@@ -0,0 +1,77 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			MIDI Clock Out Header for RPi - Linux
+Filename:		ClockOut.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	MIDI clock generator (24 ticks per quarter note, Start / Stop / Continue)
+				for when MOLink is the tempo master (Manual tap tempo).
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _CLOCKOUT_H
+#define _CLOCKOUT_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdio.h>												// FILE
+#include <stdint.h>												// Fixed width types
+#include <pthread.h>											// Threads
+#include "config.h"												// General Configuration File
+#include "Serial.h"												// MIDI OUT
+#include "Tempo.h"												// Beat Phase
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define CLOCK_OUT_IDLE		10									// Check for enable / tempo every mS when not sending
+#define CLOCK_OUT_RESYNC	100									// Further behind than mS? Restart from now (Ticks dropped)
+#define CLOCK_OUT_LEAD_GAIN	0.25								// Wake up lead correction (Of the write lateness)
+#define CLOCK_OUT_LEAD_MAX	500									// Largest wake up lead in uS
+
+// -------------------------------------------------------------------------------------
+// Define MIDI Clock Out Class
+class MIDIClockOut
+{
+private:
+	Serial *Port;												// MIDI OUT
+	BeatPhase *Phase;											// Tick grid
+	pthread_t ThreadId;											//
+	bool Active;												// Thread running
+	bool Join;													// Thread to join on Close()
+	bool Enabled;												// Sending ticks
+	bool Playing;												// Start / Continue sent, no Stop since
+	int Pending;												// Start / Continue to send before the next tick (0 = none)
+
+	pthread_mutex_t Mutex;										// Statistics
+	uint64_t Ticks;												// Ticks sent
+	uint64_t Dropped;											// Ticks skipped after a stall
+	uint64_t Intervals;											// Tick intervals measured
+	double JitSq;												// Interval error squared (Sent vs. scheduled, nS)
+	int64_t JitMax;												// Largest |interval error| (nS)
+	double LateSum;												// Write time - deadline (nS)
+	int64_t LateMax;											//
+	double Lead;												// Wake up this early (nS, real clock only)
+
+	static void *ClockThread(MIDIClockOut *C);					//
+
+public:
+	MIDIClockOut();												//
+	~MIDIClockOut();											//
+
+	bool Open(Serial *Out, BeatPhase *Grid);					// Start the clock thread. Returns true if OK.
+	void Close(void);											//
+	void Enable(bool On);										// Send ticks (Master) or not
+	bool IsPlaying(void);										//
+
+	void SendStart(void);										// Start, goes out just before the next downbeat
+	void SendStop(void);										// Stop, at once
+	void SendContinue(void);									// Continue, goes out just before the next tick
+
+	void Report(FILE *Out);										// Print tick timing statistics
+};
+
+// -------------------------------------------------------------------------------------
+#endif
@@ -0,0 +1,439 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			Event Loop for RPi - Linux
+Filename:		EventLoop.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	epoll() event loop for the main thread, with a hierarchical timer wheel.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Run() sleeps in epoll_wait() until a descriptor is ready, the next timer
+	  is due or TimeOut runs out, whichever is first. Nothing spins.
+	# Timer wheel: LOOP_WHEEL_LEVELS levels of 64 slots, level N slots are
+	  64^N ticks wide. Start / stop is O(1) (link / unlink in a slot list), a
+	  timer cascades down at most once per level on its way to level 0. A bit
+	  map of non empty slots per level gives the next tick with work in a few
+	  instructions, so empty ticks are skipped, not stepped through. The wait
+	  is for the next timer, not the next cascade: cascading is done on the
+	  way when Run() wakes up.
+	# One timerfd (CLOCK_MONOTONIC, absolute) holds the next wheel deadline and
+	  is only re-armed when that moves, so idle timers cost no system calls and
+	  deadlines aren't rounded to epoll_wait()'s mS.
+	# Polled sources are periodic timers on the grid they were started on.
+	# On a VirtualClock the wait is a CLK->SleepUntil() (descriptors are only
+	  checked, never waited on), so polled sources step in virtual time and a
+	  simulation stays repeatable.
+	# Callbacks run on the thread calling Run(), one at a time. Timers are
+	  started / stopped from those callbacks, so there is no locking.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <stdio.h>												// printf()
+#include <string.h>												// memset()
+#include <unistd.h>												// close()
+#include <errno.h>												// EINTR
+#include <sys/timerfd.h>										// timerfd_create()
+#include "EventLoop.h"											// Event Loop Class
+#include "Clock.h"												// Time source
+
+// ------------------------------------------------------------------------------------ //
+// Constants
+#define WHEEL_TICK			((uint64_t)LOOP_TICK * NS_PER_US)	// Tick in nS
+#define WHEEL_MASK			(LOOP_WHEEL_SLOTS - 1)				// Slot index
+
+// ------------------------------------------------------------------------------------ //
+// Constructor
+EventLoop::EventLoop()
+{
+	EpollFd = -1;												//
+	TimerFd = -1;												//
+	Armed = 0;													//
+	for(int I = 0; I < LOOP_FDS_MAX; I++){						//
+		Fds[I].Fd = -1;											// Free
+	}
+	memset(Polls, 0, sizeof(Polls));							//
+	memset(Wheel, 0, sizeof(Wheel));							//
+	memset(Pending, 0, sizeof(Pending));						//
+	Tick = CLK->Now() / WHEEL_TICK;								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+EventLoop::~EventLoop()
+{
+	Close();													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Open. Returns true if OK.
+bool EventLoop::Open(void)
+{
+	if(EpollFd >= 0){											// Already open?
+		return true;											//
+	}
+	if((EpollFd = epoll_create1(EPOLL_CLOEXEC)) < 0){			//
+		printf("\r\nERROR!!! Event loop: epoll_create1() failed\r\n");
+		return false;											//
+	}
+
+	// Wheel deadline (Not needed on a virtual clock, Run() sleeps there)
+	if(!CLK->IsVirtual()){										//
+		struct epoll_event Ev;									//
+		memset(&Ev, 0, sizeof(Ev));								//
+		Ev.events = EPOLLIN;									//
+		Ev.data.ptr = NULL;										// Not a LoopFd
+		if(((TimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) < 0)||
+			(epoll_ctl(EpollFd, EPOLL_CTL_ADD, TimerFd, &Ev) != 0)){	//
+			printf("\r\nWARNING!!! Event loop: no timerfd, timers rounded to mS\r\n");
+			if(TimerFd >= 0){									//
+				close(TimerFd);									//
+				TimerFd = -1;									//
+			}
+		}
+		Armed = 0;												//
+	}
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Close (Watched descriptors are not closed, they belong to whoever added them)
+void EventLoop::Close(void)
+{
+	if(EpollFd >= 0){											//
+		close(EpollFd);											//
+		EpollFd = -1;											//
+	}
+	if(TimerFd >= 0){											//
+		close(TimerFd);											//
+		TimerFd = -1;											//
+	}
+	for(int I = 0; I < LOOP_FDS_MAX; I++){						//
+		Fds[I].Fd = -1;											//
+	}
+	for(int S = 0; S < LOOP_WHEEL_LEVELS * LOOP_WHEEL_SLOTS; S++){	// Unlink timers
+		while(Wheel[S] != NULL){								//
+			StopTimer(Wheel[S]);								//
+		}
+	}
+	memset(Polls, 0, sizeof(Polls));							//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Watch Fd for Events (EPOLLIN...). Returns true if OK.
+bool EventLoop::Add(int Fd, uint32_t Events, LoopFdCallBack Fn, void *Arg)
+{
+	struct epoll_event Ev;										//
+	int Slot;													//
+
+	if((EpollFd < 0)||(Fd < 0)||(Fn == NULL)){					//
+		return false;											//
+	}
+	for(Slot = 0; Slot < LOOP_FDS_MAX; Slot++){					// Free slot?
+		if(Fds[Slot].Fd < 0){									//
+			break;												//
+		}
+	}
+	if(Slot >= LOOP_FDS_MAX){									//
+		printf("\r\nERROR!!! Event loop: too many descriptors\r\n");
+		return false;											//
+	}
+
+	memset(&Ev, 0, sizeof(Ev));									//
+	Ev.events = Events;											//
+	Ev.data.ptr = &Fds[Slot];									//
+	if(epoll_ctl(EpollFd, EPOLL_CTL_ADD, Fd, &Ev) != 0){		//
+		printf("\r\nERROR!!! Event loop: can't watch fd %i (%s)\r\n", Fd, strerror(errno));
+		return false;											//
+	}
+	Fds[Slot].Fn = Fn;											//
+	Fds[Slot].Arg = Arg;										//
+	Fds[Slot].Fd = Fd;											//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Stop watching Fd
+void EventLoop::Remove(int Fd)
+{
+	for(int I = 0; I < LOOP_FDS_MAX; I++){						//
+		if(Fds[I].Fd == Fd){									//
+			if(EpollFd >= 0){									//
+				epoll_ctl(EpollFd, EPOLL_CTL_DEL, Fd, NULL);	//
+			}
+			Fds[I].Fd = -1;										//
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Call Fn(Arg) every PeriodMs (A periodic timer). Returns true if OK.
+bool EventLoop::AddPoll(LoopPollCallBack Fn, void *Arg, int PeriodMs)
+{
+	uint64_t Period = (uint64_t)((PeriodMs > 0) ? PeriodMs : 1) * NS_PER_MS;	//
+
+	for(int I = 0; I < LOOP_POLLS_MAX; I++){					//
+		if(Polls[I].Fn == NULL){								// Free?
+			Polls[I].Fn = Fn;									//
+			Polls[I].Arg = Arg;									//
+			StartTimer(&Polls[I], CLK->Now() + Period, Period);	//
+			return true;										//
+		}
+	}
+	printf("\r\nERROR!!! Event loop: too many polled sources\r\n");
+	return false;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Remove polled source
+void EventLoop::RemovePoll(LoopPollCallBack Fn, void *Arg)
+{
+	for(int I = 0; I < LOOP_POLLS_MAX; I++){					//
+		if((Polls[I].Fn == Fn)&&(Polls[I].Arg == Arg)){			//
+			StopTimer(&Polls[I]);								//
+			Polls[I].Fn = NULL;									//
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// (Re)start timer T, T->Fn(T->Arg) is called at Due (CLK nS), then every Period nS (0 = once)
+void EventLoop::StartTimer(LoopTimer *T, uint64_t Due, uint64_t Period)
+{
+	if(T->Active){												// Restart
+		Unlink(T);												//
+	}
+	T->Due = Due;												//
+	T->Period = Period;											//
+	T->Expires = (Due + WHEEL_TICK - 1) / WHEEL_TICK;			// Round up, never early
+	if(T->Expires <= Tick){										// Due / overdue? Next tick
+		T->Expires = Tick + 1;									//
+	}
+	Link(T);													//
+	T->Active = true;											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Stop timer T (Nothing if not active)
+void EventLoop::StopTimer(LoopTimer *T)
+{
+	if(!T->Active){												//
+		return;													//
+	}
+	Unlink(T);													//
+	T->Active = false;											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Put T in its slot: the lowest level whose range reaches T->Expires
+void EventLoop::Link(LoopTimer *T)
+{
+	uint64_t Exp = (T->Expires > Tick) ? T->Expires : Tick;	// Cascading lands on Tick itself
+	uint64_t Delta = Exp - Tick;								//
+	int Level, Idx;												//
+
+	for(Level = 0; Level < LOOP_WHEEL_LEVELS - 1; Level++){		//
+		if(Delta < (1ULL << (LOOP_WHEEL_BITS * (Level + 1)))){	// In range?
+			break;												//
+		}
+	}
+	if(Delta >= (1ULL << (LOOP_WHEEL_BITS * LOOP_WHEEL_LEVELS))){	// Past the wheel? Park at the far end
+		Exp = Tick + (1ULL << (LOOP_WHEEL_BITS * LOOP_WHEEL_LEVELS)) - 1;	// (Re-linked from T->Expires when it cascades)
+	}
+	Idx = (int)(Exp >> (LOOP_WHEEL_BITS * Level)) & WHEEL_MASK;	//
+
+	T->Slot = (Level * LOOP_WHEEL_SLOTS) + Idx;				//
+	T->Prev = NULL;												// Push on slot list
+	T->Next = Wheel[T->Slot];									//
+	if(T->Next != NULL){										//
+		T->Next->Prev = T;										//
+	}
+	Wheel[T->Slot] = T;											//
+	Pending[Level] |= (1ULL << Idx);							//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Take T out of its slot
+void EventLoop::Unlink(LoopTimer *T)
+{
+	if(T->Prev != NULL){										//
+		T->Prev->Next = T->Next;								//
+	}else{
+		Wheel[T->Slot] = T->Next;								//
+	}
+	if(T->Next != NULL){										//
+		T->Next->Prev = T->Prev;								//
+	}
+	if(Wheel[T->Slot] == NULL){									// Slot empty?
+		Pending[T->Slot / LOOP_WHEEL_SLOTS] &= ~(1ULL << (T->Slot & WHEEL_MASK));	//
+	}
+	T->Prev = T->Next = NULL;									//
+}
+
+// ------------------------------------------------------------------------------------ //
+// First non empty slot Level reaches after Tick, as the tick it is processed at
+// (Fired on level 0, cascaded above). UINT64_MAX if the level is empty.
+uint64_t EventLoop::SlotTick(int Level)
+{
+	int Shift = LOOP_WHEEL_BITS * Level;						//
+	uint64_t Base, Bits;										//
+	int Rot;													//
+
+	if(Pending[Level] == 0){									// Nothing here
+		return UINT64_MAX;										//
+	}
+	Base = (Tick >> Shift) + 1;									// Next slot this level reaches
+	Rot = (int)(Base & WHEEL_MASK);								// Rotate bitmap so bit 0 = that slot
+	Bits = (Rot == 0) ? Pending[Level] : (Pending[Level] >> Rot) | (Pending[Level] << (LOOP_WHEEL_SLOTS - Rot));
+	return (Base + __builtin_ctzll(Bits)) << Shift;				//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Next tick with work to do: a level 0 slot to fire or a higher slot to cascade.
+// UINT64_MAX if the wheel is empty.
+uint64_t EventLoop::NextTick(void)
+{
+	uint64_t Next = UINT64_MAX, At;								//
+
+	for(int Level = 0; Level < LOOP_WHEEL_LEVELS; Level++){		//
+		if((At = SlotTick(Level)) < Next){						//
+			Next = At;											//
+		}
+	}
+	return Next;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Tick the next timer fires at, UINT64_MAX if none. Cascades on the way are left to
+// Advance(), so a wheel holding only long timers doesn't wake up to cascade them.
+uint64_t EventLoop::NextDue(void)
+{
+	uint64_t Next = SlotTick(0), At;							// Level 0 slot = its tick
+
+	for(int Level = 1; Level < LOOP_WHEEL_LEVELS; Level++){		// Higher: earliest in the first slot
+		if((At = SlotTick(Level)) < Next){						// (Everything in it expires at / after At)
+			LoopTimer *T = Wheel[(Level * LOOP_WHEEL_SLOTS) + (int)((At >> (LOOP_WHEEL_BITS * Level)) & WHEEL_MASK)];
+			for(; T != NULL; T = T->Next){						//
+				if(T->Expires < Next){							//
+					Next = T->Expires;							//
+				}
+			}
+		}
+	}
+	return Next;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Run the wheel up to Now (CLK nS): cascade and fire, skipping empty ticks. Returns callbacks made.
+int EventLoop::Advance(uint64_t Now)
+{
+	uint64_t Target = Now / WHEEL_TICK;							//
+	LoopTimer *T;												//
+	int Calls = 0;												//
+
+	while(Tick < Target){										//
+		uint64_t Next = NextTick();								//
+		if(Next > Target){										// Nothing before Now
+			Tick = Target;										//
+			break;												//
+		}
+		Tick = Next;											//
+
+		for(int Level = 1; Level < LOOP_WHEEL_LEVELS; Level++){	// Cascade while the lower levels wrap
+			int Shift = LOOP_WHEEL_BITS * Level;				//
+			if((Tick & ((1ULL << Shift) - 1)) != 0){			// Lower level didn't wrap
+				break;											//
+			}
+			int Slot = (Level * LOOP_WHEEL_SLOTS) + (int)((Tick >> Shift) & WHEEL_MASK);	//
+			while((T = Wheel[Slot]) != NULL){					// Re-link one level (or more) down
+				Unlink(T);										//
+				Link(T);										//
+			}
+		}
+
+		while((T = Wheel[Tick & WHEEL_MASK]) != NULL){			// Fire this tick's timers (Callback may start / stop any timer)
+			StopTimer(T);										//
+			if(T->Period != 0){									// Periodic? Stay on the grid
+				uint64_t Due = T->Due + T->Period;				//
+				if(Due <= Now){									// Fell behind? Skip missed periods, on the grid
+					Due += T->Period * (((Now - Due) / T->Period) + 1);	//
+				}
+				StartTimer(T, Due, T->Period);					//
+			}
+			T->Fn(T->Arg);										//
+			Calls++;											//
+		}
+	}
+
+	return Calls;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Wait up to TimeOut mS for events and dispatch them. Returns callbacks made.
+int EventLoop::Run(int TimeOut)
+{
+	struct epoll_event Ev[LOOP_EVENTS_MAX];						//
+	uint64_t Now = CLK->Now();									//
+	uint64_t Until = Now + (uint64_t)TimeOut * NS_PER_MS;		// Latest wake up
+	uint64_t Next = NextDue();									//
+	int N = 0, Calls = 0;										//
+
+	if((Next != UINT64_MAX)&&(Next * WHEEL_TICK < Until)){		// Timer due sooner?
+		Until = Next * WHEEL_TICK;								//
+	}
+
+	if((EpollFd < 0)||CLK->IsVirtual()){						// Nothing to block on / Simulation
+		if((EpollFd < 0)||((N = epoll_wait(EpollFd, Ev, LOOP_EVENTS_MAX, 0)) <= 0)){
+			CLK->SleepUntil(Until);								//
+			N = (EpollFd < 0) ? 0 : epoll_wait(EpollFd, Ev, LOOP_EVENTS_MAX, 0);	//
+		}
+	}else{
+		int Wait;												//
+		if(TimerFd >= 0){										// Wheel deadline on the timerfd (nS exact)
+			uint64_t Deadline = (Next != UINT64_MAX) ? Next * WHEEL_TICK : 0;	//
+			if(Deadline != Armed){								// Only touch it when it moves
+				struct itimerspec Ts;							//
+				memset(&Ts, 0, sizeof(Ts));						// 0 = disarm
+				Ts.it_value.tv_sec = Deadline / NS_PER_SEC;		//
+				Ts.it_value.tv_nsec = Deadline % NS_PER_SEC;	//
+				if((Deadline != 0)&&(Ts.it_value.tv_sec == 0)&&(Ts.it_value.tv_nsec == 0)){
+					Ts.it_value.tv_nsec = 1;					//
+				}
+				timerfd_settime(TimerFd, TFD_TIMER_ABSTIME, &Ts, NULL);	//
+				Armed = Deadline;								//
+			}
+			Wait = (Until > Now) ? TimeOut : 0;					// Already due? Don't block
+		}else{
+			Wait = (Until > Now) ? (int)((Until - Now + NS_PER_MS - 1) / NS_PER_MS) : 0;	// Round up
+		}
+		N = epoll_wait(EpollFd, Ev, LOOP_EVENTS_MAX, Wait);		//
+	}
+	if(N < 0){													// EINTR etc.
+		N = 0;													//
+	}
+
+	for(int I = 0; I < N; I++){									// Ready descriptors
+		LoopFd *F = (LoopFd *)Ev[I].data.ptr;					//
+		if(F == NULL){											// Wheel timerfd, just clear it
+			uint64_t Expired;									//
+			if(read(TimerFd, &Expired, sizeof(Expired)) < 0){}	//
+			Armed = 0;											// Fired, one-shot
+			continue;											//
+		}
+		if(F->Fd >= 0){											// Not removed by an earlier callback?
+			F->Fn(F->Fd, Ev[I].events, F->Arg);					//
+			Calls++;											//
+		}
+	}
+
+	Calls += Advance(CLK->Now());								// Due timers (and polled sources)
+
+	return Calls;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
@@ -0,0 +1,102 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			Event Loop Header for RPi - Linux
+Filename:		EventLoop.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	epoll() event loop for the main thread. File descriptors (GPIO line
+				events, sockets...) get a callback when ready, timers (one-shot or
+				periodic) when due. Timers live in a hierarchical timer wheel behind
+				one timerfd, so any number of them cost nothing while they wait.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _EVENTLOOP_H
+#define _EVENTLOOP_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdint.h>												// Fixed width types
+#include <sys/epoll.h>											// EPOLLIN...
+#include "config.h"												// General Configuration File
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define LOOP_EVENTS_MAX		16									// Events per epoll_wait()
+#define LOOP_FDS_MAX		32									// Watched file descriptors
+#define LOOP_POLLS_MAX		8									// Polled sources
+#define LOOP_TICK			250									// Timer wheel tick in uS (Timers fire up to 1 tick late, never early)
+#define LOOP_WHEEL_BITS		6									// 64 slots per level
+#define LOOP_WHEEL_SLOTS	(1 << LOOP_WHEEL_BITS)				//
+#define LOOP_WHEEL_LEVELS	4									// 64^4 ticks = 70 minutes, longer timers re-cascade
+
+// -------------------------------------------------------------------------------------
+// Callbacks
+typedef void (*LoopFdCallBack)(int Fd, uint32_t Events, void *Arg);	// Fd ready
+typedef void (*LoopPollCallBack)(void *Arg);						// Poll period due
+typedef void (*LoopTimerCallBack)(void *Arg);						// Timer due
+
+// -------------------------------------------------------------------------------------
+// Timer. Owned by the caller (Zero it, set Fn / Arg once), the loop only links it in.
+typedef struct _loopTimer{
+	LoopTimerCallBack Fn;										//
+	void *Arg;													//
+	uint64_t Due;												// CLK nS
+	uint64_t Period;											// nS, 0 = one-shot
+	uint64_t Expires;											// Wheel tick
+	int Slot;													// Wheel slot
+	bool Active;												// Started, not fired / stopped
+	struct _loopTimer *Prev, *Next;								// Slot list
+} LoopTimer;
+
+// -------------------------------------------------------------------------------------
+// Watched File Descriptor
+typedef struct _loopFd{
+	int Fd;														// -1 = free
+	LoopFdCallBack Fn;											//
+	void *Arg;													//
+} LoopFd;
+
+// -------------------------------------------------------------------------------------
+// Define Event Loop Class
+class EventLoop
+{
+private:
+	int EpollFd;												//
+	int TimerFd;												// Wakes epoll_wait() for the wheel (-1 = none)
+	uint64_t Armed;												// TimerFd deadline (CLK nS, 0 = disarmed)
+	LoopFd Fds[LOOP_FDS_MAX];									//
+	LoopTimer Polls[LOOP_POLLS_MAX];							// Polled sources (Periodic timers, Fn NULL = free)
+	LoopTimer *Wheel[LOOP_WHEEL_LEVELS * LOOP_WHEEL_SLOTS];		// Slot lists
+	uint64_t Pending[LOOP_WHEEL_LEVELS];						// Non empty slots, one bit each
+	uint64_t Tick;												// Wheel time, every tick up to here has run
+
+	void Link(LoopTimer *T);									// Into its wheel slot
+	void Unlink(LoopTimer *T);									//
+	uint64_t SlotTick(int Level);								// First non empty slot on Level, as a tick
+	uint64_t NextTick(void);									// Next tick with work (Fire / cascade), UINT64_MAX = idle
+	uint64_t NextDue(void);										// Next tick a timer fires, UINT64_MAX = idle
+	int Advance(uint64_t Now);									// Run the wheel up to Now, fire due timers
+
+public:
+	EventLoop();												//
+	~EventLoop();												//
+
+	bool Open(void);											//
+	void Close(void);											//
+
+	bool Add(int Fd, uint32_t Events, LoopFdCallBack Fn, void *Arg);	// Watch Fd (EPOLLIN...)
+	void Remove(int Fd);										//
+	bool AddPoll(LoopPollCallBack Fn, void *Arg, int PeriodMs);	// Call every PeriodMs
+	void RemovePoll(LoopPollCallBack Fn, void *Arg);			//
+	void StartTimer(LoopTimer *T, uint64_t Due, uint64_t Period = 0);	// (Re)start, fires at Due (CLK nS) then every Period nS
+	void StopTimer(LoopTimer *T);								// Safe if not active
+
+	int Run(int TimeOut);										// Wait up to TimeOut mS, dispatch. Returns callbacks made.
+};
+
+// -------------------------------------------------------------------------------------
+#endif
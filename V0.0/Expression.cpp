@@ -0,0 +1,458 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			Expression for RPi - Linux
+Filename:		Expression.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Expression compiler (Recursive descent) and interpreter.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Syntax, C like, floats throughout (true = 1, false = 0):
+		v s lo hi bpm ms						Variables (ExprVar)
+		1  0.5  2e3								Numbers
+		+ - * / %  < <= > >= == !=  && ||  !	(Highest precedence first: ! and -, * / %,
+		c ? a : b								 + -, compare, &&, ||, ?:)
+		min(a, b) max(a, b) clamp(x, lo, hi) pow(a, b) abs(x) floor(x) round(x)
+		sqrt(x) log(x) exp(x)
+		state(<name>)							Another rule's state (MIDIMap: by OSC address)
+		fader(dB) freq(Hz) delay(mS)...			Units -> XR18 float through a parameter law
+		fader_units(x)...						 and back (ParamLaw.cpp)
+	  e.g. 'pow(v / 127, 2)', 'delay(ms * 3 / 4)', 'fader(v / 127 * 100 - 90)'.
+	# Registers: the variables are registers 0..EXPR_VARS-1, loaded by the
+	  caller before Run(), so using one costs no instruction. Temporaries are
+	  handed out like a stack, a result goes back into the first free one of
+	  its operands, so even long expressions need only a few registers.
+	# Run() is one switch per instruction over a fixed size program, no
+	  allocation, no recursion. x / 0 and x % 0 give 0 rather than inf / NaN.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <stdio.h>												// printf()
+#include <stdlib.h>												// strtof()
+#include <string.h>												// strncmp(), memset()
+#include <ctype.h>												// isspace(), isalpha()
+#include <math.h>												// powf(), floorf()...
+#include "Expression.h"											// Expression Class
+
+// ------------------------------------------------------------------------------------ //
+// Compile state
+typedef struct _exprParser{
+	const char *Ptr;											// Next character
+	ExprProgram *P;												// Program being built
+	int Next;													// First free temporary register
+	ExprFindCallBack Find;										// state(<name>)
+	void *Arg;													//
+	const char *Error;											// First error (NULL = none)
+} ExprParser;
+
+// ------------------------------------------------------------------------------------ //
+// Variable names, in ExprVar order
+static const char *ExprVarNames[EXPR_VARS] = {"v", "s", "lo", "hi", "bpm", "ms"};	//
+
+// ------------------------------------------------------------------------------------ //
+// Functions, argument count
+typedef struct _exprFunction{
+	const char *Name;											//
+	int Op;														// ExprOpCode
+	int Args;													//
+} ExprFunction;
+
+static const ExprFunction ExprFunctions[] = {
+	{"min", EXPR_MIN, 2}, {"max", EXPR_MAX, 2}, {"pow", EXPR_POW, 2}, {"clamp", EXPR_CLAMP, 3},
+	{"abs", EXPR_ABS, 1}, {"floor", EXPR_FLOOR, 1}, {"round", EXPR_ROUND, 1},
+	{"sqrt", EXPR_SQRT, 1}, {"log", EXPR_LOG, 1}, {"exp", EXPR_EXP, 1},
+	{NULL, 0, 0}
+};
+
+// ------------------------------------------------------------------------------------ //
+// Compile Text into P. state(<name>) names are resolved with Find. Returns false if bad.
+bool Expression::Compile(const char *Text, ExprProgram *P, ExprFindCallBack Find, void *Arg)
+{
+	ExprParser X;												//
+	int Out;													//
+
+	memset(P, 0, sizeof(ExprProgram));							//
+	X.Ptr = Text;												//
+	X.P = P;													//
+	X.Next = EXPR_VARS;											// Temporaries after the variables
+	X.Find = Find;												//
+	X.Arg = Arg;												//
+	X.Error = NULL;												//
+
+	Out = Cond(&X);												//
+	while(isspace((unsigned char)*X.Ptr)){						// Trailing blanks / new line
+		X.Ptr++;												//
+	}
+	if((Out >= 0)&&(*X.Ptr != 0)&&(*X.Ptr != '#')){				// Left over? ('#' starts a comment)
+		X.Error = "unexpected text";							//
+	}
+	if((Out < 0)||(X.Error != NULL)){							//
+		printf("\r\nERROR!!! Expression '%s': %s at '%.16s'\r\n", Text, (X.Error != NULL) ? X.Error : "bad", X.Ptr);
+		return false;											//
+	}
+	P->Out = Out;												//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Run P on registers R (EXPR_REGS, variables loaded). state() through State. Returns the result.
+float Expression::Run(const ExprProgram *P, float *R, ExprStateCallBack State, void *Arg)
+{
+	const ExprOp *I = P->Code;									//
+	const ExprOp *End = P->Code + P->Ops;						//
+
+	for(; I < End; I++){										//
+		switch(I->Op){
+			case EXPR_CONST:	R[I->D] = P->Const[I->A]; break;
+			case EXPR_STATE:	R[I->D] = (State != NULL) ? State(I->A | (I->B << 8), Arg) : 0; break;
+			case EXPR_ADD:		R[I->D] = R[I->A] + R[I->B]; break;
+			case EXPR_SUB:		R[I->D] = R[I->A] - R[I->B]; break;
+			case EXPR_MUL:		R[I->D] = R[I->A] * R[I->B]; break;
+			case EXPR_DIV:		R[I->D] = (R[I->B] != 0) ? R[I->A] / R[I->B] : 0; break;
+			case EXPR_MOD:		R[I->D] = (R[I->B] != 0) ? fmodf(R[I->A], R[I->B]) : 0; break;
+			case EXPR_LT:		R[I->D] = R[I->A] < R[I->B]; break;
+			case EXPR_LE:		R[I->D] = R[I->A] <= R[I->B]; break;
+			case EXPR_GT:		R[I->D] = R[I->A] > R[I->B]; break;
+			case EXPR_GE:		R[I->D] = R[I->A] >= R[I->B]; break;
+			case EXPR_EQ:		R[I->D] = R[I->A] == R[I->B]; break;
+			case EXPR_NE:		R[I->D] = R[I->A] != R[I->B]; break;
+			case EXPR_AND:		R[I->D] = (R[I->A] != 0)&&(R[I->B] != 0); break;
+			case EXPR_OR:		R[I->D] = (R[I->A] != 0)||(R[I->B] != 0); break;
+			case EXPR_MIN:		R[I->D] = fminf(R[I->A], R[I->B]); break;
+			case EXPR_MAX:		R[I->D] = fmaxf(R[I->A], R[I->B]); break;
+			case EXPR_POW:		R[I->D] = powf(R[I->A], R[I->B]); break;
+			case EXPR_NEG:		R[I->D] = -R[I->A]; break;
+			case EXPR_NOT:		R[I->D] = (R[I->A] == 0); break;
+			case EXPR_ABS:		R[I->D] = fabsf(R[I->A]); break;
+			case EXPR_FLOOR:	R[I->D] = floorf(R[I->A]); break;
+			case EXPR_ROUND:	R[I->D] = roundf(R[I->A]); break;
+			case EXPR_SQRT:		R[I->D] = sqrtf(R[I->A]); break;
+			case EXPR_LOG:		R[I->D] = logf(R[I->A]); break;
+			case EXPR_EXP:		R[I->D] = expf(R[I->A]); break;
+			case EXPR_SEL:		R[I->D] = (R[I->A] != 0) ? R[I->B] : R[I->C]; break;
+			case EXPR_CLAMP:	R[I->D] = fminf(fmaxf(R[I->A], R[I->B]), R[I->C]); break;
+			case EXPR_LAW:		R[I->D] = ParamLaw::ToFloat(I->B, R[I->A]); break;
+			case EXPR_UNITS:	R[I->D] = ParamLaw::ToUnits(I->B, R[I->A]); break;
+		}
+	}
+	return R[P->Out];											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// a ? b : c
+int Expression::Cond(ExprParser *X)
+{
+	int C, A, B;												//
+
+	if((C = Or(X)) < 0){										//
+		return -1;												//
+	}
+	if(!Match(X, "?")){											//
+		return C;												//
+	}
+	if(((A = Cond(X)) < 0)||!Match(X, ":")){					//
+		X->Error = (X->Error != NULL) ? X->Error : "':' expected";	//
+		return -1;												//
+	}
+	if((B = Cond(X)) < 0){										//
+		return -1;												//
+	}
+	return Emit(X, EXPR_SEL, 3, C, A, B);						//
+}
+
+// ------------------------------------------------------------------------------------ //
+// a || b
+int Expression::Or(ExprParser *X)
+{
+	int A, B;													//
+
+	if((A = And(X)) < 0){										//
+		return -1;												//
+	}
+	while(Match(X, "||")){										//
+		if((B = And(X)) < 0){									//
+			return -1;											//
+		}
+		A = Emit(X, EXPR_OR, 2, A, B);							//
+	}
+	return A;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// a && b
+int Expression::And(ExprParser *X)
+{
+	int A, B;													//
+
+	if((A = Compare(X)) < 0){									//
+		return -1;												//
+	}
+	while(Match(X, "&&")){										//
+		if((B = Compare(X)) < 0){								//
+			return -1;											//
+		}
+		A = Emit(X, EXPR_AND, 2, A, B);							//
+	}
+	return A;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// a < b ... (One comparison, not chained)
+int Expression::Compare(ExprParser *X)
+{
+	static const char *Tokens[] = {"<=", ">=", "==", "!=", "<", ">"};	// Two characters first
+	static const int Ops[] = {EXPR_LE, EXPR_GE, EXPR_EQ, EXPR_NE, EXPR_LT, EXPR_GT};
+	int A, B;													//
+
+	if((A = Sum(X)) < 0){										//
+		return -1;												//
+	}
+	for(int I = 0; I < 6; I++){									//
+		if(Match(X, Tokens[I])){								//
+			if((B = Sum(X)) < 0){								//
+				return -1;										//
+			}
+			return Emit(X, Ops[I], 2, A, B);					//
+		}
+	}
+	return A;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// a + b, a - b
+int Expression::Sum(ExprParser *X)
+{
+	int A, B, Op;												//
+
+	if((A = Product(X)) < 0){									//
+		return -1;												//
+	}
+	while(1){
+		if(Match(X, "+")){ Op = EXPR_ADD; }
+		else if(Match(X, "-")){ Op = EXPR_SUB; }
+		else{ return A; }
+		if((B = Product(X)) < 0){								//
+			return -1;											//
+		}
+		A = Emit(X, Op, 2, A, B);								//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// a * b, a / b, a % b
+int Expression::Product(ExprParser *X)
+{
+	int A, B, Op;												//
+
+	if((A = Unary(X)) < 0){										//
+		return -1;												//
+	}
+	while(1){
+		if(Match(X, "*")){ Op = EXPR_MUL; }
+		else if(Match(X, "/")){ Op = EXPR_DIV; }
+		else if(Match(X, "%")){ Op = EXPR_MOD; }
+		else{ return A; }
+		if((B = Unary(X)) < 0){									//
+			return -1;											//
+		}
+		A = Emit(X, Op, 2, A, B);								//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// -a, !a
+int Expression::Unary(ExprParser *X)
+{
+	int A;														//
+
+	if(Match(X, "-")){											//
+		return ((A = Unary(X)) < 0) ? -1 : Emit(X, EXPR_NEG, 1, A);	//
+	}
+	if((strncmp(X->Ptr, "!=", 2) != 0)&&Match(X, "!")){			// Not the start of !=
+		return ((A = Unary(X)) < 0) ? -1 : Emit(X, EXPR_NOT, 1, A);	//
+	}
+	return Primary(X);											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Number, variable, function(...), (...)
+int Expression::Primary(ExprParser *X)
+{
+	char *End;													//
+	const char *Name;											//
+	int Len, A[3], Index, Op;									//
+	float K;													//
+
+	while(isspace((unsigned char)*X->Ptr)){						//
+		X->Ptr++;												//
+	}
+	if(isdigit((unsigned char)*X->Ptr)||(*X->Ptr == '.')){		// Number
+		K = strtof(X->Ptr, &End);								//
+		if(End == X->Ptr){										//
+			X->Error = "bad number";							//
+			return -1;											//
+		}
+		X->Ptr = End;											//
+		for(Index = 0; Index < X->P->Consts; Index++){			// Same constant twice? One slot
+			if(X->P->Const[Index] == K){						//
+				break;											//
+			}
+		}
+		if(Index >= EXPR_CONSTS_MAX){							//
+			X->Error = "too many constants";					//
+			return -1;											//
+		}
+		if(Index == X->P->Consts){								//
+			X->P->Const[X->P->Consts++] = K;					//
+		}
+		return Emit(X, EXPR_CONST, 0, Index);					//
+	}
+	if(Match(X, "(")){											// ( expression )
+		if(((A[0] = Cond(X)) < 0)||!Match(X, ")")){				//
+			X->Error = (X->Error != NULL) ? X->Error : "')' expected";	//
+			return -1;											//
+		}
+		return A[0];											//
+	}
+	if(!isalpha((unsigned char)*X->Ptr)){						//
+		X->Error = "value expected";							//
+		return -1;												//
+	}
+
+	Name = X->Ptr;												// Identifier
+	while(isalnum((unsigned char)*X->Ptr)||(*X->Ptr == '_')){	//
+		X->Ptr++;												//
+	}
+	Len = X->Ptr - Name;										//
+	for(int V = 0; V < EXPR_VARS; V++){							// Variable? Its register, no code
+		if((strlen(ExprVarNames[V]) == (size_t)Len)&&(strncmp(Name, ExprVarNames[V], Len) == 0)){
+			return V;											//
+		}
+	}
+	if((Len == 5)&&(strncmp(Name, "state", 5) == 0)){			// state(<name>), resolved now
+		if(!Match(X, "(")){										//
+			X->Error = "'(' expected";							//
+			return -1;											//
+		}
+		while(isspace((unsigned char)*X->Ptr)){					//
+			X->Ptr++;											//
+		}
+		Name = X->Ptr;											//
+		while((*X->Ptr != ')')&&(*X->Ptr != 0)&&!isspace((unsigned char)*X->Ptr)){
+			X->Ptr++;											//
+		}
+		Len = X->Ptr - Name;									//
+		if((Len == 0)||!Match(X, ")")){							//
+			X->Error = "state(<name>) expected";				//
+			return -1;											//
+		}
+		if((X->Find == NULL)||((Index = X->Find(Name, Len, X->Arg)) < 0)||(Index > 0xFFFF)){
+			X->Error = "unknown state";							//
+			return -1;											//
+		}
+		return Emit(X, EXPR_STATE, 0, Index & 0xFF, Index >> 8);	//
+	}
+	for(const ExprFunction *F = ExprFunctions; F->Name != NULL; F++){	// Function
+		if((strlen(F->Name) != (size_t)Len)||(strncmp(Name, F->Name, Len) != 0)){
+			continue;											//
+		}
+		if(!Match(X, "(")){										//
+			X->Error = "'(' expected";							//
+			return -1;											//
+		}
+		for(int I = 0; I < F->Args; I++){						// Arguments
+			if((I > 0)&&!Match(X, ",")){						//
+				X->Error = "',' expected";						//
+				return -1;										//
+			}
+			if((A[I] = Cond(X)) < 0){							//
+				return -1;										//
+			}
+		}
+		if(!Match(X, ")")){										//
+			X->Error = "')' expected";							//
+			return -1;											//
+		}
+		return Emit(X, F->Op, F->Args, A[0], (F->Args > 1) ? A[1] : 0, (F->Args > 2) ? A[2] : 0);
+	}
+	Op = EXPR_LAW;												// Parameter law, '<law>(units)'
+	if((Len > 6)&&(strncmp(&Name[Len - 6], "_units", 6) == 0)){	// or '<law>_units(float)'
+		Op = EXPR_UNITS;										//
+		Len -= 6;												//
+	}
+	if((Index = ParamLaw::Find(Name, Len)) >= 0){				//
+		if(!Match(X, "(")){										//
+			X->Error = "'(' expected";							//
+			return -1;											//
+		}
+		if(((A[0] = Cond(X)) < 0)||!Match(X, ")")){				//
+			X->Error = (X->Error != NULL) ? X->Error : "')' expected";	//
+			return -1;											//
+		}
+		return Emit(X, Op, 1, A[0], Index);						//
+	}
+	X->Error = "unknown name";									//
+	return -1;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Add an instruction. D = the first temporary among its Regs register operands (Freed by
+// this instruction) or a new one. Returns D, -1 if the program is full.
+int Expression::Emit(ExprParser *X, int Op, int Regs, int A, int B, int C)
+{
+	int Ops[3] = {A, B, C};										//
+	int D = -1;													//
+	ExprOp *I;													//
+
+	for(int R = 0; R < Regs; R++){								// Lowest temporary operand
+		if((Ops[R] >= EXPR_VARS)&&((D < 0)||(Ops[R] < D))){		//
+			D = Ops[R];											//
+		}
+	}
+	if(D < 0){													// None, a new one
+		D = X->Next;											//
+	}
+	if(D >= EXPR_REGS){											//
+		X->Error = "too complex (registers)";					//
+		return -1;												//
+	}
+	if(X->P->Ops >= EXPR_OPS_MAX){								//
+		X->Error = "too long";									//
+		return -1;												//
+	}
+	X->Next = D + 1;											// Everything above is free again
+	I = &X->P->Code[X->P->Ops++];								//
+	I->Op = Op;													//
+	I->D = D;													//
+	I->A = A;													//
+	I->B = B;													//
+	I->C = C;													//
+	return D;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Skip blanks, then Token if it's next. Returns true if it was.
+bool Expression::Match(ExprParser *X, const char *Token)
+{
+	int Len = strlen(Token);									//
+
+	while(isspace((unsigned char)*X->Ptr)){						//
+		X->Ptr++;												//
+	}
+	if(strncmp(X->Ptr, Token, Len) != 0){						//
+		return false;											//
+	}
+	if((Len == 1)&&((Token[0] == '<')||(Token[0] == '>'))&&(X->Ptr[1] == '=')){	// '<' of '<='? (Tried first anyway)
+		return false;											//
+	}
+	X->Ptr += Len;												//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
@@ -0,0 +1,109 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			Expression Header for RPi - Linux
+Filename:		Expression.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Small arithmetic expressions (MIDI map argument transforms) compiled
+				once into register bytecode and run by a tiny interpreter, no
+				allocation and no parsing per event.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _EXPRESSION_H
+#define _EXPRESSION_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdint.h>												// Fixed width types
+#include "config.h"												// General Configuration File
+#include "ParamLaw.h"											// XR18 parameter laws
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define EXPR_TEXT_MAX		128									// Expression source length
+#define EXPR_OPS_MAX		48									// Instructions per program
+#define EXPR_CONSTS_MAX		16									// Constants per program
+#define EXPR_REGS			16									// Registers (Variables first, then temporaries)
+
+// -------------------------------------------------------------------------------------
+// Variables (Registers 0..EXPR_VARS-1, loaded by the caller)
+enum ExprVar
+{
+	EXPR_V = 0,													// v	Value (MIDI data byte, 127 / 0 for switches, BPM for tempo)
+	EXPR_S,														// s	Rule state after this event (Toggle / momentary 0 / 1)
+	EXPR_LO,													// lo	Value range
+	EXPR_HI,													// hi
+	EXPR_BPM,													// bpm	Tempo
+	EXPR_MS,													// ms	Beat in whole mS
+	EXPR_VARS													//
+};
+
+// -------------------------------------------------------------------------------------
+// Op Codes
+enum ExprOpCode
+{
+	EXPR_CONST = 1,												// D = Const[A]
+	EXPR_STATE,													// D = state(A | B << 8)
+	EXPR_ADD, EXPR_SUB, EXPR_MUL, EXPR_DIV, EXPR_MOD,			// D = A op B (x / 0 = 0)
+	EXPR_LT, EXPR_LE, EXPR_GT, EXPR_GE, EXPR_EQ, EXPR_NE,		// D = 1 / 0
+	EXPR_AND, EXPR_OR,											//
+	EXPR_MIN, EXPR_MAX, EXPR_POW,								//
+	EXPR_NEG, EXPR_NOT, EXPR_ABS, EXPR_FLOOR, EXPR_ROUND,		// D = op A
+	EXPR_SQRT, EXPR_LOG, EXPR_EXP,								//
+	EXPR_SEL,													// D = A ? B : C
+	EXPR_CLAMP,													// D = A within B..C
+	EXPR_LAW,													// D = law B (units A) as OSC float
+	EXPR_UNITS													// D = law B (OSC float A) in units
+};
+
+// -------------------------------------------------------------------------------------
+// Instruction. D = A op B (C for the 3 operand ones)
+typedef struct _exprOp{
+	uint8_t Op;													// ExprOpCode
+	uint8_t D, A, B, C;											// Registers (CONST: A = constant, STATE: A | B << 8 = index)
+} ExprOp;
+
+// -------------------------------------------------------------------------------------
+// Compiled Expression
+typedef struct _exprProgram{
+	ExprOp Code[EXPR_OPS_MAX];									//
+	float Const[EXPR_CONSTS_MAX];								//
+	uint8_t Ops;												// Instructions used
+	uint8_t Consts;												//
+	uint8_t Out;												// Result register
+} ExprProgram;
+
+// -------------------------------------------------------------------------------------
+// Name lookup for state(<name>) at compile time (Index, -1 = unknown), value at run time
+typedef int (*ExprFindCallBack)(const char *Name, int Len, void *Arg);
+typedef float (*ExprStateCallBack)(int Index, void *Arg);
+
+struct _exprParser;												// Compile state (Expression.cpp)
+
+// -------------------------------------------------------------------------------------
+// Define Expression Class
+class Expression
+{
+private:
+	static int Cond(struct _exprParser *X);						// a ? b : c	(Each returns the result register, -1 = error)
+	static int Or(struct _exprParser *X);						// ||
+	static int And(struct _exprParser *X);						// &&
+	static int Compare(struct _exprParser *X);					// < <= > >= == !=
+	static int Sum(struct _exprParser *X);						// + -
+	static int Product(struct _exprParser *X);					// * / %
+	static int Unary(struct _exprParser *X);					// - !
+	static int Primary(struct _exprParser *X);					// Number, variable, function(...), (...)
+	static int Emit(struct _exprParser *X, int Op, int Regs, int A, int B = 0, int C = 0);	// Regs operands are registers. Returns D.
+	static bool Match(struct _exprParser *X, const char *Token);	// Skip Token if next
+
+public:
+	static bool Compile(const char *Text, ExprProgram *P, ExprFindCallBack Find = 0, void *Arg = 0);	// Returns false if bad (Reason printed)
+	static float Run(const ExprProgram *P, float *R, ExprStateCallBack State = 0, void *Arg = 0);	// R = EXPR_REGS registers, variables set
+};
+
+// -------------------------------------------------------------------------------------
+#endif
@@ -0,0 +1,166 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			Foot Switches for RPi - Linux
+Filename:		FootSwitch.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Debounce and gestures for all foot switches at once.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Leading edge debounce: the first edge that changes the level is taken at
+	  once (PRESS goes out within the edge latency), then edges are ignored for
+	  FTSW_LOCKOUT. At the end of the lock out the pin is read again, so a
+	  release that happened during the bounce isn't lost.
+	# Per switch timers on the event loop, every switch runs on its own:
+		PRESS	first edge down
+		HOLD	HOLD_TIME after PRESS, still down (no TAP for this press)
+		RELEASE	debounced edge up
+		TAP		on RELEASE if no HOLD, stamped with the press time
+		DOUBLE_TAP	straight after a TAP that came FTSW_DOUBLE_TIME or less after
+				the previous one (press to press). The first TAP isn't delayed to
+				wait for a possible second one.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <stdio.h>												// printf()
+#include <string.h>												// memset()
+#include "FootSwitch.h"											// Foot Switch Class
+#include "Clock.h"												// Time source
+
+// ------------------------------------------------------------------------------------ //
+// Constructor
+FootSwitches::FootSwitches()
+{
+	Loop = NULL;												//
+	Edges = NULL;												//
+	Pins = NULL;												//
+	Fn = NULL;													//
+	Count = 0;													//
+	memset(Sw, 0, sizeof(Sw));									//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Open. Gestures go to CallBack (Called from the event loop). Returns true if OK.
+bool FootSwitches::Open(EventLoop *L, GPIOEdge *Edge, RPiIO *IO, FootSwitchCallBack CallBack)
+{
+	if((L == NULL)||(Edge == NULL)||(IO == NULL)||(CallBack == NULL)){	//
+		return false;											//
+	}
+	Loop = L;													//
+	Edges = Edge;												//
+	Pins = IO;													//
+	Fn = CallBack;												//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Watch switch on Pin, pressed when it reads Active. Returns true if OK.
+bool FootSwitches::Add(int Pin, int Active)
+{
+	SwitchState *S = NULL;										//
+
+	if(Loop == NULL){											// Not open?
+		return false;											//
+	}
+	for(int I = 0; I < Count; I++){								// Already added?
+		if(Sw[I].Pin == Pin){									//
+			return true;										//
+		}
+	}
+	if(Count >= FTSW_MAX){										//
+		printf("\r\nERROR!!! Foot switch: too many switches\r\n");
+		return false;											//
+	}
+
+	S = &Sw[Count];												//
+	memset(S, 0, sizeof(SwitchState));							//
+	S->Pin = Pin;												//
+	S->Active = Active;											//
+	S->Level = !Active;											// Assume released
+	S->Owner = this;											//
+	S->Lockout.Fn = &FootSwitches::OnLockout;					//
+	S->Lockout.Arg = S;											//
+	S->Hold.Fn = &FootSwitches::OnHold;							//
+	S->Hold.Arg = S;											//
+	if(!Edges->Watch(Pin, &FootSwitches::OnEdge, S)){			//
+		return false;											//
+	}
+	Count++;													//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Debounced level change on S at Time
+void FootSwitches::Accept(SwitchState *S, int Level, uint64_t Time)
+{
+	S->Level = Level;											//
+	S->Locked = true;											// Ignore bounce
+	Loop->StartTimer(&S->Lockout, CLK->Now() + (FTSW_LOCKOUT * NS_PER_MS));	//
+
+	if(Level == S->Active){										// Pressed?
+		S->PressTime = Time;									//
+		S->Held = false;										//
+		Loop->StartTimer(&S->Hold, Time + (HOLD_TIME * NS_PER_MS));	// Hold check
+		Fn(S->Pin, FTSW_PRESS, Time);							//
+		return;													//
+	}
+
+	Loop->StopTimer(&S->Hold);									// Released
+	Fn(S->Pin, FTSW_RELEASE, Time);								//
+	if(S->Held){												// End of a hold, not a tap
+		S->LastTap = 0;											//
+		return;													//
+	}
+	Fn(S->Pin, FTSW_TAP, S->PressTime);							//
+	if((S->LastTap != 0)&&(S->PressTime - S->LastTap <= FTSW_DOUBLE_TIME * NS_PER_MS)){	// Second tap?
+		Fn(S->Pin, FTSW_DOUBLE_TAP, S->PressTime);				//
+		S->LastTap = 0;											// A third tap starts again
+	}else{
+		S->LastTap = S->PressTime;								//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// GPIO edge (Event loop)
+void FootSwitches::OnEdge(int Pin, int Level, uint64_t Time, void *Arg)
+{
+	SwitchState *S = (SwitchState *)Arg;						//
+
+	if(S->Locked || (Level == S->Level)){						// Bounce / no change?
+		return;													//
+	}
+	S->Owner->Accept(S, Level, Time);							//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Lock out over (Event loop timer). Catch up with anything missed meanwhile.
+void FootSwitches::OnLockout(void *Arg)
+{
+	SwitchState *S = (SwitchState *)Arg;						//
+	int Level;													//
+
+	S->Locked = false;											//
+	if(((Level = S->Owner->Pins->InputPin(S->Pin)) >= 0)&&(Level != S->Level)){	// Changed while locked?
+		S->Owner->Accept(S, Level, CLK->Now());					//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Hold time reached (Event loop timer)
+void FootSwitches::OnHold(void *Arg)
+{
+	SwitchState *S = (SwitchState *)Arg;						//
+
+	if(S->Level == S->Active){									// Still down?
+		S->Held = true;											//
+		S->Owner->Fn(S->Pin, FTSW_HOLD, S->Hold.Due);			//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
@@ -0,0 +1,90 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			Foot Switch Header for RPi - Linux
+Filename:		FootSwitch.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Debounce and gestures (press, tap, double tap, hold) for all foot
+				switches at once. Driven by GPIO edges and event loop timers, never
+				sleeps, so one held switch doesn't block the others.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _FOOTSWITCH_H
+#define _FOOTSWITCH_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdint.h>												// Fixed width types
+#include "config.h"												// General Configuration File
+#include "EventLoop.h"											// Event Loop (Timers)
+#include "GPIOEdge.h"											// GPIO Edges
+#include "IO.h"													// IO Class
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define FTSW_MAX			4									// Foot switches
+#define FTSW_LOCKOUT		30									// Ignore bounce after an edge in mS
+#define FTSW_DOUBLE_TIME	400									// Second tap within mS (Press to press)
+
+// -------------------------------------------------------------------------------------
+// Gestures
+enum FootSwitchGesture
+{
+	FTSW_PRESS = 1,												// Pressed (First edge, at once)
+	FTSW_RELEASE,												// Released
+	FTSW_TAP,													// Released before HOLD_TIME (Time = press)
+	FTSW_DOUBLE_TAP,											// Second tap within FTSW_DOUBLE_TIME (After its TAP)
+	FTSW_HOLD													// Still pressed after HOLD_TIME
+};
+
+// -------------------------------------------------------------------------------------
+// Gesture Callback. Pin = wiringPi number, Time = CLK nS.
+typedef void (*FootSwitchCallBack)(int Pin, int Gesture, uint64_t Time);
+
+class FootSwitches;												//
+
+// -------------------------------------------------------------------------------------
+// Switch State
+typedef struct _switchState{
+	int Pin;													// wiringPi pin
+	int Active;													// Pressed level
+	int Level;													// Debounced level
+	bool Locked;												// In lock out (Edges ignored)
+	bool Held;													// HOLD sent for this press
+	uint64_t PressTime;											// This press (nS)
+	uint64_t LastTap;											// Previous tap press (nS, 0 = none)
+	LoopTimer Lockout;											// End of lock out
+	LoopTimer Hold;												// HOLD_TIME after press
+	FootSwitches *Owner;										//
+} SwitchState;
+
+// -------------------------------------------------------------------------------------
+// Define Foot Switches Class
+class FootSwitches
+{
+private:
+	EventLoop *Loop;											//
+	GPIOEdge *Edges;											// Edge source
+	RPiIO *Pins;												// Level checks
+	FootSwitchCallBack Fn;										//
+	SwitchState Sw[FTSW_MAX];									//
+	int Count;													//
+
+	void Accept(SwitchState *S, int Level, uint64_t Time);		// Debounced edge
+	static void OnEdge(int Pin, int Level, uint64_t Time, void *Arg);	// GPIO edge
+	static void OnLockout(void *Arg);							// Lock out over
+	static void OnHold(void *Arg);								// Hold time reached
+
+public:
+	FootSwitches();												//
+
+	bool Open(EventLoop *L, GPIOEdge *Edge, RPiIO *IO, FootSwitchCallBack CallBack);	//
+	bool Add(int Pin, int Active = LOW);						// Watch a switch (Pull-up, pressed = LOW)
+};
+
+// -------------------------------------------------------------------------------------
+#endif
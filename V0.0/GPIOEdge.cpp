@@ -0,0 +1,245 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			GPIO Edge Events for RPi - Linux
+Filename:		GPIOEdge.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Input edges as events (GPIO character device, or polled fallback).
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Character device - each pin is requested as a line event (both edges) on
+	  GPIO_CHIP. The kernel time stamps the edge in the interrupt, so the time
+	  passed on is when the switch moved, not when we got round to it. The main
+	  thread sleeps in epoll_wait() until then, no CPU used.
+	# Kernels before 5.7 stamp line events with CLOCK_REALTIME, newer ones with
+	  CLOCK_MONOTONIC. KernelTime() works out which and converts.
+	# Fallback - no chip, no permission, or a simulation: the pins are read
+	  through RPiIO every GPIO_POLL_TIME mS from the event loop and edges are
+	  stamped with CLK, same callbacks either way.
+	# Pull-ups are left to RPiIO::InputPullUp(), the line request doesn't touch them.
+	# No debouncing here, every edge is reported.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <stdio.h>												// printf()
+#include <string.h>												// memset(), strncpy()
+#include <unistd.h>												// read(), close()
+#include <fcntl.h>												// open()
+#include <errno.h>												// errno
+#include <time.h>												// clock_gettime()
+#include <sys/ioctl.h>											// ioctl()
+#include <linux/gpio.h>											// GPIO character device
+#include "GPIOEdge.h"											// GPIO Edge Class
+#include "Clock.h"												// Time source
+#include "Sim.h"												// Simulation
+#include "Trace.h"												// Flight Recorder
+
+// ------------------------------------------------------------------------------------ //
+// Constructor
+GPIOEdge::GPIOEdge()
+{
+	Loop = NULL;												//
+	Pins = NULL;												//
+	ChipFd = -1;												//
+	Polling = false;											//
+	for(int I = 0; I < GPIO_EDGE_PINS; I++){					//
+		Lines[I].Pin = -1;										// Free
+		Lines[I].Fd = -1;										//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+GPIOEdge::~GPIOEdge()
+{
+	Close();													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Open. Chip = "/dev/gpiochip0" etc. Falls back to polling IO if the chip can't be
+// used. Returns false only if there is no way to get edges at all.
+bool GPIOEdge::Open(EventLoop *L, RPiIO *IO, const char *Chip)
+{
+	Close();													//
+	Loop = L;													//
+	Pins = IO;													//
+	if((Loop == NULL)||(Pins == NULL)){							//
+		return false;											//
+	}
+
+	if((Chip != NULL)&&(SIM == NULL)){							// Hardware?
+		if((ChipFd = open(Chip, O_RDONLY | O_CLOEXEC)) < 0){	//
+			printf("GPIO: can't open %s (%s), polling instead\r\n", Chip, strerror(errno));
+		}
+	}
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Close (Stop watching all pins)
+void GPIOEdge::Close(void)
+{
+	for(int I = 0; I < GPIO_EDGE_PINS; I++){					//
+		if(Lines[I].Fd >= 0){									//
+			if(Loop != NULL){									//
+				Loop->Remove(Lines[I].Fd);						//
+			}
+			close(Lines[I].Fd);									//
+		}
+		Lines[I].Pin = -1;										//
+		Lines[I].Fd = -1;										//
+	}
+	if(Polling && (Loop != NULL)){								//
+		Loop->RemovePoll(&GPIOEdge::OnPoll, this);				//
+	}
+	Polling = false;											//
+	if(ChipFd >= 0){											//
+		close(ChipFd);											//
+		ChipFd = -1;											//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Report both edges of Pin (wiringPi number) to Fn. Returns true if OK.
+bool GPIOEdge::Watch(int Pin, GPIOEdgeCallBack Fn, void *Arg)
+{
+	GPIOLine *L = NULL;											//
+
+	if((Loop == NULL)||(Fn == NULL)){							// Not open?
+		return false;											//
+	}
+	for(int I = 0; I < GPIO_EDGE_PINS; I++){					// Already watched? Just swap callback
+		if(Lines[I].Pin == Pin){								//
+			Lines[I].Fn = Fn;									//
+			Lines[I].Arg = Arg;									//
+			return true;										//
+		}
+	}
+	for(int I = 0; I < GPIO_EDGE_PINS; I++){					// Free slot?
+		if(Lines[I].Pin < 0){									//
+			L = &Lines[I];										//
+			break;												//
+		}
+	}
+	if(L == NULL){												//
+		printf("\r\nERROR!!! GPIO: too many pins watched\r\n");
+		return false;											//
+	}
+
+	L->Pin = Pin;												//
+	L->Fn = Fn;													//
+	L->Arg = Arg;												//
+	L->Owner = this;											//
+	L->Fd = -1;													//
+	L->Level = Pins->InputPin(Pin);								// Current level (No edge for it)
+
+	if((ChipFd >= 0)&&RequestLine(L)){							// Character device?
+		if(Loop->Add(L->Fd, EPOLLIN, &GPIOEdge::OnLineEvent, L)){	//
+			return true;										//
+		}
+		close(L->Fd);											// Can't watch, poll it
+		L->Fd = -1;												//
+	}
+
+	if(!Polling){												// Fallback, poll
+		Polling = Loop->AddPoll(&GPIOEdge::OnPoll, this, GPIO_POLL_TIME);	//
+	}
+	return Polling;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Any pin using the polled fallback?
+bool GPIOEdge::IsPolled(void)
+{
+	return Polling;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Request a line event for L (both edges). Returns true if L->Fd is set.
+bool GPIOEdge::RequestLine(GPIOLine *L)
+{
+	struct gpioevent_request Req;								//
+	struct gpiohandle_data Data;								//
+
+	memset(&Req, 0, sizeof(Req));								//
+	Req.lineoffset = wpiPinToGpio(L->Pin);						// wiringPi -> BCM line
+	Req.handleflags = GPIOHANDLE_REQUEST_INPUT;					//
+	Req.eventflags = GPIOEVENT_REQUEST_BOTH_EDGES;				//
+	strncpy(Req.consumer_label, "MOLink", sizeof(Req.consumer_label) - 1);	//
+
+	if(ioctl(ChipFd, GPIO_GET_LINEEVENT_IOCTL, &Req) < 0){		//
+		printf("GPIO: can't request line %u (%s), polling pin %i\r\n", Req.lineoffset, strerror(errno), L->Pin);
+		return false;											//
+	}
+	L->Fd = Req.fd;												//
+	if(ioctl(L->Fd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &Data) == 0){	// Level as the kernel sees it
+		L->Level = Data.values[0];								//
+	}
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Line event time stamp (CLOCK_MONOTONIC or, on old kernels, CLOCK_REALTIME) to CLK nS
+uint64_t GPIOEdge::KernelTime(uint64_t Stamp)
+{
+	struct timespec Ts;											//
+	uint64_t Mono, Real;										//
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);						//
+	Mono = ((uint64_t)Ts.tv_sec * NS_PER_SEC) + Ts.tv_nsec;		//
+	if((Stamp <= Mono)&&(Mono - Stamp < 60 * NS_PER_SEC)){		// Monotonic and recent?
+		return Stamp;											//
+	}
+	clock_gettime(CLOCK_REALTIME, &Ts);							// Real time stamp
+	Real = ((uint64_t)Ts.tv_sec * NS_PER_SEC) + Ts.tv_nsec;		//
+	if((Stamp <= Real)&&(Real - Stamp < 60 * NS_PER_SEC)){		//
+		return Mono - (Real - Stamp);							// Same age on the monotonic clock
+	}
+	return Mono;												// Unknown, use arrival
+}
+
+// ------------------------------------------------------------------------------------ //
+// Line event(s) ready (Event loop callback)
+void GPIOEdge::OnLineEvent(int Fd, uint32_t Events, void *Arg)
+{
+	GPIOLine *L = (GPIOLine *)Arg;								//
+	struct gpioevent_data Ev[16];								//
+	int Len;													//
+
+	if((Len = read(Fd, Ev, sizeof(Ev))) <= 0){					//
+		return;													//
+	}
+	for(int I = 0; I < (int)(Len / sizeof(Ev[0])); I++){		//
+		L->Level = (Ev[I].id == GPIOEVENT_EVENT_RISING_EDGE) ? 1 : 0;	//
+		TRACE(TRC_GPIO_EDGE, L->Pin, L->Level);					//
+		L->Fn(L->Pin, L->Level, KernelTime(Ev[I].timestamp), L->Arg);	//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Fallback, read polled pins (Event loop poll callback)
+void GPIOEdge::OnPoll(void *Arg)
+{
+	GPIOEdge *C = (GPIOEdge *)Arg;								//
+	int Level;													//
+
+	for(int I = 0; I < GPIO_EDGE_PINS; I++){					//
+		GPIOLine *L = &C->Lines[I];								//
+		if((L->Pin < 0)||(L->Fd >= 0)){							// Free or character device?
+			continue;											//
+		}
+		if(((Level = C->Pins->InputPin(L->Pin)) >= 0)&&(Level != L->Level)){	// Edge?
+			L->Level = Level;									//
+			TRACE(TRC_GPIO_EDGE, L->Pin, L->Level);				//
+			L->Fn(L->Pin, L->Level, CLK->Now(), L->Arg);		//
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
@@ -0,0 +1,75 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			GPIO Edge Events Header for RPi - Linux
+Filename:		GPIOEdge.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Input edges as events. Uses the GPIO character device (/dev/gpiochipN
+				line events, kernel time stamps) watched by the event loop, or polls
+				the pins through RPiIO (wiringPi / simulation) when that isn't there.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _GPIOEDGE_H
+#define _GPIOEDGE_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdint.h>												// Fixed width types
+#include "config.h"												// General Configuration File
+#include "EventLoop.h"											// Event Loop
+#include "IO.h"													// IO Class (Fallback)
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define GPIO_EDGE_PINS		8									// Watched pins
+#define GPIO_POLL_TIME		1									// Fallback poll period in mS
+
+// -------------------------------------------------------------------------------------
+// Edge Callback. Pin = wiringPi number, Level = new level, Time = CLK nS of the edge.
+typedef void (*GPIOEdgeCallBack)(int Pin, int Level, uint64_t Time, void *Arg);
+
+class GPIOEdge;													//
+
+// -------------------------------------------------------------------------------------
+// Watched Line
+typedef struct _gpioLine{
+	int Pin;													// wiringPi pin (-1 = free)
+	int Fd;														// Line event fd (-1 = polled)
+	int Level;													// Last level
+	GPIOEdgeCallBack Fn;										//
+	void *Arg;													// Passed to Fn
+	GPIOEdge *Owner;											//
+} GPIOLine;
+
+// -------------------------------------------------------------------------------------
+// Define GPIO Edge Class
+class GPIOEdge
+{
+private:
+	EventLoop *Loop;											//
+	RPiIO *Pins;												// Fallback reads
+	int ChipFd;													// /dev/gpiochipN (-1 = polling)
+	bool Polling;												// Poll source registered
+	GPIOLine Lines[GPIO_EDGE_PINS];								//
+
+	bool RequestLine(GPIOLine *L);								// Character device line event
+	static uint64_t KernelTime(uint64_t Stamp);					// Event time stamp to CLK nS
+	static void OnLineEvent(int Fd, uint32_t Events, void *Arg);	// Loop callback
+	static void OnPoll(void *Arg);								// Loop poll callback
+
+public:
+	GPIOEdge();													//
+	~GPIOEdge();												//
+
+	bool Open(EventLoop *L, RPiIO *IO, const char *Chip);		// Chip NULL = always poll
+	void Close(void);											//
+	bool Watch(int Pin, GPIOEdgeCallBack Fn, void *Arg = NULL);	// Report both edges of Pin
+	bool IsPolled(void);										// Using the fallback?
+};
+
+// -------------------------------------------------------------------------------------
+#endif
@@ -18,7 +18,6 @@ Description:  General Routines.
 #include <stdlib.h>                                   // atoi(), strtof()
 #include <sys/ioctl.h>                                // ioctl()
 #include <termios.h>                                  // 
-#include <sys/time.h>                                 // for timers
 #include "GenLib.h"                                   // General Library
 
 // ------------------------------------------------------------------------------------ //
@@ -112,39 +111,6 @@ float GenLib::getCPUTemperature(void)
 	return Tmp;                                         // Return Temperature
 }
 
-// ---------------------------------------------------------------- //
-// StartTimer()
-void GenLib::StartTimer(void)
-{
-	gettimeofday(&start_time, NULL);                    // Start Timer
-}
-
-// ---------------------------------------------------------------- //
-// StopTimer()
-void GenLib::StopTimer(void)
-{
-	gettimeofday(&end_time, NULL);                     // Stop Timer
-}
-
-// ---------------------------------------------------------------- //
-// Get Time Difference
-long long GenLib::TimeDelta(void)
-{
-	struct timeval difference;                          //
-
-	difference.tv_sec = end_time.tv_sec - start_time.tv_sec ;     //
-	difference.tv_usec = end_time.tv_usec - start_time.tv_usec;   //
-
-	// Using while instead of if below makes the code slightly more robust.
-	while(difference.tv_usec < 0)                       //
-	{
-		difference.tv_usec += 1000000;                    //
-		difference.tv_sec -= 1;                           //
-	}
-
-	return 1000000LL * difference.tv_sec + difference.tv_usec;		//
-}
-
 // ------------------------------------------------------------------------------------ //
 void GenLib::PrintHex(char *Data, int Len)
 {
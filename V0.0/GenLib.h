@@ -20,9 +20,6 @@ Description:  General Routines.
 
 class GenLib 
 {
-private:
-	struct timeval start_time, end_time;              // Timers
-	
 public:
 	GenLib(void);
 	~GenLib();
@@ -30,9 +27,6 @@ public:
 	int getKey(void);
 	void getCPUID(char *ID);
 	float getCPUTemperature(void);
-	void StartTimer(void);
-	void StopTimer(void);
-	long long TimeDelta(void);
 	
 	void PrintHex(char *Data, int Len);
 };
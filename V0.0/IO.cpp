@@ -43,6 +43,8 @@ Resources:
 #include <string.h>                       // For memset()
 #include <pthread.h>                      // Threads
 #include "IO.h"                           // IO Class
+#include "Clock.h"                        // Delays
+#include "Sim.h"                          // Simulated pins
 
 
 // -------------------------------------------------------------------------------------
@@ -51,6 +53,11 @@ RPiIO::RPiIO()
 {
 	int Ret;                                //
 	
+	if(SIM != NULL){                        // Simulation? No hardware to set up
+		Init = 1;                             //
+		return;                               //
+	}
+	
 	// Initialise wiringPI (BCM2835)
 	Ret = wiringPiSetup();                  // Initialise Wiring Pi Library
 	if(Ret != 0){                           // OK?
@@ -81,11 +88,10 @@ RPiIO::~RPiIO()
 void RPiIO::OutputPulse(int Pin, int OnDelay, int OffDelay)
 {
 	if(Init){                                 // OK?
-		pinMode(Pin, OUTPUT);                   // Set for output pin
-		digitalWrite(Pin, HIGH);                // Turn on pin
-		delay(OnDelay);                         // On Delay
-		digitalWrite(Pin, LOW);                 // Turn Off Pin
-		delay(OffDelay);                        // Delay for 1 second
+		OutputPin(Pin, HIGH);                   // Turn on pin
+		CLK->SleepMs(OnDelay);                  // On Delay
+		OutputPin(Pin, LOW);                    // Turn Off Pin
+		CLK->SleepMs(OffDelay);                 // Delay for 1 second
 	}
 }
 
@@ -94,6 +100,10 @@ void RPiIO::OutputPulse(int Pin, int OnDelay, int OffDelay)
 void RPiIO::OutputPin(int Pin, int State)
 {
 	if(Init){                                 // OK?
+		if(SIM != NULL){                        // Simulation?
+			SIM->DigitalWrite(Pin, State);        //
+			return;                               //
+		}
 		pinMode(Pin, OUTPUT);                   // Set for output pin
 		digitalWrite(Pin, State);               // Set State of Pin
 	}
@@ -106,6 +116,9 @@ int RPiIO::InputPin(int Pin)
 	int State;                                //
 	
 	if(Init){                                 // OK?
+		if(SIM != NULL){                        // Simulation?
+			return SIM->DigitalRead(Pin);         //
+		}
 		pinMode(Pin, INPUT);                    // Set for input pin
 		State = digitalRead (Pin);              // Get State of Pin
 		return State;                           //
@@ -114,6 +127,20 @@ int RPiIO::InputPin(int Pin)
 	return -1;                                // Return error
 }
 
+// -------------------------------------------------------------------------------------
+// Set Pin as Input with Pull-Up
+void RPiIO::InputPullUp(int Pin)
+{
+	if(Init){                                 // OK?
+		if(SIM != NULL){                        // Simulation?
+			SIM->PullUp(Pin);                     //
+			return;                               //
+		}
+		pinMode(Pin, INPUT);                    // Set for input
+		pullUpDnControl(Pin, PUD_UP);           // Set pull-up pin
+	}
+}
+
 // -------------------------------------------------------------------------------------
 // Input & Debounce from Pin (Read).
 // Return active state 0 or 1. Or 2 if held above timeout, Or -1 on error.
@@ -123,14 +150,13 @@ int RPiIO::InputDebounce(int Pin, char ActiveState, int TimeOut)
 	int TimeOutCnt = 0;                       //
 	
 	if(Init){                                 // OK?
-		pinMode(Pin, INPUT);                    // Set for input pin
 		do{
-			State = digitalRead(Pin);             // Get State of Pin
+			State = InputPin(Pin);                // Get State of Pin
 			if((State == ActiveState)&&(Active == 0)){			// Active transition?
-				delay(DEBOUNCE_TIME);               // Debounce delay
+				CLK->SleepMs(DEBOUNCE_TIME);        // Debounce delay
 				Active = 1;                         // Set Active
 			}
-			delay(1);                             // 1ms delay
+			CLK->SleepMs(1);                      // 1ms delay
 			TimeOutCnt++;                         // Time-out, keep count
 		}while((State == ActiveState)&&(TimeOutCnt < TimeOut));	// Loop until released
 		if(TimeOutCnt >= TimeOut){              // Timed Out?
@@ -40,6 +40,7 @@ public:
 	void OutputPulse(int Pin, int OnDelay, int OffDelay);		//
 	void OutputPin(int Pin, int State);							//
 	int InputPin(int Pin);										//
+	void InputPullUp(int Pin);									// Input with pull-up
 	int InputDebounce(int Pin, char ActiveState, int TimeOut);	//
 	
 };
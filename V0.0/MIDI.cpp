@@ -0,0 +1,144 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			MIDI Parser for Linux
+Filename:		MIDI.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Byte stream MIDI parser.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Real time bytes (F8-FF) are returned the moment they arrive, even in the
+	  middle of another message or SysEx, and don't disturb running status.
+	# System Common messages cancel running status, as per the MIDI 1.0 spec.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <string.h>												// memset()
+#include "MIDI.h"												// MIDI Parser Class
+
+// ------------------------------------------------------------------------------------ //
+// Data bytes per status (Channel messages by high nibble, System Common by low nibble)
+static const int8_t ChannelLength[8] = {2, 2, 2, 2, 1, 1, 2, 0};	// 8x 9x Ax Bx Cx Dx Ex Fx
+static const int8_t CommonLength[8] = {0, 1, 2, 1, 0, 0, 0, 0};		// F0 F1 F2 F3 F4 F5 F6 F7
+
+// ------------------------------------------------------------------------------------ //
+// Constructor
+MIDIParser::MIDIParser()
+{
+	Reset();													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Reset (Forget running status and partial messages)
+void MIDIParser::Reset(void)
+{
+	Status = 0;													//
+	Running = false;											//
+	Count = 0;													//
+	Need = 0;													//
+	InSysEx = false;											//
+	SysExLen = 0;												//
+	memset(Data, 0, sizeof(Data));								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Data bytes following a status byte
+int MIDIParser::DataLength(uint8_t Status)
+{
+	if(Status < 0xF0){											// Channel message?
+		return ChannelLength[(Status >> 4) & 0x07];				//
+	}
+	if(Status < 0xF8){											// System Common?
+		return CommonLength[Status & 0x07];						//
+	}
+	return 0;													// Real time
+}
+
+// ------------------------------------------------------------------------------------ //
+// Parse one byte. Returns true when Msg holds a complete message.
+bool MIDIParser::Parse(uint8_t Byte, MIDIMessage *Msg)
+{
+	if(Byte >= 0xF8){											// Real time, pass straight through
+		Msg->Raw[0] = Byte;										//
+		Msg->Len = 1;											//
+		Msg->SysEx = NULL;										//
+		Msg->SysExLen = 0;										//
+		return true;											//
+	}
+
+	if(Byte & 0x80){											// Status byte?
+		if(Byte == MIDI_SYSEX_END){								// End of SysEx?
+			if(!InSysEx){										// Stray?
+				return false;									//
+			}
+			InSysEx = false;									//
+			if(SysExLen < MIDI_SYSEX_MAX){						//
+				SysEx[SysExLen++] = Byte;						//
+			}
+			Msg->Raw[0] = MIDI_SYSEX;							//
+			Msg->Len = 1;										//
+			Msg->SysEx = SysEx;									//
+			Msg->SysExLen = SysExLen;							//
+			return true;										//
+		}
+
+		InSysEx = false;										// Any other status ends SysEx
+		Status = Byte;											//
+		Running = (Byte < 0xF0);								// Only channel messages run
+		Count = 0;												//
+		Need = DataLength(Byte);								//
+
+		if(Byte == MIDI_SYSEX){									// Start of SysEx?
+			InSysEx = true;										//
+			SysEx[0] = Byte;									//
+			SysExLen = 1;										//
+			Status = 0;											//
+			return false;										//
+		}
+		if(Need == 0){											// Complete already? (F6, undefined F4/F5)
+			Msg->Raw[0] = Byte;									//
+			Msg->Len = 1;										//
+			Msg->SysEx = NULL;									//
+			Msg->SysExLen = 0;									//
+			Status = 0;											//
+			return (Byte == MIDI_TUNE_REQ);						// Drop undefined
+		}
+		return false;											//
+	}
+
+	// Data byte
+	if(InSysEx){												// SysEx payload?
+		if(SysExLen < MIDI_SYSEX_MAX - 1){						// Leave room for F7
+			SysEx[SysExLen++] = Byte;							//
+		}
+		return false;											//
+	}
+	if(Status == 0){											// No status to belong to?
+		return false;											//
+	}
+
+	Data[Count++] = Byte;										//
+	if(Count < Need){											// More to come?
+		return false;											//
+	}
+
+	Msg->Raw[0] = Status;										// Complete
+	Msg->Raw[1] = Data[0];										//
+	Msg->Raw[2] = (Need > 1) ? Data[1] : 0;						//
+	Msg->Len = 1 + Need;										//
+	Msg->SysEx = NULL;											//
+	Msg->SysExLen = 0;											//
+	Count = 0;													//
+	if(!Running){												// System Common, no running status
+		Status = 0;												//
+	}
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
@@ -0,0 +1,84 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			MIDI Parser Header for Linux
+Filename:		MIDI.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Byte stream MIDI parser. Turns whatever chunks the UART delivers into
+				complete messages (running status, interleaved real time bytes, SysEx).
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _MIDI_H
+#define _MIDI_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdint.h>												// Fixed width types
+#include "config.h"												// General Configuration File
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define MIDI_SYSEX_MAX		256									// Largest SysEx kept (Longer ones are truncated)
+
+// -------------------------------------------------------------------------------------
+// MIDI Status Bytes
+#define MIDI_NOTE_OFF		0x80								// Channel Voice (Low nibble = channel)
+#define MIDI_NOTE_ON		0x90								//
+#define MIDI_POLY_PRESS		0xA0								//
+#define MIDI_CC				0xB0								//
+#define MIDI_PROGRAM		0xC0								//
+#define MIDI_CHAN_PRESS		0xD0								//
+#define MIDI_PITCH_BEND		0xE0								//
+#define MIDI_SYSEX			0xF0								// System Common
+#define MIDI_MTC_QF			0xF1								//
+#define MIDI_SONG_POS		0xF2								//
+#define MIDI_SONG_SEL		0xF3								//
+#define MIDI_TUNE_REQ		0xF6								//
+#define MIDI_SYSEX_END		0xF7								//
+#define MIDI_TICK			0xF8								// System Real Time
+#define MIDI_START			0xFA								//
+#define MIDI_CONTINUE		0xFB								//
+#define MIDI_STOP			0xFC								//
+#define MIDI_SENSING		0xFE								//
+#define MIDI_RESET			0xFF								//
+
+#define MIDI_IS_REALTIME(B)	((uint8_t)(B) >= 0xF8)				//
+
+// -------------------------------------------------------------------------------------
+// Complete MIDI Message
+typedef struct _midiMessage{
+	uint8_t Raw[3];												// Status + data (Status only for real time)
+	uint8_t Len;												// Bytes used in Raw (1-3)
+	const uint8_t *SysEx;										// SysEx, F0 .. F7 inclusive (Raw[0] = 0xF0)
+	int SysExLen;												//
+} MIDIMessage;
+
+// -------------------------------------------------------------------------------------
+// Define MIDI Parser Class
+class MIDIParser
+{
+private:
+	uint8_t Status;												// Current status (0 = none)
+	bool Running;												// Status may be reused (Channel messages)
+	uint8_t Data[2];											// Data bytes so far
+	int Count;													// Data bytes received
+	int Need;													// Data bytes needed
+	bool InSysEx;												//
+	uint8_t SysEx[MIDI_SYSEX_MAX];								//
+	int SysExLen;												//
+
+public:
+	MIDIParser();												//
+
+	void Reset(void);											//
+	bool Parse(uint8_t Byte, MIDIMessage *Msg);					// True when Msg is complete
+
+	static int DataLength(uint8_t Status);						// Data bytes after Status
+};
+
+// -------------------------------------------------------------------------------------
+#endif
@@ -0,0 +1,1013 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			MIDI Map for RPi - Linux
+Filename:		MIDIMap.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	MIDI to OSC mapping rules, compiled to lookup tables.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Map file (MIDI_MAP_FILE in config.h, or './MOLink -c map.conf'):
+		# source	chan	number	values	mode		address			arg [out lo hi] [led pin] [smooth mS] [over len] [wave w] [quantize q]
+		cc			1		80		127		toggle		/ch/01/mix/on	i
+		cc			1		7		*		absolute	/ch/01/mix/fader f 0.0 1.0
+		note		10		36		1-127	momentary	/config/mute/3	i
+		program		*		*		0-3		absolute	/-snap/load		i 1 4
+		switch		*		0		127		toggle		/config/mute/1	i led 3
+		cc			1		11		*		absolute	/ch/01/mix/fader f = pow(v / 127, 2)
+		tempo		*		*		*		absolute	/fx/3/par/01	f = delay(ms)
+		tempo		*		1/8.	*		absolute	/fx/1/par/02	f = delay(ms)
+		cc			1		4		*		continuous	/ch/01/mix/fader f 0 0.75 smooth 40
+		cc14		1		7		*		continuous	/ch/02/mix/fader f 0 1
+		switch		*		1		127		ramp		/ch/01/mix/fader f 0 0.75 over 2
+		cc			1		81		127		lfo			/ch/02/mix/pan	f 0.2 0.8 over 1/2 wave triangle
+		switch		*		2		127		toggle		/fx/1/mix/on	i quantize bar
+	  Sources: cc, cc14 (14 bit, number 0-31 = MSB, number + 32 = LSB, value
+	  0-16383, values '*'), note, poly, program, pressure, pitch (number '*',
+	  value = MSB), switch (number = foot switch pin, pressed = 127, released = 0)
+	  and tempo (Every tempo change, value = BPM, absolute only, number =
+	  the note ms is the length of: '1/4' ('*'), '1/8.' dotted, '1/8t'
+	  triplet, '1' / '2' bars (4/4)).
+	  Channels 1-16, '*' = any. Values 'lo-hi', one value or '*' (0-127).
+	  Note Off (And Note On velocity 0) is a note with value 0.
+	# All tempo rules go out in one OSC bundle, the mixer applies every FX
+	  time together from one datagram (One rule: a plain message).
+	# '= <expression>' at the end replaces out lo / hi: the argument is the
+	  expression (Expression.cpp) of v (value), s (state after the event),
+	  lo / hi (range), bpm, ms (beat or tempo note, whole mS) and
+	  state(<address>), the state of the first rule sending to <address>.
+	  Compiled with the map, an event runs the bytecode only.
+	# toggle: a value in range flips the state and sends out lo / hi (0 / 1).
+	  momentary: sends out hi (1) when the value comes into range, out lo (0)
+	  when it leaves. absolute: sends the value scaled from the range to out
+	  lo..hi (Default the value as it is). 'led' shows the state on a pin.
+	  continuous: absolute, paced for pedals / sweeps (Below).
+	# ramp: a value in range fades to out hi, the next one back to out lo,
+	  from wherever the parameter is, over 'over' (Default 1 bar). lfo: a
+	  value in range starts an LFO between out lo / hi, period 'over'
+	  (Default 1 beat), 'wave' sine (Default), triangle, square or saw, the
+	  next stops it back at out lo. Lengths are notes as for tempo rules,
+	  following the tempo, or 'NNNms'. Both run in the Modulator
+	  (Modulator.cpp): one MOD_TICK timer, one bundle a tick for them all.
+	# quantize: toggle / momentary / absolute rules can wait for the next
+	  'tick' (MIDI clock, 1/24 beat), 'beat', 'bar' or note ('1/8', '1/4t'
+	  ... dividing a bar) of the beat grid (BeatPhase: the MIDI clock phase,
+	  or the tap tempo grid) instead of firing at once: the argument goes in
+	  a bundle time tagged for that moment and the Scheduler (Scheduler.cpp)
+	  sends it then. Rules quantized to the same moment go in one bundle.
+	  Each event takes the grid time after the rule's last one, so a press
+	  and release quicker than the grid still come out in order, a grid time
+	  apart. The LED changes at once. No tempo yet: fires at once.
+	# continuous: the MIDI thread only stores the rule's latest argument.
+	  Every MAP_PACE mS the event loop moves each rule towards it (One pole,
+	  'smooth' time constant, none without) and sends the rules that changed,
+	  in one bundle. A pedal sweep of ~500 CCs / S becomes 50 datagrams / S
+	  at most, latest value wins, and stops once the value settles.
+	# cc14: an MSB sets the value with LSB 0 (MIDI spec), the LSB after it
+	  fills in the low 7 bits. Either sends / updates the target.
+	# Rules are compiled when loaded: Key[status row x number] gives a slot,
+	  Slot[slot][value] a run of rule indexes, so a message costs two array
+	  lookups plus the rules it fires, whatever the size of the map. Values
+	  next to each other with the same rules share a run.
+	# Wildcard rules are one rule (One state) on every key they cover.
+	# Without a map file the built in map (MIDI_MAP_DEFAULT, MOLink.h) is used.
+	# Hot reload: the file's directory is watched with inotify (Editors and
+	  'cp' replace the file, a watch on the file itself would be lost), a
+	  change starts a MAP_RELOAD_DELAY timer and the file is loaded when it
+	  settles. A bad file leaves the map in use as it is.
+	# The new map is built and compiled aside, then swapped in with one atomic
+	  pointer store (RCU style): a lookup counts itself in Readers before it
+	  loads the pointer, the old map is freed once Readers drops to 0, so a
+	  message is handled by the old map or the new one, never half of each.
+	  MIDI threads never wait for a reload, no bytes are dropped and nothing
+	  reconnects. Only the thread that loads maps (Main, event loop) waits.
+	# Toggle / momentary states are carried over to rules with the same
+	  source and address, a muted channel stays muted across a reload. They
+	  are carried over again once the old map is out of use, so a toggle
+	  the old map fired during the swap isn't lost. Tempo rules are fired
+	  with the tempo after a reload.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <stdio.h>												// printf(), fopen()
+#include <string.h>												// strcmp(), strcpy(), memcpy()
+#include <math.h>												// lroundf()
+#include <sched.h>												// sched_yield()
+#include <unistd.h>												// read(), close()
+#include <sys/inotify.h>										// File watch
+#include "MIDIMap.h"											// MIDI Map Class
+#include "Clock.h"												// Reload timer
+
+// ------------------------------------------------------------------------------------ //
+// Constructor
+MIDIMap::MIDIMap()
+{
+	Table = NULL;												//
+	Osc = NULL;													//
+	Io = NULL;													//
+	Fired = 0;													//
+	Paced = 0;													//
+	Bpm = 0;													//
+	Readers = 0;												//
+	Reloads = 0;												//
+	Loop = NULL;												//
+	Phase = NULL;												//
+	WatchFd = -1;												//
+	File[0] = 0;												//
+	WatchName = File;											//
+	memset(&Reload, 0, sizeof(Reload));							//
+	Reload.Fn = &MIDIMap::OnReload;								//
+	Reload.Arg = this;											//
+	memset(&Pace, 0, sizeof(Pace));								//
+	Pace.Fn = &MIDIMap::OnPace;									//
+	Pace.Arg = this;											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+MIDIMap::~MIDIMap()
+{
+	Unwatch();													//
+	if(Loop != NULL){											//
+		Loop->StopTimer(&Pace);									//
+	}
+	FreeTable(Table);											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Rules send to O, LEDs on I (NULL = no LEDs), continuous rules paced by L, quantized to P. Returns true if OK.
+bool MIDIMap::Open(RPiOSC *O, RPiIO *I, EventLoop *L, BeatPhase *P)
+{
+	if(O == NULL){												//
+		return false;											//
+	}
+	if((!Mod.Open(L, O))||(!Sched.Open(L, O))){					// Ramps / LFOs, quantized rules
+		return false;											//
+	}
+	Phase = P;													//
+	Osc = O;													//
+	Io = I;														//
+	Loop = L;													//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Load a map file (See Notes). The map in use stays if the file or a line is bad.
+// One thread loads maps (Main, then the event loop), lookups may run meanwhile.
+bool MIDIMap::Load(const char *FileName)
+{
+	FILE *FPtr;													//
+	char FLine[256];											//
+	int LineNo = 0;												//
+	MapTable *T;												//
+
+	if((FPtr = fopen(FileName, "r")) == NULL){					// Open file
+		printf("\r\nERROR!!! Can't Open MIDI Map File...\r\n");
+		return false;
+	}
+	T = NewTable();												//
+	while(fgets(FLine, sizeof(FLine), FPtr) != NULL){			//
+		LineNo++;												//
+		if(!AddRule(T, FLine)){									//
+			printf("\r\nERROR!!! MIDI Map File line %d: %s\r\n", LineNo, FLine);
+			fclose(FPtr);										//
+			FreeTable(T);										//
+			return false;										//
+		}
+	}
+	fclose(FPtr);												//
+	return Use(T);												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Load a map from Text, lines as in a map file. Returns false if a line is bad.
+bool MIDIMap::LoadText(const char *Text)
+{
+	char FLine[256];											//
+	int Len, LineNo = 0;										//
+	const char *End;											//
+	MapTable *T = NewTable();									//
+
+	while(*Text != 0){											//
+		LineNo++;												//
+		End = strchr(Text, '\n');								//
+		Len = (End != NULL) ? (int)(End - Text) : (int)strlen(Text);	//
+		if(Len > (int)sizeof(FLine) - 1){						//
+			Len = sizeof(FLine) - 1;							//
+		}
+		memcpy(FLine, Text, Len);								//
+		FLine[Len] = 0;											//
+		if(!AddRule(T, FLine)){									//
+			printf("\r\nERROR!!! MIDI Map line %d: %s\r\n", LineNo, FLine);
+			FreeTable(T);										//
+			return false;										//
+		}
+		Text = (End != NULL) ? End + 1 : Text + Len;			//
+	}
+	return Use(T);												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Reload FileName when it changes, from L. Returns true if OK.
+bool MIDIMap::Watch(EventLoop *L, const char *FileName)
+{
+	char Dir[MAP_PATH_MAX];										//
+	const char *Slash;											//
+
+	if((L == NULL)||(WatchFd >= 0)||((Loop != NULL)&&(Loop != L))||(strlen(FileName) >= MAP_PATH_MAX)){	// One loop
+		return false;											//
+	}
+	strcpy(File, FileName);										//
+	if((Slash = strrchr(File, '/')) != NULL){					// Directory / name
+		snprintf(Dir, sizeof(Dir), "%.*s", (Slash == File) ? 1 : (int)(Slash - File), File);
+		WatchName = Slash + 1;									//
+	}else{
+		strcpy(Dir, ".");										//
+		WatchName = File;										//
+	}
+	if((WatchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0){	//
+		printf("\r\nERROR!!! Can't create MIDI Map file watch...\r\n");
+		return false;											//
+	}
+	if((inotify_add_watch(WatchFd, Dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)||(!L->Add(WatchFd, EPOLLIN, &MIDIMap::OnNotify, this))){
+		printf("\r\nERROR!!! Can't watch MIDI Map directory %s\r\n", Dir);
+		close(WatchFd);											//
+		WatchFd = -1;											//
+		return false;											//
+	}
+	Loop = L;													//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Stop watching (Event loop still there)
+void MIDIMap::Unwatch(void)
+{
+	if(WatchFd >= 0){											//
+		Loop->StopTimer(&Reload);								//
+		Loop->Remove(WatchFd);									//
+		close(WatchFd);											//
+		WatchFd = -1;											//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Channel message in (Any port, one at a time). Returns the rules fired.
+int MIDIMap::Message(const MIDIMessage *Msg)
+{
+	int Row, Number = 0, Value;									//
+
+	if((Msg->Raw[0] < MIDI_NOTE_OFF)||(Msg->Raw[0] >= MIDI_SYSEX)){	// Channel messages only
+		return 0;												//
+	}
+	Row = Msg->Raw[0] - MIDI_NOTE_OFF;							// Status row
+	switch(Msg->Raw[0] & 0xF0){
+		case MIDI_NOTE_OFF:										// A note, value 0
+			Row += MIDI_NOTE_ON - MIDI_NOTE_OFF;				//
+			Number = Msg->Raw[1];								//
+			Value = 0;											//
+			break;
+		case MIDI_NOTE_ON:
+		case MIDI_POLY_PRESS:
+		case MIDI_CC:
+			Number = Msg->Raw[1];								//
+			Value = Msg->Raw[2];								//
+			break;
+		case MIDI_PITCH_BEND:									// MSB
+			Value = Msg->Raw[2];								//
+			break;
+		default:												// Program, channel pressure
+			Value = Msg->Raw[1];								//
+			break;
+	}
+	return Lookup(Row, Number, Value);							//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Foot switch pressed / released (Event loop). Returns the rules fired.
+int MIDIMap::Switch(int Pin, bool Pressed)
+{
+	if((Pin < 0)||(Pin >= MAP_VALUES)){							//
+		return 0;												//
+	}
+	return Lookup(MAP_ROW_SWITCH, Pin, Pressed ? 127 : 0);		//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Tempo changed to BPM (Event loop). Returns the tempo rules fired.
+int MIDIMap::Tempo(int BPM)
+{
+	OSCBundle Bundle;											//
+	MapTable *T;												//
+	int Count = 0;												//
+
+	__atomic_store_n(&Bpm, BPM, __ATOMIC_RELAXED);				// bpm / ms for every rule
+	Mod.Tempo(BPM);												// Ramps / LFOs in beats
+	__atomic_add_fetch(&Readers, 1, __ATOMIC_SEQ_CST);			// See Use()
+	T = __atomic_load_n(&Table, __ATOMIC_SEQ_CST);				//
+	if(T != NULL){												//
+		RPiOSC::BundleStart(&Bundle);							// Every FX follows in one datagram
+		for(Count = 0; Count < T->Tempos; Count++){				//
+			Fire(T, &T->Rule[T->Tempo[Count]], true, BPM, 0, &Bundle);	//
+		}
+		Osc->SendBundle(&Bundle);								//
+	}
+	__atomic_sub_fetch(&Readers, 1, __ATOMIC_RELEASE);			//
+	if(Count > 0){												//
+		__atomic_add_fetch(&Fired, Count, __ATOMIC_RELAXED);	//
+	}
+	return Count;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Print map size / use
+void MIDIMap::Report(FILE *Out)
+{
+	if(Table != NULL){											//
+		fprintf(Out, "MIDI map: %d rules, %d keys, %d run entries, %d transforms, %d continuous, %lu KB, %llu fired, %llu paced, %llu reloads\r\n",
+			Table->Rules, Table->Slots, Table->Runs, Table->Programs, Table->Glides,
+			(unsigned long)((sizeof(MapTable) + (Table->Slots * sizeof(*Table->Slot)) + (Table->Runs * sizeof(uint16_t))) / 1024),
+			(unsigned long long)__atomic_load_n(&Fired, __ATOMIC_RELAXED), (unsigned long long)Paced, (unsigned long long)Reloads);
+	}
+	Mod.Report(Out);											//
+	Sched.Report(Out);											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Empty map
+MapTable *MIDIMap::NewTable(void)
+{
+	MapTable *T = new MapTable;									//
+
+	memset(T->Key, 0, sizeof(T->Key));							//
+	T->Slot = NULL;												//
+	T->Run = NULL;												//
+	T->Program = NULL;											//
+	T->Programs = 0;											//
+	T->Tempos = 0;												//
+	T->Glides = 0;												//
+	T->Runs = 0;												//
+	T->Slots = 0;												//
+	T->Rules = 0;												//
+	return T;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+void MIDIMap::FreeTable(MapTable *T)
+{
+	if(T != NULL){												//
+		delete[] T->Slot;										//
+		delete[] T->Run;										//
+		delete[] T->Program;									//
+		delete T;												//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Parse one map file line into T (Blank and '#' lines are fine). Returns false if bad.
+bool MIDIMap::AddRule(MapTable *T, const char *Line)
+{
+	char Src[16], Chan[8], Num[8], Range[16], Mode[16], Addr[MAP_ADDRESS_MAX], Arg[8], X[8][16];
+	char Head[256];												// Line up to '='
+	const char *Eq;												//
+	MapRule *R;													//
+	int Items, Extra, I, Lo, Hi;								//
+	float Beats;												// quantize note
+	size_t Len;													//
+	float Smooth = 0;											// mS
+
+	snprintf(Head, sizeof(Head), "%s", Line);					//
+	if((Eq = strchr(Line, '=')) != NULL){						// Transform?
+		Head[Eq - Line] = 0;									//
+	}
+	Items = sscanf(Head, "%15s %7s %7s %15s %15s %63s %7s %15s %15s %15s %15s %15s %15s %15s %15s",
+		Src, Chan, Num, Range, Mode, Addr, Arg, X[0], X[1], X[2], X[3], X[4], X[5], X[6], X[7]);
+	if((Items < 1)||(Src[0] == '#')){							// Blank or comment?
+		return true;											//
+	}
+	if((Items < 7)||(T->Rules >= MAP_RULES_MAX)){				//
+		return false;											//
+	}
+	R = &T->Rule[T->Rules];										//
+	Extra = Items - 7;											// [out lo hi] [led pin] [smooth mS] [over len] [wave w] [quantize q]
+	R->Wide = false;											//
+
+	// Source
+	if(strcmp(Src, "cc") == 0){ R->Type = MIDI_CC; }
+	else if(strcmp(Src, "cc14") == 0){ R->Type = MIDI_CC; R->Wide = true; }
+	else if(strcmp(Src, "note") == 0){ R->Type = MIDI_NOTE_ON; }
+	else if(strcmp(Src, "poly") == 0){ R->Type = MIDI_POLY_PRESS; }
+	else if(strcmp(Src, "program") == 0){ R->Type = MIDI_PROGRAM; }
+	else if(strcmp(Src, "pressure") == 0){ R->Type = MIDI_CHAN_PRESS; }
+	else if(strcmp(Src, "pitch") == 0){ R->Type = MIDI_PITCH_BEND; }
+	else if(strcmp(Src, "switch") == 0){ R->Type = MAP_SOURCE_SWITCH; }
+	else if(strcmp(Src, "tempo") == 0){ R->Type = MAP_SOURCE_TEMPO; }
+	else{ return false; }
+
+	// Channel 1-16, number
+	R->Channel = -1;											// Any
+	if((strcmp(Chan, "*") != 0)&&(R->Type > MAP_SOURCE_TEMPO)){	// MIDI
+		if((sscanf(Chan, "%d", &I) != 1)||(I < 1)||(I > 16)){	//
+			return false;										//
+		}
+		R->Channel = I - 1;										//
+	}
+	R->Number = -1;												// Any
+	R->Beats = 1;												// ms = a beat
+	if(R->Type == MAP_SOURCE_TEMPO){							// Number = note length
+		R->Number = 0;											//
+		if((strcmp(Num, "*") != 0)&&!Note(Num, &R->Beats)){		//
+			return false;										//
+		}
+	}else if((R->Type == MIDI_PROGRAM)||(R->Type == MIDI_CHAN_PRESS)||(R->Type == MIDI_PITCH_BEND)){	// No number
+		R->Number = 0;											//
+	}else if(strcmp(Num, "*") != 0){							//
+		if((sscanf(Num, "%d", &I) != 1)||(I < 0)||(I >= MAP_VALUES)){	//
+			return false;										//
+		}
+		R->Number = I;											//
+	}
+	if(R->Wide && ((R->Number < 0)||(R->Number >= 32)||(strcmp(Range, "*") != 0))){	// MSB 0-31, LSB + 32, all values
+		return false;											//
+	}
+
+	// Values
+	if(strcmp(Range, "*") == 0){								//
+		Lo = 0;													//
+		Hi = MAP_VALUES - 1;									//
+	}else if((Items = sscanf(Range, "%d-%d", &Lo, &Hi)) == 1){	// One value
+		Hi = Lo;												//
+	}else if(Items != 2){										//
+		return false;											//
+	}
+	if((Lo < 0)||(Lo > Hi)||(Hi >= MAP_VALUES)){				//
+		return false;											//
+	}
+	R->Lo = Lo;													//
+	R->Hi = Hi;													//
+
+	// Mode, argument
+	if(strcmp(Mode, "toggle") == 0){ R->Mode = MAP_TOGGLE; }
+	else if(strcmp(Mode, "momentary") == 0){ R->Mode = MAP_MOMENTARY; }
+	else if(strcmp(Mode, "ramp") == 0){ R->Mode = MAP_RAMP; }
+	else if(strcmp(Mode, "lfo") == 0){ R->Mode = MAP_LFO; }
+	else if(strcmp(Mode, "absolute") == 0){ R->Mode = MAP_ABSOLUTE; }
+	else if(strcmp(Mode, "continuous") == 0){ R->Mode = MAP_CONTINUOUS; }
+	else{ return false; }
+	if(((R->Type == MAP_SOURCE_TEMPO)&&(R->Mode != MAP_ABSOLUTE))||	// Tempo has no on / off, is paced already
+		(R->Wide && (R->Mode < MAP_ABSOLUTE))||					// nor a 14 bit value
+		(((R->Mode == MAP_RAMP)||(R->Mode == MAP_LFO))&&(Eq != NULL))){	// Ramps / LFOs go between out lo / hi
+		return false;											//
+	}
+	if((Addr[0] != '/')||((strcmp(Arg, "i") != 0)&&(strcmp(Arg, "f") != 0))){	//
+		return false;											//
+	}
+	strcpy(R->Address, Addr);									//
+	R->Float = (Arg[0] == 'f');									//
+	R->OutLo = (R->Mode >= MAP_ABSOLUTE) ? Lo : 0;				// Defaults
+	R->OutHi = (R->Mode >= MAP_ABSOLUTE) ? (R->Wide ? MAP_WIDE_MAX : Hi) : 1;	//
+	R->Led = -1;												//
+	R->State = 0;												//
+	R->Kept = 0;												//
+	R->Beats = (R->Mode == MAP_RAMP) ? 4 : R->Beats;			// Ramp a bar, LFO a beat
+	R->OverMs = 0;												//
+	R->Wave = MOD_SINE;											//
+	R->Grid = 0;												// At once
+	R->Due = 0;													//
+	R->Expr = -1;												// Compiled with the map
+	R->Text[0] = 0;												//
+	if(Eq != NULL){												// '= expression', to the end of the line
+		if(strlen(Eq + 1) >= EXPR_TEXT_MAX){					//
+			return false;										//
+		}
+		strcpy(R->Text, Eq + 1);								//
+		R->Text[strcspn(R->Text, "\r\n")] = 0;					//
+	}
+
+	// [out lo hi] [led pin]
+	I = 0;														//
+	if((Extra >= I + 2)&&(sscanf(X[I], "%f", &R->OutLo) == 1)){	// A number, not an option name
+		if(sscanf(X[I + 1], "%f", &R->OutHi) != 1){				//
+			return false;										//
+		}
+		I += 2;													//
+	}
+	if((Extra >= I + 2)&&(strcmp(X[I], "led") == 0)){			//
+		if((sscanf(X[I + 1], "%d", &R->Led) != 1)||(R->Led < 0)){	//
+			return false;										//
+		}
+		I += 2;													//
+	}
+	if((Extra >= I + 2)&&(strcmp(X[I], "smooth") == 0)){		//
+		if((R->Mode != MAP_CONTINUOUS)||(sscanf(X[I + 1], "%f", &Smooth) != 1)||(Smooth < 0)){	// Continuous only
+			return false;										//
+		}
+		I += 2;													//
+	}
+	if((Extra >= I + 2)&&(strcmp(X[I], "over") == 0)){			// Note (Follows the tempo) or 'NNNms'
+		Len = strlen(X[I + 1]);									//
+		if((R->Mode != MAP_RAMP)&&(R->Mode != MAP_LFO)){		// Ramp / LFO only
+			return false;										//
+		}else if((Len > 2)&&(strcmp(&X[I + 1][Len - 2], "ms") == 0)){	//
+			if((sscanf(X[I + 1], "%f", &R->OverMs) != 1)||(R->OverMs <= 0)){	//
+				return false;									//
+			}
+		}else if(!Note(X[I + 1], &R->Beats)){					//
+			return false;										//
+		}
+		I += 2;													//
+	}
+	if((Extra >= I + 2)&&(strcmp(X[I], "wave") == 0)){			//
+		if(R->Mode != MAP_LFO){ return false; }
+		else if(strcmp(X[I + 1], "sine") == 0){ R->Wave = MOD_SINE; }
+		else if(strcmp(X[I + 1], "triangle") == 0){ R->Wave = MOD_TRIANGLE; }
+		else if(strcmp(X[I + 1], "square") == 0){ R->Wave = MOD_SQUARE; }
+		else if(strcmp(X[I + 1], "saw") == 0){ R->Wave = MOD_SAW; }
+		else{ return false; }
+		I += 2;													//
+	}
+	if((Extra >= I + 2)&&(strcmp(X[I], "quantize") == 0)){		// Tick, beat, bar or a note dividing the bar
+		if((R->Type == MAP_SOURCE_TEMPO)||((R->Mode > MAP_MOMENTARY)&&(R->Mode != MAP_ABSOLUTE))){	// Actions only, not motion
+			return false;										//
+		}else if(strcmp(X[I + 1], "tick") == 0){ R->Grid = 1; }
+		else if(strcmp(X[I + 1], "beat") == 0){ R->Grid = MIDI_PPQN; }
+		else if(strcmp(X[I + 1], "bar") == 0){ R->Grid = BEAT_BAR * MIDI_PPQN; }
+		else if(Note(X[I + 1], &Beats)){						//
+			R->Grid = lroundf(Beats * MIDI_PPQN);				//
+			if((fabsf((Beats * MIDI_PPQN) - R->Grid) > 0.01f)||(R->Grid == 0)||(((BEAT_BAR * MIDI_PPQN) % R->Grid) != 0)){
+				return false;									// Not whole ticks / not dividing the bar
+			}
+		}else{ return false; }
+		I += 2;													//
+	}
+	if(Extra > I){												// Left over?
+		return false;											//
+	}
+	R->Coef = (Smooth > 0) ? 1 - expf(-MAP_PACE / Smooth) : 1;	// One pole, time constant Smooth
+	R->Target = NAN;											//
+	R->Level = NAN;												//
+	R->Sent = NAN;												//
+	T->Rules++;													//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Note length in beats (4/4): 'n/d' whole note fractions, '.' dotted, 't' triplet, 'n' bars
+bool MIDIMap::Note(const char *Text, float *Beats)
+{
+	int N, D = 1, Len = 0;										//
+	char Dot = 0;												//
+
+	if((sscanf(Text, "%d%n/%d%n", &N, &Len, &D, &Len) < 1)||(N <= 0)||(D <= 0)){	//
+		return false;											//
+	}
+	if((Text[Len] == '.')||(Text[Len] == 't')){					//
+		Dot = Text[Len++];										//
+	}
+	if(Text[Len] != 0){											// Left over?
+		return false;											//
+	}
+	*Beats = (4.0f * N) / D;									// Whole note = 4 beats
+	*Beats *= (Dot == '.') ? 1.5f : (Dot == 't') ? (2.0f / 3) : 1;	//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Does R apply to status Row (0-111, MAP_ROW_SWITCH) / Number?
+bool MIDIMap::Covers(const MapRule *R, int Row, int Number)
+{
+	if(R->Type == MAP_SOURCE_TEMPO){							// Not on a key
+		return false;											//
+	}else if(R->Type == MAP_SOURCE_SWITCH){						// Foot switch
+		if(Row != MAP_ROW_SWITCH){								//
+			return false;										//
+		}
+	}else if((Row >= MAP_ROW_SWITCH)||((Row & 0x70) != (R->Type - MIDI_NOTE_OFF))||
+		((R->Channel >= 0)&&((Row & 0x0F) != R->Channel))){		// Type, channel
+		return false;											//
+	}
+	return (R->Number < 0)||(R->Number == Number)||(R->Wide && (R->Number + 32 == Number));	// (cc14: MSB, LSB)
+}
+
+// ------------------------------------------------------------------------------------ //
+// Rules -> Key, Slot and Run tables, transforms. Returns false if the map is too big or a transform bad.
+bool MIDIMap::Compile(MapTable *T)
+{
+	int *SlotKey = new int[MAP_SLOTS_MAX];						// Slot -> key
+	uint16_t *Used = new uint16_t[T->Rules];					// Rules on the slot
+	uint16_t Cur[255], Prev[255];								// Run for this value / the one before
+	int Key, First, Last, Count, CurN, PrevN, Size = 0;			//
+	bool Ok = true;												//
+
+	// Slots, one per key any rule covers
+	for(int R = 0; (R < T->Rules)&&Ok; R++){					//
+		First = (T->Rule[R].Number < 0) ? 0 : T->Rule[R].Number;	//
+		Last = (T->Rule[R].Number < 0) ? MAP_VALUES - 1 : T->Rule[R].Number + (T->Rule[R].Wide ? 32 : 0);	//
+		for(int Row = 0; (Row < MAP_ROWS)&&Ok; Row++){			//
+			for(int N = First; N <= Last; N++){					//
+				Key = (Row * MAP_VALUES) + N;					//
+				if((T->Key[Key] != 0)||!Covers(&T->Rule[R], Row, N)){	// Done / not this rule's
+					continue;									//
+				}
+				if(T->Slots >= MAP_SLOTS_MAX){					//
+					printf("\r\nERROR!!! MIDI Map: more than %d keys\r\n", MAP_SLOTS_MAX);
+					Ok = false;									//
+					break;										//
+				}
+				SlotKey[T->Slots] = Key;						//
+				T->Key[Key] = ++T->Slots;						//
+			}
+		}
+	}
+
+	// Runs, the rules each value of each slot fires
+	if(Ok && (T->Slots > 0)){									//
+		T->Slot = new uint32_t[T->Slots][MAP_VALUES];			//
+		Size = 1024;											//
+		T->Run = new uint16_t[Size];							//
+	}
+	for(int S = 0; (S < T->Slots)&&Ok; S++){					//
+		Count = 0;												//
+		for(int R = 0; R < T->Rules; R++){						// File order
+			if(Covers(&T->Rule[R], SlotKey[S] / MAP_VALUES, SlotKey[S] % MAP_VALUES)){	//
+				Used[Count++] = R;								//
+			}
+		}
+		if(Count > 255){										// Run count is a byte
+			printf("\r\nERROR!!! MIDI Map: more than 255 rules on one key\r\n");
+			Ok = false;											//
+			break;												//
+		}
+		PrevN = -1;												//
+		for(int V = 0; V < MAP_VALUES; V++){					//
+			CurN = 0;											//
+			for(int U = 0; U < Count; U++){						//
+				const MapRule *R = &T->Rule[Used[U]];			//
+				bool In = (V >= R->Lo)&&(V <= R->Hi);			//
+				if(In || (R->Mode == MAP_MOMENTARY)){			// Momentary hears the way out too
+					Cur[CurN++] = Used[U] | (In ? MAP_IN_RANGE : 0);	//
+				}
+			}
+			if(CurN == 0){										//
+				T->Slot[S][V] = 0;								//
+			}else if((CurN == PrevN)&&(memcmp(Cur, Prev, CurN * sizeof(uint16_t)) == 0)){	// Same as the value before
+				T->Slot[S][V] = T->Slot[S][V - 1];				//
+			}else{												// New run
+				if(T->Runs + CurN > Size){						// Grow
+					uint16_t *Run = new uint16_t[Size * 2];		//
+					memcpy(Run, T->Run, T->Runs * sizeof(uint16_t));	//
+					delete[] T->Run;							//
+					T->Run = Run;								//
+					Size *= 2;									//
+				}
+				if(T->Runs >= (1 << 24)){						// Start is 24 bits
+					printf("\r\nERROR!!! MIDI Map: too big\r\n");
+					Ok = false;									//
+					break;										//
+				}
+				memcpy(&T->Run[T->Runs], Cur, CurN * sizeof(uint16_t));	//
+				T->Slot[S][V] = ((uint32_t)T->Runs << 8) | CurN;	//
+				T->Runs += CurN;								//
+			}
+			memcpy(Prev, Cur, CurN * sizeof(uint16_t));			//
+			PrevN = CurN;										//
+		}
+	}
+
+	// Transforms, tempo and continuous rules
+	for(int R = 0; (R < T->Rules)&&Ok; R++){					//
+		T->Programs += (T->Rule[R].Text[0] != 0);				//
+		if(T->Rule[R].Type == MAP_SOURCE_TEMPO){				//
+			if(T->Tempos >= MAP_TEMPO_MAX){						//
+				printf("\r\nERROR!!! MIDI Map: more than %d tempo rules\r\n", MAP_TEMPO_MAX);
+				Ok = false;										//
+				break;											//
+			}
+			T->Tempo[T->Tempos++] = R;							//
+		}
+		if(T->Rule[R].Mode == MAP_CONTINUOUS){					//
+			if(T->Glides >= MAP_CONTINUOUS_MAX){				//
+				printf("\r\nERROR!!! MIDI Map: more than %d continuous rules\r\n", MAP_CONTINUOUS_MAX);
+				Ok = false;										//
+				break;											//
+			}
+			T->Glide[T->Glides++] = R;							//
+		}
+	}
+	if(Ok && (T->Programs > 0)){								//
+		T->Program = new ExprProgram[T->Programs];				//
+		T->Programs = 0;										//
+		for(int R = 0; (R < T->Rules)&&Ok; R++){				//
+			if(T->Rule[R].Text[0] != 0){						//
+				Ok = Expression::Compile(T->Rule[R].Text, &T->Program[T->Programs], &MIDIMap::FindState, T);	// Prints why not
+				T->Rule[R].Expr = T->Programs++;				//
+			}
+		}
+	}
+	delete[] SlotKey;											//
+	delete[] Used;												//
+	return Ok;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Compile T and use it instead of the map in use. Returns false (T freed) if it won't compile.
+bool MIDIMap::Use(MapTable *T)
+{
+	MapTable *Old = Table;										//
+
+	if(!Compile(T)){											//
+		FreeTable(T);											//
+		return false;											//
+	}
+	if(Old != NULL){											// Reload?
+		Keep(T, Old);											//
+		Reloads++;												//
+	}
+	__atomic_store_n(&Table, T, __ATOMIC_SEQ_CST);				// Lookups from now on get T
+	while(__atomic_load_n(&Readers, __ATOMIC_SEQ_CST) != 0){	// Grace period, lookups that may hold Old
+		sched_yield();											// (Microseconds, one message)
+	}
+	if(Old != NULL){											// Toggles / LFOs Old fired since the first Keep()
+		Keep(T, Old, true);										// (No lookup holds Old now)
+	}
+	for(int O = 0; (Old != NULL)&&(O < Old->Rules); O++){		// LFOs no rule runs now stop
+		const MapRule *P = &Old->Rule[O];						//
+		bool Run = false;										//
+		if((P->Mode != MAP_LFO)||(P->State == 0)){				//
+			continue;											//
+		}
+		for(int R = 0; (R < T->Rules)&&!Run; R++){				//
+			Run = (T->Rule[R].Mode == MAP_LFO)&&(T->Rule[R].State != 0)&&(strcmp(T->Rule[R].Address, P->Address) == 0);
+		}
+		if(!Run){												//
+			Mod.Stop(P->Address);								//
+		}
+	}
+	FreeTable(Old);												//
+	if((Old != NULL)&&(__atomic_load_n(&Bpm, __ATOMIC_RELAXED) > 0)){	// New / edited tempo rules get the tempo now
+		Tempo(__atomic_load_n(&Bpm, __ATOMIC_RELAXED));			//
+	}
+	if((Loop != NULL)&&(T->Glides > 0)&&!Pace.Active){			// Pace continuous rules (Same thread as OnPace)
+		Loop->StartTimer(&Pace, CLK->Now() + (MAP_PACE * NS_PER_MS), MAP_PACE * NS_PER_MS);
+	}else if((Loop != NULL)&&(T->Glides == 0)){					// None, no wake ups
+		Loop->StopTimer(&Pace);									//
+	}
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Carry states from Old's rules to T's with the same source and address. Again (After the
+// swap and the grace period): states Old's rules changed to since, unless T's moved on too.
+void MIDIMap::Keep(MapTable *T, const MapTable *Old, bool Again)
+{
+	int Was;													//
+
+	for(int R = 0; R < T->Rules; R++){							//
+		MapRule *N = &T->Rule[R];								//
+		for(int O = 0; O < Old->Rules; O++){					//
+			const MapRule *P = &Old->Rule[O];					//
+			if((P->Type == N->Type)&&(P->Wide == N->Wide)&&(P->Channel == N->Channel)&&(P->Number == N->Number)&&
+				(P->Mode == N->Mode)&&(strcmp(P->Address, N->Address) == 0)){
+				if(Again){										// T is in use, the MIDI thread may fire it
+					Was = N->Kept;								//
+					__atomic_compare_exchange_n(&N->State, &Was, __atomic_load_n(&P->State, __ATOMIC_RELAXED), false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+					break;										//
+				}
+				N->State = __atomic_load_n(&P->State, __ATOMIC_RELAXED);	// Old may still be firing
+				N->Kept = N->State;								//
+				N->Level = P->Level;							// Continuous (Event loop, as this)
+				N->Sent = P->Sent;								//
+				break;											//
+			}
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Fire the rules mapped to Row / Number for Value. Returns the rules fired.
+int MIDIMap::Lookup(int Row, int Number, int Value)
+{
+	MapTable *T;												//
+	uint32_t Run = 0;											//
+	uint16_t Key;												//
+	int Count = 0;												//
+
+	__atomic_add_fetch(&Readers, 1, __ATOMIC_SEQ_CST);			// Before the pointer, see Use()
+	T = __atomic_load_n(&Table, __ATOMIC_SEQ_CST);				//
+	if((T != NULL)&&((Key = T->Key[(Row * MAP_VALUES) + Number]) != 0)){	// Something on this key?
+		Run = T->Slot[Key - 1][Value];							// Rules for this value (0 = none)
+	}
+	Count = Run & 0xFF;											//
+	for(int I = 0; I < Count; I++){								//
+		uint16_t E = T->Run[(Run >> 8) + I];					//
+		Fire(T, &T->Rule[E & ~MAP_IN_RANGE], (E & MAP_IN_RANGE) != 0, Value, Number);	//
+	}
+	__atomic_sub_fetch(&Readers, 1, __ATOMIC_RELEASE);			// Done with T
+	if(Count > 0){												//
+		__atomic_add_fetch(&Fired, Count, __ATOMIC_RELAXED);	// MIDI thread and event loop
+	}
+	return Count;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Send R's argument for Value (LED first), or add it to B. T = R's map, Number = data byte 1.
+void MIDIMap::Fire(MapTable *T, MapRule *R, bool InRange, int Value, int Number, OSCBundle *B)
+{
+	int State = __atomic_load_n(&R->State, __ATOMIC_RELAXED);	// Read by Keep() on a reload
+	int Lo = R->Lo, Hi = R->Hi;									// Value range
+	float Reg[EXPR_REGS];										// Transform registers
+	float Out;													//
+
+	if(R->Wide){												// cc14: MSB (LSB back to 0) or LSB
+		Value = (Number == R->Number) ? (Value << 7) : ((State & (MAP_WIDE_MAX & ~0x7F)) | Value);
+		Lo = 0;													//
+		Hi = MAP_WIDE_MAX;										//
+	}
+	switch(R->Mode){
+		case MAP_TOGGLE:										// In range only
+		case MAP_RAMP:											// (Up / down in turn)
+		case MAP_LFO:											// (On / off)
+			State ^= 1;											// Toggle State
+			Out = State ? R->OutHi : R->OutLo;					//
+			break;
+		case MAP_MOMENTARY:										//
+			if((int)InRange == State){							// No change?
+				return;											//
+			}
+			State = InRange;									//
+			Out = State ? R->OutHi : R->OutLo;					//
+			break;
+		default:												// Absolute / continuous, in range only
+			Out = (Hi == Lo) ? R->OutHi : R->OutLo + ((Value - Lo) * (R->OutHi - R->OutLo) / (Hi - Lo));
+			State = Value;										//
+			break;
+	}
+	__atomic_store_n(&R->State, State, __ATOMIC_RELAXED);		//
+	if(R->Expr >= 0){											// Transform
+		Reg[EXPR_V] = Value;									//
+		Reg[EXPR_S] = State;									//
+		Reg[EXPR_LO] = Lo;										//
+		Reg[EXPR_HI] = Hi;										//
+		Reg[EXPR_BPM] = __atomic_load_n(&Bpm, __ATOMIC_RELAXED);	//
+		Reg[EXPR_MS] = (Reg[EXPR_BPM] > 0) ? (int)((60 * 1000) * R->Beats / Reg[EXPR_BPM]) : 0;	// Whole mS of the note
+		Out = Expression::Run(&T->Program[R->Expr], Reg, &MIDIMap::StateOf, T);	//
+	}
+	if((R->Led >= 0)&&(Io != NULL)){							// Output to LED
+		Io->OutputPin(R->Led, (R->Mode >= MAP_ABSOLUTE) ? (Value > Lo) : State);	//
+	}
+	if(R->Mode == MAP_RAMP){									// The modulator sends (Event loop)
+		Mod.Ramp(R->Address, R->Float, State ? R->OutLo : R->OutHi, Out, R->Beats, R->OverMs);	// From where it is if moving
+		return;													//
+	}
+	if(R->Mode == MAP_LFO){										//
+		if(State){												//
+			Mod.Lfo(R->Address, R->Float, R->OutLo, R->OutHi, R->Wave, R->Beats, R->OverMs);	//
+		}else{													// Off: back to out lo next tick
+			Mod.Ramp(R->Address, R->Float, R->OutLo, R->OutLo, 0);	//
+		}
+		return;													//
+	}
+	if((R->Grid > 0)&&Quantize(R, Out)){						// Waits for the grid, the Scheduler sends
+		return;													//
+	}
+	if((R->Mode == MAP_CONTINUOUS)&&(Loop != NULL)){			// Paced: latest value wins, OnPace() sends
+		__atomic_store(&R->Target, &Out, __ATOMIC_RELAXED);		//
+		return;													//
+	}
+	Send(R, Out, B);											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Send Out to R's address, or add it to B (B sent and restarted when full)
+void MIDIMap::Send(MapRule *R, float Out, OSCBundle *B)
+{
+	if(B != NULL){												// Bundled
+		while(!(R->Float ? RPiOSC::BundleAddFloat(B, R->Address, Out) : RPiOSC::BundleAddInt(B, R->Address, (int)lroundf(Out)))){
+			if(B->Count == 0){									// Doesn't fit at all
+				return;											//
+			}
+			Osc->SendBundle(B);									// Full, send and start another
+			RPiOSC::BundleStart(B);								//
+		}
+	}else if(R->Float){											// Send to OSC device (XR18)
+		Osc->SendFloat(R->Address, Out);						//
+	}else{
+		Osc->SendInt(R->Address, (int)lroundf(Out));			//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Hold R's Out for its next grid time, in a bundle tagged for then. False if there's no grid.
+bool MIDIMap::Quantize(MapRule *R, float Out)
+{
+	OSCBundle Bundle;											//
+	uint64_t Due;												//
+
+	Due = CLK->Now();											// After the rule's last one, a quick press
+	Due = (R->Due > Due) ? R->Due : Due;						// and release go on two grid times, in order
+	if((Phase == NULL)||((Due = Phase->NextGrid(Due, R->Grid)) == 0)){	// No tempo yet
+		return false;											//
+	}
+	R->Due = Due;												//
+	RPiOSC::BundleStart(&Bundle, Sched.TimeTag(Due));			//
+	Send(R, Out, &Bundle);										// Into the bundle (One message fits)
+	Sched.Send(&Bundle);										// (Sent at once if it can't wait)
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// state(<address>) in a transform: the first rule sending to it (Arg = map). Index, -1 = none.
+int MIDIMap::FindState(const char *Name, int Len, void *Arg)
+{
+	MapTable *T = (MapTable *)Arg;								//
+
+	for(int R = 0; R < T->Rules; R++){							//
+		if((strncmp(T->Rule[R].Address, Name, Len) == 0)&&(T->Rule[R].Address[Len] == 0)){
+			return R;											//
+		}
+	}
+	return -1;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Rule Index's state (Arg = map)
+float MIDIMap::StateOf(int Index, void *Arg)
+{
+	return __atomic_load_n(&((MapTable *)Arg)->Rule[Index].State, __ATOMIC_RELAXED);	//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Watched directory changed (Event loop). Our file? Reload once it settles.
+void MIDIMap::OnNotify(int Fd, uint32_t Events, void *Arg)
+{
+	MIDIMap *C = (MIDIMap *)Arg;								//
+	char Buff[4096] __attribute__((aligned(__alignof__(struct inotify_event))));	//
+	const struct inotify_event *Ev;								//
+	int Len;													//
+
+	while((Len = read(Fd, Buff, sizeof(Buff))) > 0){			// Drain
+		for(char *P = Buff; P < Buff + Len; P += sizeof(struct inotify_event) + Ev->len){
+			Ev = (const struct inotify_event *)P;				//
+			if((Ev->len > 0)&&(strcmp(Ev->name, C->WatchName) == 0)){	// Written / moved in
+				C->Loop->StartTimer(&C->Reload, CLK->Now() + (MAP_RELOAD_DELAY * NS_PER_MS));	// (Re)start
+			}
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Map file settled (Event loop). Load it, the map in use stays if it's bad.
+void MIDIMap::OnReload(void *Arg)
+{
+	MIDIMap *C = (MIDIMap *)Arg;								//
+
+	if(C->Load(C->File)){										//
+		printf("MIDI map reloaded: %d rules\r\n", C->Table->Rules);	//
+	}else{
+		printf("MIDI map not reloaded, keeping the one in use\r\n");	//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Every MAP_PACE mS (Event loop): move each continuous rule towards its latest value and send
+// the ones that changed, together in one bundle. A sweep of CCs costs one datagram a pace.
+void MIDIMap::OnPace(void *Arg)
+{
+	MIDIMap *C = (MIDIMap *)Arg;								//
+	MapTable *T = C->Table;										// Swapped on this thread only
+	OSCBundle Bundle;											//
+	float Target, Out;											//
+	int Count = 0;												//
+
+	if(T == NULL){												//
+		return;													//
+	}
+	RPiOSC::BundleStart(&Bundle);								//
+	for(int G = 0; G < T->Glides; G++){							//
+		MapRule *R = &T->Rule[T->Glide[G]];						//
+		__atomic_load(&R->Target, &Target, __ATOMIC_RELAXED);	// MIDI thread's latest
+		if(isnan(Target)){										// Nothing yet
+			continue;											//
+		}
+		R->Level = isnan(R->Level) ? Target : R->Level + (R->Coef * (Target - R->Level));	// First value: no glide
+		if(fabsf(Target - R->Level) <= 1e-4f * (fabsf(Target) + 1)){	// Close enough, settle
+			R->Level = Target;									//
+		}
+		Out = R->Float ? R->Level : lroundf(R->Level);			//
+		if(Out != R->Sent){										// Changed since the last pace?
+			R->Sent = Out;										//
+			C->Send(R, Out, &Bundle);							//
+			Count++;											//
+		}
+	}
+	C->Osc->SendBundle(&Bundle);								//
+	C->Paced += Count;											// (Report() reads it on this thread too)
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
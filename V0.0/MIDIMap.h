@@ -0,0 +1,175 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			MIDI Map Header for RPi - Linux
+Filename:		MIDIMap.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	MIDI to OSC mapping. Rules (MIDI channel / type / number / value range
+				-> OSC address, argument, toggle / momentary / absolute) come from a
+				text file and are compiled into flat tables, so a message finds its
+				rules in two array lookups however many rules there are. The file
+				is watched (inotify) and a new map swapped in while MIDI keeps
+				flowing.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _MIDIMAP_H
+#define _MIDIMAP_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdio.h>												// FILE
+#include <stdint.h>												// Fixed width types
+#include "config.h"												// General Configuration File
+#include "MIDI.h"												// MIDI Message
+#include "OSC.h"												// OSC Class
+#include "IO.h"													// LEDs
+#include "EventLoop.h"											// File watch, reload timer
+#include "Expression.h"											// Argument transforms
+#include "Modulator.h"											// Ramps / LFOs
+#include "Scheduler.h"											// Quantized rules
+#include "Tempo.h"												// Beat / bar grid
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define MAP_RULES_MAX		1024								// Rules in a map
+#define MAP_SLOTS_MAX		4096								// Status / number pairs mapped (512 bytes each)
+#define MAP_ADDRESS_MAX		64									// OSC address length
+#define MAP_VALUES			128									// Data byte values
+#define MAP_ROW_SWITCH		112									// Foot switches after the 7 x 16 channel statuses
+#define MAP_ROWS			113									//
+#define MAP_KEYS			(MAP_ROWS * MAP_VALUES)				// Row x number
+#define MAP_IN_RANGE		0x8000								// Run entry: value in the rule's range
+#define MAP_PATH_MAX		256									// Map file path
+#define MAP_RELOAD_DELAY	250									// Reload mS after the last change (Editors write in steps)
+#define MAP_TEMPO_MAX		16									// Tempo rules
+#define MAP_CONTINUOUS_MAX	64									// Continuous rules
+#define MAP_PACE			20									// Continuous rules send every MAP_PACE mS (50 / S) at most
+#define MAP_WIDE_MAX		16383								// 14 bit value (cc14)
+
+// -------------------------------------------------------------------------------------
+// Sources that aren't MIDI status bytes (Rule Type)
+#define MAP_SOURCE_SWITCH	0x00								// Foot switch
+#define MAP_SOURCE_TEMPO	0x01								// Tempo change
+
+// -------------------------------------------------------------------------------------
+// Modes
+enum MapMode
+{
+	MAP_TOGGLE = 1,												// In range flips between Out Lo / Hi
+	MAP_MOMENTARY,												// In range = Out Hi, out of range = Out Lo
+	MAP_RAMP,													// In range ramps to Out Hi / Lo, in turn
+	MAP_LFO,													// In range starts / stops an LFO over Out Lo..Hi
+	MAP_ABSOLUTE,												// Value scaled from In Lo..Hi to Out Lo..Hi
+	MAP_CONTINUOUS												// Absolute, smoothed and sent at the MAP_PACE rate
+};
+
+// -------------------------------------------------------------------------------------
+// Rule
+typedef struct _mapRule{
+	uint8_t Type;												// Status high nibble (MIDI_CC...) or MAP_SOURCE_...
+	int8_t Channel;												// 0-15, -1 = any
+	int16_t Number;												// Data byte 1 / pin, -1 = any (Or none)
+	bool Wide;													// cc14: Number = MSB, Number + 32 = LSB
+	uint8_t Lo, Hi;												// Value range
+	uint8_t Mode;												// MapMode
+	bool Float;													// ,f else ,i
+	float OutLo, OutHi;											// Argument range
+	int Led;													// Follows the state, -1 = none
+	int State;													// Toggle / momentary state, last value
+	int Kept;													// State Keep() carried over (Reload)
+	int Expr;													// Argument transform (Program index, -1 = none)
+	float Beats;												// Note length for ms (Tempo rules), ramp / LFO length (1 = 1/4)
+	float OverMs;												// Ramp / LFO length in mS (0 = Beats)
+	uint8_t Wave;												// LFO ModWave
+	uint16_t Grid;												// Quantize to MIDI clock ticks into the bar (0 = at once)
+	uint64_t Due;												// Quantized: last grid time used (CLK nS)
+	float Coef;													// Continuous: smoothing per MAP_PACE (1 = none)
+	float Target;												// Continuous: latest argument (NaN = none yet)
+	float Level;												// Continuous: smoothed (Event loop)
+	float Sent;													// Continuous: last sent (Event loop)
+	char Address[MAP_ADDRESS_MAX];								//
+	char Text[EXPR_TEXT_MAX];									// Transform source ('= ...')
+} MapRule;
+
+// -------------------------------------------------------------------------------------
+// Compiled Map
+typedef struct _mapTable{
+	uint16_t Key[MAP_KEYS];										// Row x number -> slot + 1 (0 = nothing mapped)
+	uint32_t (*Slot)[MAP_VALUES];								// Slot x value -> run, start << 8 | count (0 = nothing)
+	uint16_t *Run;												// Rule index | MAP_IN_RANGE
+	int Runs;													// Entries used in Run
+	int Slots;													//
+	MapRule Rule[MAP_RULES_MAX];								//
+	int Rules;													//
+	ExprProgram *Program;										// Compiled transforms
+	int Programs;												//
+	uint16_t Tempo[MAP_TEMPO_MAX];								// Tempo rules
+	int Tempos;													//
+	uint16_t Glide[MAP_CONTINUOUS_MAX];							// Continuous rules
+	int Glides;													//
+} MapTable;
+
+// -------------------------------------------------------------------------------------
+// Define MIDI Map Class
+class MIDIMap
+{
+private:
+	MapTable *Table;											// In use
+	RPiOSC *Osc;												//
+	RPiIO *Io;													//
+	uint64_t Fired;												// Rules fired
+	uint64_t Paced;												// Continuous values sent
+	int Readers;												// Lookups using a map now (Grace period)
+	uint64_t Reloads;											//
+	int Bpm;													// Tempo (Variables bpm / ms)
+
+	EventLoop *Loop;											// File watch
+	int WatchFd;												// inotify (-1 = not watching)
+	char File[MAP_PATH_MAX];									// Watched map file
+	const char *WatchName;										// Name part of File
+	LoopTimer Reload;											// Debounce
+	LoopTimer Pace;												// Continuous rules (Loop != NULL)
+	Modulator Mod;												// Ramp / LFO rules
+	Scheduler Sched;											// Quantized rules
+	BeatPhase *Phase;											// Their grid (NULL = not quantized)
+
+	static MapTable *NewTable(void);							//
+	static void FreeTable(MapTable *T);							//
+	static bool AddRule(MapTable *T, const char *Line);			// Parse a line into T. False if bad.
+	static bool Compile(MapTable *T);							// Rules -> lookup tables
+	static bool Covers(const MapRule *R, int Row, int Number);	//
+	bool Use(MapTable *T);										// Compile T and swap it in
+	static void Keep(MapTable *T, const MapTable *Old, bool Again = false);	// Carry rule states over (Again: what Old fired since)
+	int Lookup(int Row, int Number, int Value);					// Fire the rules for a key / value
+	void Fire(MapTable *T, MapRule *R, bool InRange, int Value, int Number = 0, OSCBundle *B = NULL);	// B = add to a bundle, not send
+	void Send(MapRule *R, float Out, OSCBundle *B);				// To the mixer, or into B (Sent if full)
+	bool Quantize(MapRule *R, float Out);						// Hold Out for R's next grid time. False = send now.
+	static bool Note(const char *Text, float *Beats);			// '1/4', '1/8.', '1/8t', '2' (Bars) -> beats
+	static int FindState(const char *Name, int Len, void *Arg);	// state(<address>) -> rule
+	static float StateOf(int Index, void *Arg);					//
+	static void OnNotify(int Fd, uint32_t Events, void *Arg);	// Directory changed (Event loop)
+	static void OnReload(void *Arg);							// Changes settled (Event loop)
+	static void OnPace(void *Arg);								// Continuous rules out (Event loop)
+
+public:
+	MIDIMap();													//
+	~MIDIMap();													//
+
+	bool Open(RPiOSC *O, RPiIO *I, EventLoop *L = NULL, BeatPhase *P = NULL);	// I = NULL, no LEDs. L = NULL, continuous rules unpaced, no ramps / LFOs. P = NULL, no quantize. Returns true if OK.
+	bool Load(const char *FileName);							// Replace the map (Kept as it was if the file is bad)
+	bool LoadText(const char *Text);							// Replace the map from lines in memory
+	bool Watch(EventLoop *L, const char *FileName);				// Reload FileName when it changes (Event loop). Returns true if OK.
+	void Unwatch(void);											//
+	int Message(const MIDIMessage *Msg);						// Channel message in. Rules fired.
+	int Switch(int Pin, bool Pressed);							// Foot switch press / release. Rules fired.
+	int Tempo(int BPM);											// Tempo changed (Event loop). Rules fired, one bundle.
+
+	void Report(FILE *Out);										// Print map size / use
+};
+
+// -------------------------------------------------------------------------------------
+#endif
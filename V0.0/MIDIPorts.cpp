@@ -0,0 +1,302 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			MIDI Ports for RPi - Linux
+Filename:		MIDIPorts.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Several MIDI ports, merge and thru.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Ports file (MIDI_PORTS_FILE in config.h, or './MOLink -m ports.conf'):
+		# name	device			[baud]
+		port	usb		/dev/ttyUSB0	31250
+		port	looper	/dev/ttyAMA1
+		# from	to		[voice] [common] [realtime]	(None = everything)
+		thru	uart	looper
+		thru	usb		looper	voice
+	  'uart' is the main port (SERIAL_PORT), always there.
+	# Every port reads on its own thread (Serial). Thru happens there, before
+	  anything else, so a routed message only waits for the output's queue.
+	  Then the message goes to the callback, under a lock, so the application
+	  sees one message at a time whatever port it came from.
+	# Merge: thru writes whole messages (Status + data, SysEx F0..F7) into the
+	  output's queue in one go, so messages from several inputs never interleave
+	  byte by byte and running status never crosses sources (Always full status).
+	  Realtime bytes skip the queue (Serial::WriteRealtime()).
+	# SysEx longer than MIDI_SYSEX_MAX is passed on truncated (As parsed).
+	# In a simulation devices aren't opened, their MIDI OUT goes to the log as
+	  'MIDI:<name> ...'.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <stdio.h>												// printf(), fopen()
+#include <string.h>												// strcmp(), strncpy()
+#include "MIDIPorts.h"											// MIDI Ports Class
+#include "Clock.h"												// Ingest time
+#include "Timing.h"												// Profiling
+#include "Sim.h"												// No devices in a simulation
+
+// ------------------------------------------------------------------------------------ //
+// Constructor
+MIDIPorts::MIDIPorts()
+{
+	Count = 0;													//
+	Loop = NULL;												//
+	Fn = NULL;													//
+	pthread_mutex_init(&Dispatch, NULL);						//
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+MIDIPorts::~MIDIPorts()
+{
+	Close();													//
+	pthread_mutex_destroy(&Dispatch);							//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Messages go to CallBack, MIDI OUT of the ports opened here is drained by L. Returns true if OK.
+bool MIDIPorts::Open(EventLoop *L, MIDIPortCallBack CallBack)
+{
+	if((L == NULL)||(CallBack == NULL)){						//
+		return false;											//
+	}
+	Loop = L;													//
+	Fn = CallBack;												//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Close and delete the ports opened here (Before the event loop goes)
+void MIDIPorts::Close(void)
+{
+	for(int I = 0; I < Count; I++){								//
+		if(Ports[I].Own){										//
+			Ports[I].Dev->CloseTx();							//
+			Ports[I].Dev->SerialClose();						//
+			delete Ports[I].Dev;								//
+		}
+		Ports[I].Dev = NULL;									//
+	}
+	Count = 0;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Add a port that is open already. Returns its index, -1 on error.
+int MIDIPorts::Add(const char *Name, Serial *Dev)
+{
+	return AddPort(Name, Dev, false);							//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Open Device at Baud and add it. Returns its index, -1 on error.
+int MIDIPorts::Add(const char *Name, const char *Device, int Baud)
+{
+	Serial *Dev = new Serial();									//
+	int Index;													//
+
+	Dev->SetName(Name);											//
+	if(((SIM == NULL)&&(Dev->SerialOpen(Device, Baud) < 0))||(!Dev->OpenTx(Loop))){	// No devices in a simulation
+		printf("\r\nERROR!!! MIDI port '%s': can't open %s\r\n", Name, Device);
+		delete Dev;												//
+		return -1;												//
+	}
+	if((Index = AddPort(Name, Dev, true)) < 0){					//
+		Dev->CloseTx();											//
+		Dev->SerialClose();										//
+		delete Dev;												//
+	}
+	return Index;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Add Dev as port Name. Returns its index, -1 on error.
+int MIDIPorts::AddPort(const char *Name, Serial *Dev, bool Own)
+{
+	MIDIPort *P;												//
+
+	if((Fn == NULL)||(Dev == NULL)){							// Not open?
+		return -1;												//
+	}
+	if(Find(Name) >= 0){										//
+		printf("\r\nERROR!!! MIDI port '%s' added twice\r\n", Name);
+		return -1;												//
+	}
+	if(Count >= MIDI_PORTS_MAX){								//
+		printf("\r\nERROR!!! MIDI ports: too many ports\r\n");
+		return -1;												//
+	}
+
+	P = &Ports[Count];											//
+	strncpy(P->Name, Name, SERIAL_NAME_MAX - 1);				//
+	P->Name[SERIAL_NAME_MAX - 1] = 0;							//
+	P->Dev = Dev;												//
+	P->Own = Own;												//
+	P->Parser.Reset();											//
+	for(int I = 0; I < MIDI_PORTS_MAX; I++){					// No routes
+		P->Thru[I] = 0;											//
+	}
+	P->In = P->Out = P->Dropped = 0;							//
+	P->Index = Count;											//
+	P->Owner = this;											//
+	__atomic_store_n(&Count, Count + 1, __ATOMIC_RELEASE);		// Visible to the other ports' threads once set up
+	Dev->SetOnReadEvent(&MIDIPorts::OnRead, P);					// Last, it may read at once
+	return P->Index;											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Route From's messages passing Filter to To (Filter 0 removes the route). Returns true if OK.
+bool MIDIPorts::Thru(int From, int To, int Filter)
+{
+	if((From < 0)||(From >= Count)||(To < 0)||(To >= Count)||(From == To)){	// Not to itself (Loops)
+		printf("\r\nERROR!!! MIDI thru: bad route %d -> %d\r\n", From, To);
+		return false;											//
+	}
+	__atomic_store_n(&Ports[From].Thru[To], Filter & MIDI_THRU_ALL, __ATOMIC_RELEASE);	// Read by From's thread
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Load ports and thru routes (See Notes). Returns false if the file or a line is bad.
+bool MIDIPorts::Load(const char *FileName)
+{
+	FILE *FPtr;													//
+	char FLine[256], Cmd[16], A[64], B[64], C[64], D[64], E[64];	//
+	int Items, Baud, Filter, From, To, LineNo = 0;				//
+	bool Ok = true;												//
+
+	if((FPtr = fopen(FileName, "r")) == NULL){					// Open file
+		printf("\r\nERROR!!! Can't Open MIDI Ports File...\r\n");
+		return false;
+	}
+	while(fgets(FLine, sizeof(FLine), FPtr) != NULL){			//
+		LineNo++;												//
+		if((Items = sscanf(FLine, "%15s %63s %63s %63s %63s %63s", Cmd, A, B, C, D, E)) < 1){	// Blank?
+			continue;											//
+		}
+		if(Cmd[0] == '#'){										// Comment?
+			continue;											//
+		}
+		if((strcmp(Cmd, "port") == 0)&&(Items >= 3)){			// port <name> <device> [baud]
+			Baud = ((Items >= 4)&&(sscanf(C, "%d", &Baud) == 1)) ? Baud : MIDI_BAUD;	//
+			if(Add(A, B, Baud) < 0){							//
+				Ok = false;										//
+			}
+		}else if((strcmp(Cmd, "thru") == 0)&&(Items >= 3)){		// thru <from> <to> [voice] [common] [realtime]
+			Filter = (Items == 3) ? MIDI_THRU_ALL : 0;			// Nothing listed = everything
+			for(int I = 3; I < Items; I++){						//
+				const char *W = (I == 3) ? C : ((I == 4) ? D : E);	//
+				if(strcmp(W, "voice") == 0){ Filter |= MIDI_THRU_VOICE; }
+				else if(strcmp(W, "common") == 0){ Filter |= MIDI_THRU_COMMON; }
+				else if(strcmp(W, "realtime") == 0){ Filter |= MIDI_THRU_REALTIME; }
+			}
+			From = Find(A);										//
+			To = Find(B);										//
+			if((Filter == 0)||(From < 0)||(To < 0)||!Thru(From, To, Filter)){	//
+				Ok = false;										//
+			}
+		}else{
+			Ok = false;											//
+		}
+		if(!Ok){												//
+			printf("\r\nERROR!!! MIDI Ports File line %d: %s\r\n", LineNo, FLine);
+			break;												//
+		}
+	}
+	fclose(FPtr);												//
+	return Ok;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Port index by name, -1 if none
+int MIDIPorts::Find(const char *Name)
+{
+	for(int I = 0; I < Count; I++){								//
+		if(strcmp(Ports[I].Name, Name) == 0){					//
+			return I;											//
+		}
+	}
+	return -1;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Port by index (NULL if none)
+Serial *MIDIPorts::Port(int Index)
+{
+	return ((Index >= 0)&&(Index < Count)) ? Ports[Index].Dev : NULL;	//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Print messages in / thru / dropped per port
+void MIDIPorts::Report(FILE *Out)
+{
+	for(int I = 0; I < Count; I++){								//
+		fprintf(Out, "MIDI port %-8s %10llu in %10llu thru %6llu dropped\r\n", Ports[I].Name,
+			(unsigned long long)__atomic_load_n(&Ports[I].In, __ATOMIC_RELAXED),
+			(unsigned long long)__atomic_load_n(&Ports[I].Out, __ATOMIC_RELAXED),
+			(unsigned long long)__atomic_load_n(&Ports[I].Dropped, __ATOMIC_RELAXED));
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Send Msg from P on to its thru outputs (P's read thread)
+void MIDIPorts::Route(MIDIPort *P, const MIDIMessage *Msg)
+{
+	int Kind, Filter;											//
+	int Cnt = __atomic_load_n(&Count, __ATOMIC_ACQUIRE);		// Ports may be added meanwhile
+
+	if(MIDI_IS_REALTIME(Msg->Raw[0])){							// Kind of message
+		Kind = MIDI_THRU_REALTIME;								//
+	}else if(Msg->Raw[0] >= MIDI_SYSEX){						//
+		Kind = MIDI_THRU_COMMON;								//
+	}else{
+		Kind = MIDI_THRU_VOICE;									//
+	}
+
+	for(int I = 0; I < Cnt; I++){								//
+		if(((Filter = __atomic_load_n(&P->Thru[I], __ATOMIC_ACQUIRE)) & Kind) == 0){	// Not routed?
+			continue;											//
+		}
+		if(Kind == MIDI_THRU_REALTIME){							// Ahead of everything
+			Ports[I].Dev->WriteRealtime(Msg->Raw[0]);			//
+		}else if(!Ports[I].Dev->SerialWrite((Msg->SysEx != NULL) ? (const char *)Msg->SysEx : (const char *)Msg->Raw,
+			(Msg->SysEx != NULL) ? Msg->SysExLen : Msg->Len)){	// Whole message, or nothing
+			__atomic_fetch_add(&P->Dropped, 1, __ATOMIC_RELAXED);	//
+			continue;											//
+		}
+		__atomic_fetch_add(&P->Out, 1, __ATOMIC_RELAXED);		//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Port read event (Port's RX thread): parse, thru, then the callback
+void *MIDIPorts::OnRead(void *Arg)
+{
+	MIDIPort *P = (MIDIPort *)Arg;								//
+	MIDIPorts *C = P->Owner;									//
+	char Buff[RX_BUFFER_SIZE + 1];								//
+	MIDIMessage Msg;											// Parsed message
+	uint64_t Now = CLK->Now();									// Ingest time
+	int Len;													//
+	PROFILE_ZONE("MIDI Read");									// Whole callback
+
+	Len = P->Dev->SerialRead(Buff);								// Read MIDI
+	for(int Ptr = 0; Ptr < Len; Ptr++){							// Chunks may hold several messages
+		if(P->Parser.Parse((uint8_t)Buff[Ptr], &Msg)){			// Complete message?
+			__atomic_fetch_add(&P->In, 1, __ATOMIC_RELAXED);	//
+			C->Route(P, &Msg);									// Thru first, lowest latency
+			pthread_mutex_lock(&C->Dispatch);					// One message at a time
+			C->Fn(P->Index, &Msg, Now);							//
+			pthread_mutex_unlock(&C->Dispatch);					//
+		}
+	}
+	return NULL;
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
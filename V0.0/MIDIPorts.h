@@ -0,0 +1,96 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			MIDI Ports Header for RPi - Linux
+Filename:		MIDIPorts.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Several MIDI ports open at once (UART, USB-serial, pty), each with its
+				own parser. Messages from every input go to one callback, one at a
+				time, and through thru routes to any outputs, merged message by
+				message with realtime bytes first.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _MIDIPORTS_H
+#define _MIDIPORTS_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdio.h>												// FILE
+#include <stdint.h>												// Fixed width types
+#include <pthread.h>											// Mutex
+#include "config.h"												// General Configuration File
+#include "Serial.h"												// Ports
+#include "MIDI.h"												// Parser
+#include "EventLoop.h"											// MIDI OUT drain
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define MIDI_PORTS_MAX		8									// Ports
+#define MIDI_PORT_MAIN		0									// First port added (UART)
+
+// -------------------------------------------------------------------------------------
+// Thru Filter (What a route passes)
+#define MIDI_THRU_VOICE		0x01								// Channel messages
+#define MIDI_THRU_COMMON	0x02								// SysEx, system common
+#define MIDI_THRU_REALTIME	0x04								// Clock, Start / Stop, Active sensing...
+#define MIDI_THRU_ALL		0x07								//
+
+// -------------------------------------------------------------------------------------
+// Message Callback. Port = index, Now = ingest time (CLK nS).
+typedef void (*MIDIPortCallBack)(int Port, const MIDIMessage *Msg, uint64_t Now);
+
+class MIDIPorts;												//
+
+// -------------------------------------------------------------------------------------
+// Port
+typedef struct _midiPort{
+	char Name[SERIAL_NAME_MAX];									//
+	Serial *Dev;												//
+	bool Own;													// Opened (and deleted) here
+	MIDIParser Parser;											// Own running status / SysEx
+	int Thru[MIDI_PORTS_MAX];									// Filter per output (0 = no route)
+	uint64_t In;												// Messages received
+	uint64_t Out;												// Messages sent on (Thru)
+	uint64_t Dropped;											// Thru messages an output had no room for
+	int Index;													//
+	MIDIPorts *Owner;											//
+} MIDIPort;
+
+// -------------------------------------------------------------------------------------
+// Define MIDI Ports Class
+class MIDIPorts
+{
+private:
+	MIDIPort Ports[MIDI_PORTS_MAX];								//
+	int Count;													//
+	EventLoop *Loop;											// Drains MIDI OUT
+	MIDIPortCallBack Fn;										//
+	pthread_mutex_t Dispatch;									// One message at a time to Fn
+
+	int AddPort(const char *Name, Serial *Dev, bool Own);		//
+	void Route(MIDIPort *P, const MIDIMessage *Msg);			// Thru
+	static void *OnRead(void *Arg);								// Port read event (Its RX thread)
+
+public:
+	MIDIPorts();												//
+	~MIDIPorts();												//
+
+	bool Open(EventLoop *L, MIDIPortCallBack CallBack);			// Returns true if OK.
+	void Close(void);											// Closes the ports opened here
+
+	int Add(const char *Name, Serial *Dev);						// Port already open (Its MIDI OUT drained already). Index, -1 = error
+	int Add(const char *Name, const char *Device, int Baud = MIDI_BAUD);	// Open Device. Index, -1 = error
+	bool Thru(int From, int To, int Filter = MIDI_THRU_ALL);	// Route From's messages to To (Filter 0 = remove)
+	bool Load(const char *FileName);							// Ports and routes from a file
+	int Find(const char *Name);									// Index, -1 = none
+	Serial *Port(int Index);									//
+
+	void Report(FILE *Out);										// Print counts per port
+};
+
+// -------------------------------------------------------------------------------------
+#endif
@@ -46,7 +46,8 @@ Setup Serial Port for MIDI:
 	Modify '/boot/cmdline.txt' - remove sections containing 'ttyAMA0'.
 	Modify '/etc/inittab' - comment out line 'T0:23:respawn:/sbin/getty -L ttyAMA0 115200 vt100'
 	
-	# Hack!!! Modify UART clock to support MIDI 31500 Baud rate (3MHz x 31250 / 38400) Using UART standard Baud Rate of 38400 bps.
+	# 31250 Baud is set exactly (termios2 / BOTHER), no UART clock changes needed.
+	# Old kernels only - Hack!!! Modify UART clock to support MIDI 31500 Baud rate (3MHz x 31250 / 38400) Using UART standard Baud Rate of 38400 bps.
 	* Add to '/boot/config.txt'
 		init_uart_clock=2441406 
 		init_uart_baud=38400
@@ -89,16 +90,35 @@ Setup I/O Interface:
 #include "Serial.h"												// Serial Class
 #include "OSC.h"												// OSC Class
 #include "GenLib.h"												// General Routines
+#include "Trace.h"												// Flight Recorder
+#include "Capture.h"											// MIDI Capture / Replay
+#include "Clock.h"												// Time source
+#include "Sim.h"												// Simulation stand-ins
+#include "MIDI.h"												// MIDI Parser
+#include "Tempo.h"												// Tempo Tracker
+#include "Timing.h"												// Interval Timers / Profiling
+#include "EventLoop.h"											// Main thread event loop
+#include "GPIOEdge.h"											// GPIO input edges
+#include "FootSwitch.h"											// Foot switch gestures
+#include "ClockOut.h"											// MIDI clock out (Master)
+#include "Timecode.h"											// MIDI time code in / out
+#include "TempoArbiter.h"										// Tempo source priorities / glide
+#include "MIDIPorts.h"											// MIDI ports, merge / thru
+#include "MIDIMap.h"											// MIDI to OSC map
+#include "ParamLaw.h"											// XR18 parameter laws
 
 // ------------------------------------------------------------------------------------ //
 // Function Prototypes
 void InitialiseFootSwitches(void);								// Initialise Foot switches
-void ProcessFootSwitches(void);									// Process Foot Switches routine
+void SetTempo(int Value);										// New BPM, published to the OSC / LED side
 
 // ------------------------------------------------------------------------------------ //
 // Prototype Callback Functions
-void *OnMIDIRead(void);											// On MIDI Read Event
+void OnMIDIMessage(int Port, const MIDIMessage *Msg, uint64_t Now);	// Complete MIDI message (Any port)
 void *BPMTempoThread(void);										// Tempo LED Thread
+void OnFootSwitch(int Pin, int Gesture, uint64_t Time);		// Foot switch gesture
+void OnTempoChange(int Fd, uint32_t Events, void *Arg);			// Published tempo changed
+void OnTempoSource(int Value, int Source);						// Tempo from the source followed
 
 // ------------------------------------------------------------------------------------ //
 // Define Classes
@@ -106,13 +126,28 @@ GenLib *GP;														// General Library
 RPiIO *IO;														// IO Class Pointer
 Serial *UART;													// Serial Class Pointer
 RPiOSC *OSC;													// OSC Class Pointer
+MIDICapture *CAP;												// MIDI Capture / Replay (NULL = off)
+EventLoop *LOOP;												// Main thread event loop
+GPIOEdge *EDGE;													// Foot switch edges
+FootSwitches *FTSW;												// Foot switch gestures
+MIDIPorts *PORTS;												// MIDI ports (UART first)
+MIDIMap *MAP;													// MIDI / foot switches to OSC
+TempoArbiter *ARB;												// Tempo sources (Clock, tap, MTC, OSC, fixed)
 
 // ------------------------------------------------------------------------------------ //
 // Define Globals
 pthread_t BPMThread;											// BPM Thread
 int BPM, prevBPM;												// Beats per minute
-int FS1, FS2;													// Foot Switch States
 bool AutoTempo, pAutoTempo;										// AutoTempo State (Foot Switch 3)
+TempoTracker MidiTempo;											// MIDI Clock Tempo
+BeatPhase TempoPhase;											// Downbeat phase (Beat LED)
+TempoState TempoOut;											// Published tempo (Seqlock + eventfd)
+Transport MidiSong;												// MIDI transport / song position (Seqlock)
+MIDIClockOut MidiClock;											// MIDI clock out (Manual tempo)
+MIDITimecode MidiTime;											// MIDI time code in (Seqlock)
+MIDITimecodeOut MidiTimeOut;									// MIDI time code out (Manual tempo)
+IntervalTimer *TapTimer;										// Tap Tempo interval (Main thread only)
+IntervalTimer TapSpare;											// Tap Tempo interval if the timer table is full
 
 // ------------------------------------------------------------------------------------ //
 // MAIN
@@ -123,20 +158,124 @@ int main(int argc, char **argv)
 	int MidiId;													// Midi UART ID
 	char Buff[BUFF_MAX + 1];									//
 	bool Reset = true;											//
+	int Opt;													// Command line option
+	const char *RecordFile = NULL;								// -r <file> Capture MIDI IN
+	const char *ReplayFile = NULL;								// -p <file> Replay capture instead of MIDI IN
+	float Speed = REPLAY_REALTIME;								// -s <speed> Replay speed (0 = ASAP)
+	bool Simulate = false;										// -v Virtual time simulation
+	const char *GPIOScript = NULL;								// -g <file> Simulated foot switch script
+	const char *SimLog = NULL;									// -o <file> Simulation log (Default stdout)
+	uint64_t SimEnd = 0;										// -t <seconds> Simulation length (Default end of replay)
+	#ifdef MIDI_PORTS_FILE
+		const char *PortsFile = MIDI_PORTS_FILE;				// -m <file> MIDI ports / thru (Skipped if missing)
+	#else
+		const char *PortsFile = NULL;							//
+	#endif
+	bool PortsOpt = false;										// -m given (Must exist)
+	#ifdef MIDI_MAP_FILE
+		const char *MapFile = MIDI_MAP_FILE;					// -c <file> MIDI to OSC map (Built in map if missing)
+	#else
+		const char *MapFile = NULL;								//
+	#endif
+	bool MapOpt = false;										// -c given (Must exist)
+	
+	// Command line
+	while((Opt = getopt(argc, argv, "r:p:s:vg:o:t:m:c:")) != -1){	//
+		switch(Opt){
+			case 'r': RecordFile = optarg; break;				//
+			case 'p': ReplayFile = optarg; break;				//
+			case 's': Speed = strtof(optarg, NULL); break;		//
+			case 'v': Simulate = true; break;					//
+			case 'g': GPIOScript = optarg; break;				//
+			case 'o': SimLog = optarg; break;					//
+			case 't': SimEnd = (uint64_t)(strtod(optarg, NULL) * NS_PER_SEC); break;
+			case 'm': PortsFile = optarg; PortsOpt = true; break;	//
+			case 'c': MapFile = optarg; MapOpt = true; break;	//
+			default:
+				printf("Usage: %s [-r capture] [-p capture [-s speed]] [-v [-g gpio script] [-o log] [-t seconds]] [-m ports] [-c map]\r\n", argv[0]);
+				return 1;
+		}
+	}
+	
+	// Simulation. Virtual time, hardware stand-ins.
+	if(Simulate){												//
+		if((ReplayFile == NULL)&&(SimEnd == 0)){				// Needs an end
+			printf("Simulation needs a replay (-p) or a length (-t)\r\n");
+			return 1;
+		}
+		CLK = new VirtualClock();								// Virtual time from CLOCK_VIRTUAL_START
+		SimEnd += (SimEnd > 0) ? CLOCK_VIRTUAL_START : 0;		// -t counts from there
+		CLK->Attach("Main");									// Main thread runs first
+		SIM = new Simulator();									//
+		if((!SIM->Open(SimLog))||((GPIOScript != NULL)&&(!SIM->LoadGPIO(GPIOScript)))){
+			return 1;
+		}
+	}
 	
 	// Set Process Priority
 	#ifdef SETPROCESS
 		setpriority(PRIO_PROCESS, 0, SETPROCESS);				// Set Process Priority
 	#endif
 	
+	// Flight Recorder
+	#ifdef TRACE_FILE
+		TRC = new Trace();										// Init. Trace
+		if(!TRC->Open(TRACE_FILE)){								// Can't trace?
+			delete TRC;											// Run without
+			TRC = NULL;											//
+		}else{
+			TRC->SetThreadName("Main");							//
+		}
+	#endif
+	
 	// Load Libraries
 	GP = NULL;													//
 	IO = NULL;													// Default
 	OSC = NULL;													//
+	CAP = NULL;													//
+	LOOP = NULL;												//
+	EDGE = NULL;												//
+	FTSW = NULL;												//
+	PORTS = NULL;												//
+	MAP = NULL;													//
+	ARB = NULL;													//
 	GP = new GenLib();											// Init. General Library
 	IO = new RPiIO();											// Init. RPiIO Library
 	UART = new Serial();										// Init. Serial Library
 	OSC = new RPiOSC();											// Init. RPiOSC Library
+	if((RecordFile != NULL)||(ReplayFile != NULL)){				// Capture or Replay?
+		CAP = new MIDICapture();								// Init. Capture Library
+	}
+	LOOP = new EventLoop();										// Init. Event Loop
+	EDGE = new GPIOEdge();										// Init. GPIO Edges
+	FTSW = new FootSwitches();									// Init. Foot Switches
+	PORTS = new MIDIPorts();									// Init. MIDI Ports
+	MAP = new MIDIMap();										// Init. MIDI Map
+	ARB = new TempoArbiter();									// Init. Tempo Arbiter
+	ParamLaw::Init();											// Init. XR18 Parameter Laws
+	#ifdef GPIO_CHIP
+		const char *Chip = GPIO_CHIP;							// GPIO character device
+	#else
+		const char *Chip = NULL;								// wiringPi polling
+	#endif
+	if((!LOOP->Open())||(!EDGE->Open(LOOP, IO, Chip))||(!FTSW->Open(LOOP, EDGE, IO, &OnFootSwitch))||
+		(!TempoOut.Open())||(!LOOP->Add(TempoOut.Fd(), EPOLLIN, &OnTempoChange, NULL))||(!UART->OpenTx(LOOP))||
+		(!PORTS->Open(LOOP, &OnMIDIMessage))||(PORTS->Add("uart", UART) != MIDI_PORT_MAIN)){	// Failed?
+		printf("\r\nCan't start event loop!\r\n");			//
+		return 1;												//
+	}
+	if((PortsFile != NULL)&&(PortsOpt || (access(PortsFile, R_OK) == 0))&&(!PORTS->Load(PortsFile))){	// More MIDI ports?
+		printf("\r\nCan't set up MIDI ports!\r\n");			//
+		return 1;												//
+	}
+	if((!MAP->Open(OSC, IO, LOOP, &TempoPhase))||(!MAP->LoadText(MIDI_MAP_DEFAULT))||	// Built in map, then the file over it
+		((MapFile != NULL)&&(MapOpt || (access(MapFile, R_OK) == 0))&&(!MAP->Load(MapFile)))){
+		printf("\r\nCan't load MIDI map!\r\n");				//
+		return 1;												//
+	}
+	if((MapFile != NULL)&&(access(MapFile, R_OK) == 0)){		// Map file? Reload it when it changes
+		MAP->Watch(LOOP, MapFile);								// (Runs without if it can't watch)
+	}
 	
 	#ifdef DEBUG
 		// Intro
@@ -166,62 +305,187 @@ int main(int argc, char **argv)
 		// Open OSC
 		if(!OSC->Open(OSC_IP, OSC_PORT)){						// Open OSC Connection Failed?
 			printf("\r\nCan't Open Socket!\r\n");				//
-			RetVal = -1;										// Error code
-			break;												// Exit 
+			if(ReplayFile == NULL){								// Replay runs offline
+				RetVal = -1;									// Error code
+				break;											// Exit 
+			}
 		}
 		
 		// Initialise MIDI
-		//MidiId = UART->SerialOpen(MIDI_BAUD);					// Open Serial Port for MIDI - ttyAMA0 @ 31250. (Not working with RPi)
-		MidiId = UART->SerialOpen(38400);						// Open Serial Port for MIDI - ttyAMA0 @ 31250. (Hacked by changing init_uart_clock)
-		if(MidiId < 0){											// Failed?
-			printf("\r\nCan't Open Serial Port!\r\n");			//
-			RetVal = -1;										// Error code
-			break;												// Exit 
+		if(ReplayFile != NULL){									// Replay capture instead of the UART?
+			if(!CAP->OpenReplay(ReplayFile)){					// Failed?
+				RetVal = -1;									// Error code
+				break;											// Exit 
+			}
+		}else{													// Live MIDI IN
+			MidiId = UART->SerialOpen(MIDI_BAUD);				// Open Serial Port for MIDI - ttyAMA0 @ 31250 (termios2 / BOTHER, exact)
+			if(MidiId < 0){										// Failed?
+				printf("\r\nCan't Open Serial Port!\r\n");		//
+				RetVal = -1;									// Error code
+				break;											// Exit 
+			}
+			if(RecordFile != NULL){								// Capture MIDI IN?
+				if(!CAP->OpenRecord(RecordFile)){				// Failed?
+					RetVal = -1;								// Error code
+					break;										// Exit 
+				}
+				UART->SetCapture(CAP);							// Record every chunk read
+			}
 		}
-		UART->SetOnReadEvent((void *(*)(void))&OnMIDIRead);		// Set up MIDI IN Read Event / Callback
 		
 		// Setup BPM Tempo Thread
-		BPM = TEMPO_DEFAULT;									// Set default BPM
+		if(!ARB->Open(LOOP, &OnTempoSource, TEMPO_DEFAULT, TEMPO_MIN, TEMPO_MAX, TEMPO_PRIORITY)){	// Default BPM until a source has one
+			RetVal = -1;										// Error code
+			break;												// Exit 
+		}
+		#ifdef TEMPO_OSC_PORT
+			if((SIM == NULL)&&(!ARB->Listen(TEMPO_OSC_PORT))){	// OSC tempo input (Not in a simulation)
+				RetVal = -1;									// Error code
+				break;											// Exit 
+			}
+		#endif
 		prevBPM = BPM;											// update previous BPM
+		CLK->Expect("BPM");										// Virtual time: announce thread
 		if(pthread_create (&BPMThread, NULL, (void*(*)(void*))&BPMTempoThread, NULL) != 0){
 			printf("ERROR!!! Couldn't start BPM Flasher thread!\r\n");
 			RetVal = -1;										// Error code
 			break;												// Exit 
 		}
+		#ifdef MIDI_CLOCK_OUT
+			if(!MidiClock.Open(UART, &TempoPhase)){				// Clock out thread (Sends in Manual only)
+				RetVal = -1;									// Error code
+				break;											// Exit 
+			}
+		#endif
+		#ifdef MIDI_MTC_OUT
+			if(!MidiTimeOut.Open(UART, MIDI_MTC_OUT)){			// Time code out thread (Manual only, from 's' / 'c')
+				RetVal = -1;									// Error code
+				break;											// Exit 
+			}
+		#endif
 	
 		memset(Buff, 0, BUFF_MAX);								// Init. Buffer
 		
+		// Start Replay (after the BPM thread so nothing is missed)
+		if((ReplayFile != NULL)&&(!CAP->StartReplay(UART, Speed))){	// Failed?
+			RetVal = -1;										// Error code
+			break;												// Exit 
+		}
+		
 		// ---------------------------------------------------- //
 		while(1){												// Loop forever
-			RetVal = GP->getKey();								// Get key press
-			if (RetVal == 0x1B) {								// ESC key pressed?
+			if(SIM == NULL){									// No keyboard in a simulation
+				RetVal = GP->getKey();							// Get key press
+				if (RetVal == 0x1B) {							// ESC key pressed?
+					RetVal = 0;									// Exit code
+					break;										// Exit loop
+				}else if(RetVal == 'p'){						// Profile report?
+					TIM->Report(stdout);						//
+					TempoPhase.Report(stdout);					//
+					MidiSong.Report(stdout);					//
+					MidiTime.Report(stdout);					//
+					MidiClock.Report(stdout);					//
+					MidiTimeOut.Report(stdout);					//
+					ARB->Report(stdout);						//
+					PORTS->Report(stdout);						//
+					MAP->Report(stdout);						//
+				}else if(RetVal == 's'){						// MIDI Start / Stop?
+					if(MidiClock.IsPlaying()){					//
+						MidiClock.SendStop();					//
+						MidiTimeOut.Stop();						//
+					}else{										//
+						MidiClock.SendStart();					// On the next downbeat
+						MidiTimeOut.Start(TempoPhase.Next(CLK->Now()));	// 00:00:00:00 on it too
+					}
+				}else if(RetVal == 'c'){						// MIDI Continue?
+					MidiClock.SendContinue();					//
+					MidiTimeOut.Continue(TempoPhase.NextTick(CLK->Now()));	// With the next tick
+				}
+			}else if((SimEnd > 0)&&(CLK->Now() >= SimEnd)){		// Simulation over?
+				RetVal = 0;										// Exit code
+				break;											// Exit loop
+			}
+			if((ReplayFile != NULL)&&(SimEnd == 0)&&(!CAP->IsReplaying())){	// Replay finished?
 				RetVal = 0;										// Exit code
 				break;											// Exit loop
 			}
 			
-			// Scan foot pedal switches
-			ProcessFootSwitches();								// Process the foot switches here
+			// Wait for foot switch edges (or LOOP_TIMEOUT for the keyboard)
+			LOOP->Run(LOOP_TIMEOUT);							// Foot switches are handled in here
 		}
 		
 		// ----------------- Close MIDI / OSC ----------------- //
 		pthread_cancel(BPMThread);								// Cancel thread
+		if(CAP != NULL){										// Replaying?
+			CAP->StopReplay();									// No more MIDI IN
+		}
+		CLK->Detach();											// Virtual time: let the other threads run down
+		MidiClock.Close();										// Stop MIDI clock out
+		MidiTimeOut.Close();									// Stop MIDI time code out
 		OSC->Close();											// Close OSC Connection
 		UART->SerialClose();									// Close MIDI Ports
+		if(CAP != NULL){										// Capture / Replay?
+			UART->SetCapture(NULL);								// Stop recording
+			CAP->Close();										// Finish capture file
+		}
+		TIM->Report((SIM != NULL) ? stderr : stdout);			// Profile (stderr keeps simulation logs repeatable)
+		TempoPhase.Report((SIM != NULL) ? stderr : stdout);		// Beat LED phase error
+		MidiSong.Report((SIM != NULL) ? stderr : stdout);		// Transport / song position
+		MidiTime.Report((SIM != NULL) ? stderr : stdout);		// MIDI time code in, drift
+		MidiClock.Report((SIM != NULL) ? stderr : stdout);		// MIDI clock out jitter
+		MidiTimeOut.Report((SIM != NULL) ? stderr : stdout);	// MIDI time code out
+		ARB->Report((SIM != NULL) ? stderr : stdout);			// Tempo sources, handovers
+		PORTS->Report((SIM != NULL) ? stderr : stdout);			// MIDI in / thru per port
+		MAP->Report((SIM != NULL) ? stderr : stdout);			// MIDI map size / rules fired
 	}
 	
 	// ------------------ Shutdown / Clean up ----------------- //	
+	if(FTSW != NULL){											// Foot Switches exist?
+		delete FTSW;											// Clean Up
+	}
+	if(EDGE != NULL){											// GPIO Edges exist?
+		delete EDGE;											// Clean Up
+	}
+	if(PORTS != NULL){											// MIDI Ports exist?
+		delete PORTS;											// Clean Up (Before the loop, drains their MIDI OUT)
+	}
+	if(MAP != NULL){											// MIDI Map exists?
+		delete MAP;												// Clean Up (No more MIDI IN / switches, before the loop)
+	}
+	if(ARB != NULL){											// Tempo Arbiter exists?
+		delete ARB;												// Clean Up (Timer / OSC input, before the loop)
+	}
+	if(UART != NULL){											// MIDI OUT drained by the loop
+		UART->CloseTx();										// Before the loop goes
+	}
+	if(LOOP != NULL){											// Event Loop exists?
+		delete LOOP;											// Clean Up
+	}
+	TempoOut.Close();											// After the loop watching it
 	if(OSC != NULL){											// OSC Resource exists?
 		delete OSC;												// Clean Up
 	}
 	if(UART != NULL){											// UART Resource exists?
 		delete UART;											// Clean Up
 	}
+	if(CAP != NULL){											// Capture Resource exists?
+		delete CAP;												// Clean Up
+	}
 	if(IO != NULL){												// IO Resource exists?
 		delete IO;												// Clean Up
 	}
 	if(GP != NULL){												// IO Resource exists?
 		delete GP;												// Clean Up
 	}
+	if(SIM != NULL){											// Simulation?
+		CLK->Detach();											// Leave virtual clock
+		delete SIM;												// Clean Up (Closes log)
+		SIM = NULL;												//
+	}
+	if(TRC != NULL){											// Trace Resource exists?
+		delete TRC;												// Clean Up
+		TRC = NULL;												//
+	}
 	
 	//return RetVal;												// Return
 	return 0;
@@ -235,201 +499,236 @@ int main(int argc, char **argv)
 void InitialiseFootSwitches(void)
 {
 	AutoTempo = true;											// Default Auto Tempo State to On
-	FS1 = 0; FS2 = 0;											// Initialise Foot Switch States
+	pAutoTempo = AutoTempo;										// First tap is a transition to Manual
+	if((TapTimer = TIM->Timer("Tap Tempo")) == NULL){			// Own timer, nobody else touches it
+		TapTimer = &TapSpare;									// Table full? Not in the report
+	}
 	
 	
 	// Set-up Foot Switches
-	pinMode(FTSW_CH1, INPUT);									// Set for input
-	pullUpDnControl(FTSW_CH1, PUD_UP);							// Set pull-up pin
-	pinMode(FTSW_CH2, INPUT);									// Set for input
-	pullUpDnControl(FTSW_CH2, PUD_UP);							// Set pull-up pin
-	pinMode(FTSW_CH3, INPUT);									// Set for input
-	pullUpDnControl(FTSW_CH3, PUD_UP);							// Set pull-up pin
+	IO->InputPullUp(FTSW_CH1);									// Set for input with pull-up
+	IO->InputPullUp(FTSW_CH2);									// Set for input with pull-up
+	IO->InputPullUp(FTSW_CH3);									// Set for input with pull-up
+	FTSW->Add(FTSW_CH1);										// Gestures to OnFootSwitch()
+	FTSW->Add(FTSW_CH2);										//
+	FTSW->Add(FTSW_CH3);										//
 		
 	// Set-up LED's	
-	pinMode(LED_CH1, OUTPUT);									// Set Status LED for output pin
-	digitalWrite(LED_CH1, LOW);									// Turn Off Pin
-	pinMode(LED_CH2, OUTPUT);									// Set Status LED for output pin
-	digitalWrite(LED_CH2, LOW);									// Turn Off Pin
-	pinMode(LED_CH3, OUTPUT);									// Set Status LED for output pin
-	digitalWrite(LED_CH3, LOW);									// Turn Off Pin
+	IO->OutputPin(LED_CH1, LOW);								// Set for output, Turn Off Pin
+	IO->OutputPin(LED_CH2, LOW);								// Set for output, Turn Off Pin
+	IO->OutputPin(LED_CH3, LOW);								// Set for output, Turn Off Pin
 		
-	pinMode(STATUS_LED, OUTPUT);								// Set Status LED for output pin
-	digitalWrite(STATUS_LED, LOW);								// Turn Off Pin
+	IO->OutputPin(STATUS_LED, LOW);								// Set for output, Turn Off Pin
 }
 
 // ------------------------------------------------------------------------------------ //
-// Process the Foot Switches/Pedals here
-void ProcessFootSwitches(void)
+// New tempo (From OnTempoSource()). Published at once, OnTempoChange() sends it.
+void SetTempo(int Value)
+{
+	BPM = Value;												// Writer's copy
+	TempoOut.Publish(Value, CLK->Now());						// Readers + eventfd
+}
+
+// ------------------------------------------------------------------------------------ //
+// Tempo from the source followed (TempoArbiter, any thread, gliding on a handover)
+void OnTempoSource(int Value, int Source)
+{
+	SetTempo(Value);											//
+	if(!AutoTempo){												// Manual? LED follows (Auto follows the clock)
+		TempoPhase.SetPeriod(CLK->Now(), (60 * NS_PER_SEC) / Value);	//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Foot Switch/Pedal gesture (Event loop). Never blocks, the other switches keep working.
+void OnFootSwitch(int Pin, int Gesture, uint64_t Time)
 {
-	char Buff[BUFF_MAX + 1];									//
 	int Ret;													//
 	long long Timeus;											// microseconds timer
-	static bool Skip;											// Skip flag
 	
-	if(IO != NULL){												// IO Class OK?
-		if((Ret = IO->InputDebounce(FTSW_CH1, 0, HOLD_TIME)) > 0){			// Foot switch, channel 1 pressed? <-- Mute FX 3 Slot Only
-			FS1 ^= 1;											// Toggle State
-			IO->OutputPin(LED_CH1, FS1);						// Output to LED
-			strncpy(Buff, "/config/mute/1", BUFF_MAX);			// Mute Group 1
-			OSC->SendInt(Buff, FS1);							// Send Int to OSC device (XR18)
-			usleep(1000 * DEBOUNCE_TIME);						// 500ms Debounce
-		}else if((Ret = IO->InputDebounce(FTSW_CH2, 0, HOLD_TIME)) > 0){	// Foot switch, channel 2 pressed? <-- Mute All FX Slots (1,2,3,4)
-			FS2 ^= 1;											// Toggle State
-			IO->OutputPin(LED_CH2, FS2);						// Output to LED
-			strncpy(Buff, "/config/mute/2", BUFF_MAX);			// Mute Group 2
-			OSC->SendInt(Buff, FS2);							// Send Int to OSC device (XR18)
-			usleep(1000 * DEBOUNCE_TIME);						// 500ms Debounce
-		}else if((Ret = IO->InputDebounce(FTSW_CH3, 0, HOLD_TIME)) > 0){	// Foot switch, channel 3 pressed? <-- Manual Tap Tempo (Tapping Foot Switch at Tempo required. Or Hold > 2 secs for automatic tempo.
-			if(Ret == 2){										// Hold Foot Switch? --> Auto Mode
-				AutoTempo = true;								// Set Auto Mode
-				if(AutoTempo != pAutoTempo){					// On Auto Tempo Transition - On?
-					pAutoTempo = AutoTempo;						// Update Previous AutoTempo
-					usleep(1000 * DEBOUNCE_TIME);				// Debounce delay
-					Skip = true;								// Set Skip Flag (For Auto Hold, Release transition).
-					printf("Auto Mode\r\n");
-				}
-			}else{												// Manual Tap Tempo?
-				AutoTempo = false;								// Clear Auto Mode
-				if(AutoTempo != pAutoTempo){					// On Auto Tempo Transition - Off?
-					if(!Skip){									// Skip Flag Clear?
-						pAutoTempo = AutoTempo;					// Update Previous AutoTempo
-						printf("Manual Mode\r\n");
-					}else{										// Skipped?
-						Skip = false;							// Clear Skip flag.
-						AutoTempo = true;						// Back to Auto Mode
-					}
-					usleep(1000 * DEBOUNCE_TIME);				// Debounce delay
-				}else{											// No transition
-					GP->StopTimer();							// Stop Timer
-					Timeus = GP->TimeDelta();					// Sample BPM
-					GP->StartTimer();							// Start Timer
-					Ret = (1000 * 1000 * 60) / Timeus;			// Calculate BPM from MIDI clock sync
+	TRACE(TRC_FTSW, Pin, Gesture);								//
+	if((Gesture == FTSW_PRESS)||(Gesture == FTSW_RELEASE)){		// Mapped switches (Channel 1 / 2 mute groups, MIDI_MAP_DEFAULT)
+		MAP->Switch(Pin, Gesture == FTSW_PRESS);				//
+	}
+	if(Pin == FTSW_CH3){										// Foot switch, channel 3 <-- Manual Tap Tempo (Tapping Foot Switch at Tempo required. Or Hold for automatic tempo.
+		if(Gesture == FTSW_HOLD){								// Hold Foot Switch? --> Auto Mode
+			AutoTempo = true;									// Set Auto Mode
+			if(AutoTempo != pAutoTempo){						// On Auto Tempo Transition - On?
+				pAutoTempo = AutoTempo;							// Update Previous AutoTempo
+				TRACE(TRC_TEMPO_MODE, AutoTempo);				//
+				printf("Auto Mode\r\n");
+				MidiClock.Enable(false);						// Clock comes from outside again
+				MidiTimeOut.Enable(false);						//
+			}
+			ARB->Release(TEMPO_SRC_TAP);						// Next source down (Clock, ...), gliding
+			IO->OutputPin(LED_CH3, HIGH);						// Output to LED On
+		}else if(Gesture == FTSW_TAP){							// Manual Tap Tempo? (Time = press)
+			AutoTempo = false;									// Clear Auto Mode
+			if(AutoTempo != pAutoTempo){						// On Auto Tempo Transition - Off?
+				pAutoTempo = AutoTempo;							// Update Previous AutoTempo
+				TRACE(TRC_TEMPO_MODE, AutoTempo);				//
+				printf("Manual Mode\r\n");
+				TapTimer->LapAt(Time);							// First tap, start timing
+				ARB->Feed(TEMPO_SRC_TAP, 0, Time);				// Tap followed, holding the tempo now
+				TempoPhase.Set(Time, (60 * NS_PER_SEC) / BPM);	// Downbeat on the tap
+				MidiClock.Enable(true);							// Master from now on
+				MidiTimeOut.Enable(true);						//
+			}else{												// No transition
+				Timeus = TapTimer->LapAt(Time) / NS_PER_US;		// Press to press, restart
+				if(Timeus > 0){									// Not the first tap?
+					Ret = (1000 * 1000 * 60) / Timeus;			// Calculate BPM from tap interval
+					TRACE(TRC_BPM, Ret, Timeus);				//
 					if((Ret >= TEMPO_MIN)&&(Ret < TEMPO_MAX)){	// Valid BPM range?
-						BPM = Ret;								// Update BPM
+						ARB->Feed(TEMPO_SRC_TAP, Ret, Time);	// Update BPM
 					}
 				}
+				TempoPhase.Set(Time, (60 * NS_PER_SEC) / BPM);	// Downbeat on the tap
 			}
 			IO->OutputPin(LED_CH3, HIGH);						// Output to LED On
 		}
 	}
 }	
 
+// ------------------------------------------------------------------------------------ //
+// Published tempo changed (Event loop, eventfd). Update the delay within the loop wake up.
+void OnTempoChange(int Fd, uint32_t Events, void *Arg)
+{
+	static long PmsTempo = 0;									// Last sent
+	static TimingZone *Latency = TIM->Zone("Tempo Publish");	// Change -> OSC sent
+	TempoValue Now;												//
+	long msTempo;												//
+	
+	TempoOut.Clear();											// Several changes, one send
+	TempoOut.Read(&Now);										// Latest
+	msTempo = (60 * 1000) / Now.BPM;							// BPM to milliseconds
+	if(msTempo == PmsTempo){									// Same delay?
+		return;													//
+	}
+	PmsTempo = msTempo;											// Update Previous value
+	TRACE(TRC_TEMPO_SEND, msTempo, Now.BPM);					//
+	
+	// Send OSC Tempo here... (MIDI map tempo rules, FX Slot 3 Delay = delay(ms) by default)
+	MAP->Tempo(Now.BPM);										//
+	Timing::Add(Latency, CLK->Now() - Now.Time);				//
+	
+	#ifdef DEBUG
+		printf("\nBPM Updated: %i [%i:%lu]\n", Now.BPM, LED_PULSE_TIME, msTempo);	// 
+	#endif
+}
+
 // ------------------------------------------------------------------------------------ //
 // ------------------------------------------------------------------------------------ //
 // Call Back Functions
 // ------------------------------------------------------------------------------------ //
-// If MIDI IN Has data, vector here.
-void *OnMIDIRead(void)
+// Complete MIDI message from Port received at time Now (nS). One at a time, whatever the port.
+void OnMIDIMessage(int Port, const MIDIMessage *Msg, uint64_t Now)
 {
-	// If any MIDI data is present, it will vector here
-	int Len, Tempo;												//
-	char Buff[BUFF_MAX + 1];									//
-	long long Timeus;											// microseconds timer
-	static char Cnt;											//
-	float TBuff;												//
-	static int ExtFS1, ExtFS2;									// External Foot Switches
+	int Tempo;													//
+	int64_t Period;												// nS per measurement
 	
-	Len = UART->SerialRead(Buff);								// Read MIDI
+	#ifdef DEBUG
+		if(!MIDI_IS_REALTIME(Msg->Raw[0])){						// Not just a clock tick?
+			printf("\r\n[%i:%i] -> ", Port, Msg->Len);		// Start of message
+			GP->PrintHex((char *)Msg->Raw, Msg->Len);			//
+		}
+	#endif
 	
-	if(AutoTempo){												// Auto MIDI Tempo Sync?
-		// Handle MIDI clock synchronise
-		if((Len == sizeof(MIDI_CLK_TICK))&&(memcmp(Buff, MIDI_CLK_TICK, Len) == 0)){
-			if(Cnt > BPM_SAMPLE){								// Filter, Every 10 MIDI Ticks
-				Cnt = 0;										//
-				GP->StopTimer();								// Stop Timer
-				Timeus = GP->TimeDelta();						// Sample BPM
-				GP->StartTimer();								// Start Timer
-				TBuff = (float)((1000 * 1000 * 300.0) / (Timeus * BPM_SAMPLE));	// Calculate BPM from MIDI clock tick (24 ticks per quarter note)
-				
-				Tempo = (int)roundf(TBuff);						// Round off float to nearest decimal
-				if((Tempo >= TEMPO_MIN)&&(Tempo < TEMPO_MAX)){	// Valid BPM range?
-					BPM = Tempo;								// Update BPM
-				}
-				if(BPM != prevBPM){								// BPM Changed?
-					prevBPM = BPM;								//
-					#ifdef DEBUG
-						printf("\n\nmsPM = %llu", Timeus);		//
-						printf("\nTempo = %i", Tempo);			//
-						printf("\nBPM = %i", BPM);				//
-					#endif
-				}
-			}else{												//
-				Cnt++;											//
+	// Handle MIDI clock synchronise, transport and time code (Main port only, the others pass it on through thru)
+	if((MIDI_IS_REALTIME(Msg->Raw[0])||(Msg->Raw[0] == MIDI_SONG_POS)||(Msg->Raw[0] == MIDI_MTC_QF))&&(Port != MIDI_PORT_MAIN)){	//
+		return;													//
+	}
+	if(Msg->Raw[0] == (uint8_t)MIDI_CLK_TICK[0]){				// Clock Tick?
+		MidiSong.Tick(Now);										// Song position moves on (If playing)
+		if(AutoTempo){											// Auto MIDI Tempo Sync?
+			TempoPhase.Tick(Now);								// Beat LED follows the clock phase
+		}
+		if((Tempo = MidiTempo.Tick(Now, &Period)) > 0){			// Measured (Every BPM_SAMPLE + 2 ticks)
+			TRACE(TRC_BPM, Tempo, Period / 1000);				//
+			ARB->Feed(TEMPO_SRC_CLOCK, Tempo, Now);				// Update BPM (If followed, out of range ignored)
+			if(BPM != prevBPM){									// BPM Changed?
+				prevBPM = BPM;									//
+				#ifdef DEBUG
+					printf("\n\nmsPM = %lli", Period / 1000);	//
+					printf("\nTempo = %i", Tempo);				//
+					printf("\nBPM = %i", BPM);					//
+				#endif
 			}
-		}else{
-			#ifdef DEBUG
-				printf("\r\n[%i==%i] -> ", Len, sizeof(MIDI_CC4_HEEL));	// Start of packet
-				GP->PrintHex(Buff, Len);						//
-			#endif
+		}else{													// Still coming (Clock alive)
+			ARB->Feed(TEMPO_SRC_CLOCK, 0, Now);					//
 		}
-	}else{														// Manual Tempo (Tap)
-		// Debug
-		if(Len > 1){
-			#ifdef DEBUG
-				printf("\r\n[%i==%i] -> ", Len, sizeof(MIDI_CC4_HEEL));	// Start of packet
-				GP->PrintHex(Buff, Len);						//
-			#endif
+		return;													//
+	}
+	if(Msg->Raw[0] == (uint8_t)MIDI_CLK_START[0]){				// Clock Start? Next tick is the downbeat
+		MidiSong.Start();										// Song position 0
+		MidiTempo.Reset();										// Measure afresh (Time stopped isn't a tempo)
+		TempoPhase.Start();										//
+		return;													//
+	}
+	if(Msg->Raw[0] == (uint8_t)MIDI_CLK_CONT[0]){				// Clock Continue? Next tick is the song position
+		MidiSong.Continue();									//
+		MidiTempo.Reset();										//
+		TempoPhase.Locate(MidiSong.Song());						// Bars where the looper's are
+		return;													//
+	}
+	if(Msg->Raw[0] == (uint8_t)MIDI_CLK_STOP[0]){				// Clock Stop? Position kept
+		MidiSong.Stop();										//
+		return;													//
+	}
+	if((Msg->Raw[0] == MIDI_SONG_POS)&&(Msg->Len == 3)){		// Song Position Pointer (1/16 notes, LSB first)
+		MidiSong.Locate(Msg->Raw[1] | (Msg->Raw[2] << 7));		//
+		return;													//
+	}
+	if((Msg->Raw[0] == MIDI_MTC_QF)&&(Msg->Len == 2)){			// MTC quarter frame? Decoded here, nothing waits
+		if(MidiTime.QuarterFrame(Msg->Raw[1], Now)){			// Locked? Time code running (Tempo source)
+			ARB->Feed(TEMPO_SRC_MTC, 0, Now);					//
 		}
+		return;													//
 	}
-	
-	// Handle Other MIDI Data (Extra Foot Switches / Pedals) - Optional???
-	if(memcmp(Buff, MIDI_CC80_1, sizeof(MIDI_CC80_1)) == 0){
-		// rtn/3/mix/on\00\00\00,i\00\00\00\00\00\00			// Mute Channel 1
-		ExtFS1 ^= 1;											// Toggle State
-		strncpy(Buff, "/ch/01/mix/on", BUFF_MAX);				// Channel 1, Mute
-		OSC->SendInt(Buff, ExtFS1);								// Send Int to OSC device (XR18)
-	}else if(memcmp(Buff, MIDI_CC81_1, sizeof(MIDI_CC81_1)) == 0){	//
-		ExtFS2 ^= 1;											// Toggle State
-		strncpy(Buff, "/ch/02/mix/on", BUFF_MAX);				// Channel 2, Mute
-		OSC->SendInt(Buff, ExtFS2);								// Send Int to OSC device (XR18)
-	}else if(memcmp(Buff, MIDI_CC82_1, sizeof(MIDI_CC82_1)) == 0){	//
-		BPM = 120;
+	if((Port == MIDI_PORT_MAIN)&&MidiTime.FullFrame(Msg->SysEx, Msg->SysExLen, Now)){	// MTC full frame? Locate
+		return;													//
 	}
 	
+	// Handle Other MIDI Data (Extra Foot Switches / Pedals) - MIDI map
+	MAP->Message(Msg);											// Rules for this status / number / value
+	if((Msg->Len == sizeof(MIDI_CC82_1))&&(memcmp(Msg->Raw, MIDI_CC82_1, sizeof(MIDI_CC82_1)) == 0)){	//
+		ARB->Feed(ARB->Source(), 120, Now);						// Source followed to 120 (Clock: until measured again)
+	}
 }
 
 // ------------------------------------------------------------------------------------ //
 // ------------------------------------------------------------------------------------ //
 // Threads
 // ------------------------------------------------------------------------------------ //
-// BPM Tempo Thread. Flash LED at BPM rate. Update Tempo via OSC.
+// BPM Tempo Thread. Flash LED on the beat (Absolute time, locked to the MIDI clock / taps).
 void *BPMTempoThread(void)
 {
-	long msPM = 0;															//
-	long msTempo, PmsTempo;													//
-	float DelayTime;														//
-	char OSCText[BUFF_MAX + 1];												//
+	uint64_t Beat, BeatNs, Prev = 0;										// Downbeat times (nS)
+	TempoValue Tempo;														// Published tempo
 	
+	if(TRC != NULL){ TRC->SetThreadName("BPM Tempo"); }					// Claim trace ring
+	CLK->Attach("BPM");														// Virtual time: join clock
 	while(1){																// Loop Forever (Thread)
-		msTempo = (60 * 1000) / BPM;										// BPM to milliseconds
-		msPM = msTempo - LED_PULSE_TIME;										// Calculate LED pulse time
-		if(AutoTempo){														// Auto MIDI Tempo Sync? Toggle LED
-			IO->OutputPulse(LED_CH3, msPM, LED_PULSE_TIME);					// Pulse LED, 100ms Off, remaining BPM time On.
-		}else{																// Manual - Pulse LED
-			IO->OutputPulse(LED_CH3, LED_PULSE_TIME, msPM);					// Pulse LED, 100ms On, remaining BPM time off.
+		if((Beat = TempoPhase.Next(CLK->Now(), &BeatNs)) == 0){			// No tempo yet? Start a grid at BPM, now
+			TempoOut.Read(&Tempo);											//
+			BeatNs = Tempo.BeatNs;											//
+			Beat = CLK->Now();												//
+			TempoPhase.Set(Beat, BeatNs);									//
+		}else if((Prev != 0)&&(Beat < Prev + (BeatNs / 2))){				// Phase moved back? One flash per beat
+			Beat = TempoPhase.Next(Beat, &BeatNs);							//
 		}
+		Prev = Beat;														//
 		
-		// Check for Tempo Change Here
-		if(msTempo != PmsTempo){											// BPM Change?
-			PmsTempo = msTempo;												// Update Previous value
-			
-			// Send OSC Tempo here...
-			DelayTime = (float)(msTempo / 3000.0);							// Calculate delay in float format
-			//sprintf(OSCText, "/fx/1/par/01");								// FX Slot 1, Parameter 1 (Delay)
-			//OSC->SendFloat(OSCText, DelayTime);							// Send to OSC device (XR18)
-			//sprintf(OSCText, "/fx/2/par/01");								// FX Slot 2, Parameter 1 (Delay)
-			//OSC->SendFloat(OSCText, DelayTime);							// Send to OSC device (XR18)
-			strncpy(OSCText, "/fx/3/par/01", BUFF_MAX);						// FX Slot 3, Parameter 1 (Delay)
-			OSC->SendFloat(OSCText, DelayTime);								// Send to OSC device (XR18)
-			//sprintf(OSCText, "/fx/4/par/01");								// FX Slot 4, Parameter 1 (Delay)
-			//OSC->SendFloat(OSCText, DelayTime);							// Send to OSC device (XR18)
-			
-			#ifdef DEBUG
-				printf("\nBPM Updated: %i [%i:%lu]\n", BPM, LED_PULSE_TIME, msTempo);	// 
-			#endif
+		CLK->SleepUntil(Beat);												// Absolute, nothing accumulates
+		IO->OutputPin(LED_CH3, HIGH);										// On the beat
+		if(AutoTempo){														// Auto MIDI Tempo Sync? On, 100ms Off before the next beat
+			CLK->SleepUntil(Beat + BeatNs - (LED_PULSE_TIME * NS_PER_MS));	//
+		}else{																// Manual - 100ms On
+			CLK->SleepUntil(Beat + (LED_PULSE_TIME * NS_PER_MS));			//
 		}
+		IO->OutputPin(LED_CH3, LOW);										//
 	}
+	
+	return NULL;
 }
 
 // ------------------------------------------------------------------------------------ //
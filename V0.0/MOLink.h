@@ -20,6 +20,7 @@ Description:	MOLink Header. Link between MIDI devices and OSC devices.
 // -------------------------------------------------------------------------------------
 // Constants
 #define BUFF_MAX				1024							// Buffer Maximum Size
+#define LOOP_TIMEOUT			50								// Main loop wake up (Keyboard) in mS
 
 // -------------------------------------------------------------------------------------
 // MIDI Constants
@@ -36,13 +37,20 @@ const char MIDI_CLK_CONT[] =	{0xFB};							// MIDI Clock Continue
 const char MIDI_CC4_HEEL[] =	{0xB0, 0x04, 0x00};				// MIDI CC4 (Heel)
 const char MIDI_CC4_TOE[] =		{0xB0, 0x04, 0x7F};				// MIDI CC4 (Toe)
 
-const char MIDI_CC80_0[] = {0xB0, 0x50, 0x00};					// MIDI CC80 (OFF)
-const char MIDI_CC80_1[] = {0xB0, 0x50, 0x7F};					// MIDI CC80 (ON) or Trigger
-const char MIDI_CC81_0[] = {0xB0, 0x51, 0x00};					// MIDI CC81 (OFF)
-const char MIDI_CC81_1[] = {0xB0, 0x51, 0x7F};					// MIDI CC81 (ON) or Trigger
 const char MIDI_CC82_0[] = {0xB0, 0x52, 0x00};					// MIDI CC82 (OFF)
 const char MIDI_CC82_1[] = {0xB0, 0x52, 0x7F};					// MIDI CC82 (ON) or Trigger
 
+// -------------------------------------------------------------------------------------
+// Built in MIDI Map (MIDIMap.cpp Notes. A map file replaces it.)
+#define MAP_PIN(P)			MAP_PIN_(P)							// Pin number as text
+#define MAP_PIN_(P)			#P									//
+const char MIDI_MAP_DEFAULT[] =
+	"cc 1 80 127 toggle /ch/01/mix/on i\n"						// CC80 (Extra foot switch) - Mute Channel 1
+	"cc 1 81 127 toggle /ch/02/mix/on i\n"						// CC81 - Mute Channel 2
+	"switch * " MAP_PIN(FTSW_CH1) " 127 toggle /config/mute/1 i led " MAP_PIN(LED_CH1) "\n"	// Foot switch 1 - Mute Group 1 (FX 3 Slot)
+	"switch * " MAP_PIN(FTSW_CH2) " 127 toggle /config/mute/2 i led " MAP_PIN(LED_CH2) "\n"	// Foot switch 2 - Mute Group 2 (All FX Slots)
+	"tempo * * * absolute /fx/3/par/01 f = delay(ms)\n";		// FX Slot 3, Parameter 1 (Delay). FX 1, 2, 4 the same if wanted.
+
 //*
 // -------------------------------------------------------------------------------------
 // Terminal Constants (PuTTY or similar)
@@ -0,0 +1,114 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			Modulator Header for RPi - Linux
+Filename:		Modulator.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Mixer motion made by MOLink: timed ramps (fades) and tempo synced
+				LFOs (tremolo, auto-pan, sweeps) on any OSC parameter. One timer
+				runs every modulator in a single pass over flat arrays and sends
+				the values of a tick in one bundle.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _MODULATOR_H
+#define _MODULATOR_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdio.h>												// FILE
+#include <stdint.h>												// Fixed width types
+#include <pthread.h>											// Command queue lock
+#include "config.h"												// General Configuration File
+#include "OSC.h"												// OSC Class
+#include "EventLoop.h"											// Tick timer
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define MOD_MAX				64									// Modulators running at once
+#define MOD_TICK			20									// mS between updates (50 / S)
+#define MOD_COMMANDS		64									// Queued starts / stops (Any thread)
+#define MOD_ADDRESS_MAX		64									// OSC address length
+#define MOD_BPM_DEFAULT		120									// Until the first tempo
+
+// -------------------------------------------------------------------------------------
+// Waves (MOD_RAMP goes once, the others repeat)
+enum ModWave
+{
+	MOD_STOP = 0,												// Command: stop the address
+	MOD_RAMP,													// Lo -> Hi once, then done
+	MOD_SINE,													// Lo..Hi..Lo (Smoothed triangle, within ~1 % of a sine)
+	MOD_TRIANGLE,												//
+	MOD_SQUARE,													// Hi the middle half of the period
+	MOD_SAW														// Lo -> Hi, jump back
+};
+
+// -------------------------------------------------------------------------------------
+// Start / stop, queued for the event loop
+typedef struct _modCommand{
+	char Address[MOD_ADDRESS_MAX];								//
+	uint8_t Wave;												// ModWave
+	bool Float;													// ,f else ,i
+	float Lo, Hi;												// Ramp: from (Unless running) / to. LFO: range
+	float Beats;												// Ramp length / LFO period in beats, or
+	float Ms;													// in mS (> 0)
+} ModCommand;
+
+// -------------------------------------------------------------------------------------
+// Define Modulator Class
+class Modulator
+{
+private:
+	// Running modulators, one array per field so a tick is straight loops over floats
+	float Phase[MOD_MAX];										// 0..1 (Ramp: done at 1)
+	float Inc[MOD_MAX];											// Phase per tick
+	float Wrap[MOD_MAX];										// 1 = LFO (Phase wraps), 0 = ramp
+	float Lo[MOD_MAX], Span[MOD_MAX];							// Out = Lo + Span x wave
+	float KSaw[MOD_MAX], KTri[MOD_MAX], KSine[MOD_MAX], KSquare[MOD_MAX];	// Wave mix (One of them 1)
+	float Out[MOD_MAX];											// This tick
+	float Sent[MOD_MAX];										// Last sent (NaN = nothing yet)
+	float Beats[MOD_MAX], Ms[MOD_MAX];							// Period as asked (Inc follows the tempo)
+	bool Float[MOD_MAX];										//
+	char Address[MOD_MAX][MOD_ADDRESS_MAX];						//
+	int Count;													// Running (0..Count-1)
+
+	ModCommand Queue[MOD_COMMANDS];								// Commands from any thread
+	int Queued;													//
+	pthread_mutex_t Lock;										// Queue
+	int WakeFd;													// Wakes the loop for commands (eventfd, -1 = none)
+
+	EventLoop *Loop;											// NULL = commands applied straight away
+	RPiOSC *Osc;												//
+	LoopTimer Timer;											// Runs while anything does
+	int Bpm;													//
+	uint64_t Ticks, Sends;										//
+
+	int Find(const char *Address);								// Index, -1 = not running
+	void Apply(const ModCommand *C);							// Start / stop (Event loop)
+	void Drop(int I);											// Remove (Last takes its place)
+	void Rate(int I);											// Inc from the period and tempo
+	bool Post(const ModCommand *C);								// Queue (Or apply), wake the loop
+	static void OnWake(int Fd, uint32_t Events, void *Arg);		// Commands queued (Event loop)
+	static void OnTimer(void *Arg);								// Tick (Event loop)
+
+public:
+	Modulator();												//
+	~Modulator();												//
+
+	bool Open(EventLoop *L, RPiOSC *O);							// L = NULL, single thread (Commands applied at once). Returns true if OK.
+	void Close(void);											// Before the loop goes
+
+	bool Ramp(const char *Address, bool IsFloat, float From, float To, float Beats, float Ms = 0);	// From where it is if running
+	bool Lfo(const char *Address, bool IsFloat, float L, float H, int Wave, float Beats, float Ms = 0);	// Period in beats (Or mS)
+	bool Stop(const char *Address);								// (Any thread) False if the queue is full
+	void Tempo(int BPM);										// Beat periods follow (Event loop)
+	int Tick(void);												// Advance everything one tick and send. Returns values sent.
+
+	void Report(FILE *Out);										// Running / sent
+};
+
+// -------------------------------------------------------------------------------------
+#endif
@@ -23,6 +23,8 @@ Resources:
 #include <unistd.h>																		// for usleep()
 
 #include "OSC.h"																		// OSC Class
+#include "Sim.h"																		// Simulated network
+#include "Timing.h"																		// Profiling
 
 // ------------------------------------------------------------------------------------ //
 void OnReadOSC(void);																	// On Read OSC Event / Callback
@@ -56,6 +58,13 @@ bool RPiOSC::Open(char *Address, int Port)
 	int Len, TimeOut;																	//
 	char Buff[OSC_BUFF_MAX+1];															//
 	
+	// Simulation? Datagrams go to the simulation log
+	if(SIM != NULL){																	//
+		SKT->SetSink(&Simulator::OSCSink);												//
+		SktId = 1;																		// Looks open
+		return true;																	//
+	}
+	
 	// Get Gateway & IP Address and Display
 	SKT->GetGateway(ETH_DEVICE, Buff);
 	if(Buff[0] != 0){																	// Ethernet Cable Connected?
@@ -134,16 +143,12 @@ void RPiOSC::Close(void)
 void RPiOSC::Send(const char *Data)
 {
 	int Len;																			//
-	char *Buff;																			//
+	char Buff[OSC_MSG_MAX];																// Stack buffer, no allocation
+	PROFILE_ZONE("OSC Send");															// Encode + write
 	
 	if(SktId > 0){																		// Socket OK?
-		Len = strlen(Data);																//
-		Buff = new char[Len + 16];														// Allocate buffer space
-		if(Buff != NULL){																// Buffer OK?
-			memcpy(Buff, Data, Len);													// Add Data
-			memcpy(&Buff[Len], "\0\0", 2);												// Add zero's
-			SKT->SocketWrite(Buff, Len + 2);											// Send OSC packet
-			delete []Buff;																// Clean up
+		if((Len = Encode(Buff, sizeof(Buff), Data)) > 0){								// Fits?
+			SKT->SocketWrite(Buff, Len);												// Send OSC packet
 		}
 	}
 }
@@ -152,32 +157,13 @@ void RPiOSC::Send(const char *Data)
 // OSC Send Int
 void RPiOSC::SendInt(const char *Data, int Value)
 {
-	int Len, Ofs;																		//
-	char *Buff;																			//
-	IntRaw rawI;
+	int Len;																			//
+	char Buff[OSC_MSG_MAX];																// Stack buffer, no allocation
+	PROFILE_ZONE("OSC Send");															// Encode + write
+	
 	if(SktId > 0){																		// Socket OK?
-		Len = strlen(Data);																//
-		Buff = new char[Len + sizeof(OSCInt) + 16];										// Allocate buffer space
-		if(Buff != NULL){																// Buffer OK?
-			memset(Buff, 0, Len + sizeof(OSCInt) + 15);									//
-			memcpy(Buff, Data, Len);													//
-			Ofs = Len / 4;																//
-			Ofs = ((Ofs + 1) * 4);															//
-			memcpy(&Buff[Ofs], OSCInt, sizeof(OSCInt));									// Add OSC Text
-			rawI.i = Value;																// Set Int
-			Buff[Ofs + sizeof(OSCInt)] = rawI.s[3];
-			Buff[Ofs + sizeof(OSCInt) + 1] = rawI.s[2];
-			Buff[Ofs + sizeof(OSCInt) + 2] = rawI.s[1];
-			Buff[Ofs + sizeof(OSCInt) + 3] = rawI.s[0];
-			/*
-			printf("\nOSC ([%i]%i): ", Ofs, Value);
-			for(int i = 0; i < Len + sizeof(OSCInt) + sizeof(rawI.s); i++){
-				printf("%.2X ", Buff[i]);
-			}
-			printf("\r\n");
-			*/
-			SKT->SocketWrite(Buff, Ofs + sizeof(OSCInt) + sizeof(rawI.s));				// Send OSC packet
-			delete []Buff;																// Clean up
+		if((Len = EncodeInt(Buff, sizeof(Buff), Data, Value)) > 0){						// Fits?
+			SKT->SocketWrite(Buff, Len);												// Send OSC packet
 		}
 	}
 }
@@ -187,26 +173,198 @@ void RPiOSC::SendInt(const char *Data, int Value)
 void RPiOSC::SendFloat(const char *Data, float Value)
 {
 	int Len;																			//
-	char *Buff;																			//
+	char Buff[OSC_MSG_MAX];																// Stack buffer, no allocation
+	PROFILE_ZONE("OSC Send");															// Encode + write
+	
+	if(SktId > 0){																		// Socket OK?
+		if((Len = EncodeFloat(Buff, sizeof(Buff), Data, Value)) > 0){					// Fits?
+			SKT->SocketWrite(Buff, Len);												// Send OSC packet
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Encode address only. Address is zero padded to a multiple of 4 bytes.
+// Returns message length, or 0 if it doesn't fit in Size.
+int RPiOSC::Encode(char *Buff, int Size, const char *Address)
+{
+	int Len = strlen(Address);															//
+	int Ofs = ((Len / 4) + 1) * 4;														// At least one terminating zero
+	
+	if(Ofs > Size){																		// Too big?
+		return 0;																		//
+	}
+	memcpy(Buff, Address, Len);															// Add Address
+	memset(&Buff[Len], 0, Ofs - Len);													// Pad
+	
+	return Ofs;																			//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Encode address with one int argument (Big-Endian)
+int RPiOSC::EncodeInt(char *Buff, int Size, const char *Address, int Value)
+{
+	int Ofs;																			//
+	IntRaw rawI;																		//
+	
+	if(((Ofs = Encode(Buff, Size, Address)) == 0)||(Ofs + (int)sizeof(OSCInt) + 4 > Size)){	// Fits?
+		return 0;																		//
+	}
+	memcpy(&Buff[Ofs], OSCInt, sizeof(OSCInt));										// Add OSC Type
+	Ofs += sizeof(OSCInt);																//
+	rawI.i = Value;																		// Set Int
+	Buff[Ofs] = rawI.s[3];																// Big-Endian order
+	Buff[Ofs + 1] = rawI.s[2];															//
+	Buff[Ofs + 2] = rawI.s[1];															//
+	Buff[Ofs + 3] = rawI.s[0];															//
+	
+	return Ofs + 4;																		//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Encode address with one float argument (Big-Endian)
+int RPiOSC::EncodeFloat(char *Buff, int Size, const char *Address, float Value)
+{
+	int Ofs;																			//
 	FloatRaw rawF;																		//
+	
+	if(((Ofs = Encode(Buff, Size, Address)) == 0)||(Ofs + 8 > Size)){					// Fits?
+		return 0;																		//
+	}
+	memcpy(&Buff[Ofs], &OSCFloat[4], 4);												// Add OSC Type (",f")
+	Ofs += 4;																			//
+	rawF.f = Value;																		// Set float
+	Buff[Ofs] = rawF.s[3];																// Big-Endian order
+	Buff[Ofs + 1] = rawF.s[2];															//
+	Buff[Ofs + 2] = rawF.s[1];															//
+	Buff[Ofs + 3] = rawF.s[0];															//
+	
+	return Ofs + 4;																		//
+}
 
-	if(SktId > 0){																		// Socket OK?
-		Len = strlen(Data);																//
-		Buff = new char[Len + sizeof(OSCFloat) + 4];									// Allocate buffer space
-		if(Buff != NULL){																// Buffer OK?
-			memcpy(Buff, Data, Len);													//
-			memcpy(&Buff[Len], OSCFloat, sizeof(OSCFloat));								// Add OSC Text
-			rawF.f = Value;																// Set float
-			Buff[Len + sizeof(OSCFloat)] = rawF.s[3];									// Set float value (Big-Endian order)
-			Buff[Len + sizeof(OSCFloat) + 1] = rawF.s[2];	                            //
-			Buff[Len + sizeof(OSCFloat) + 2] = rawF.s[1];                               //
-			Buff[Len + sizeof(OSCFloat) + 3] = rawF.s[0];                               //
-			SKT->SocketWrite(Buff, Len + sizeof(OSCFloat) + sizeof(rawF.s));			// Send OSC packet
-			delete []Buff;																// Clean up
+// ------------------------------------------------------------------------------------ //
+// Start a bundle: '#bundle', 64 bit time tag (Big-Endian), no messages yet
+void RPiOSC::BundleStart(OSCBundle *B, uint64_t TimeTag)
+{
+	memcpy(B->Data, "#bundle", 8);														// With its zero
+	for(int i = 0; i < 8; i++){															//
+		B->Data[8 + i] = (char)(TimeTag >> (56 - (i * 8)));								//
+	}
+	B->Len = 16;																		//
+	B->Count = 0;																		//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Add a message with one int argument, size first (Big-Endian). False if it doesn't fit.
+bool RPiOSC::BundleAddInt(OSCBundle *B, const char *Address, int Value)
+{
+	int Len;																			//
+	
+	if((B->Len + 4 >= OSC_BUNDLE_MAX)||((Len = EncodeInt(&B->Data[B->Len + 4], OSC_BUNDLE_MAX - B->Len - 4, Address, Value)) == 0)){
+		return false;																	//
+	}
+	B->Data[B->Len] = 0;																// Size
+	B->Data[B->Len + 1] = 0;															//
+	B->Data[B->Len + 2] = (char)(Len >> 8);												//
+	B->Data[B->Len + 3] = (char)Len;													//
+	B->Len += 4 + Len;																	//
+	B->Count++;																			//
+	return true;																		//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Add a message with one float argument. False if it doesn't fit.
+bool RPiOSC::BundleAddFloat(OSCBundle *B, const char *Address, float Value)
+{
+	int Len;																			//
+	
+	if((B->Len + 4 >= OSC_BUNDLE_MAX)||((Len = EncodeFloat(&B->Data[B->Len + 4], OSC_BUNDLE_MAX - B->Len - 4, Address, Value)) == 0)){
+		return false;																	//
+	}
+	B->Data[B->Len] = 0;																// Size
+	B->Data[B->Len + 1] = 0;															//
+	B->Data[B->Len + 2] = (char)(Len >> 8);												//
+	B->Data[B->Len + 3] = (char)Len;													//
+	B->Len += 4 + Len;																	//
+	B->Count++;																			//
+	return true;																		//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Add the messages of From (Its time tag is dropped). False if they don't all fit.
+bool RPiOSC::BundleAppend(OSCBundle *B, const OSCBundle *From)
+{
+	if(B->Len + From->Len - 16 > OSC_BUNDLE_MAX){										//
+		return false;																	//
+	}
+	memcpy(&B->Data[B->Len], &From->Data[16], From->Len - 16);							// Sizes and messages as they are
+	B->Len += From->Len - 16;															//
+	B->Count += From->Count;															//
+	return true;																		//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Time tag of a bundle (NTP format, OSC_IMMEDIATE = now)
+uint64_t RPiOSC::BundleTimeTag(const OSCBundle *B)
+{
+	uint64_t TimeTag = 0;																//
+
+	for(int i = 0; i < 8; i++){															//
+		TimeTag = (TimeTag << 8) | (unsigned char)B->Data[8 + i];						//
+	}
+	return TimeTag;																		//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Send a bundle as one datagram. A lone message goes without the bundle around it.
+void RPiOSC::SendBundle(OSCBundle *B)
+{
+	PROFILE_ZONE("OSC Send");															// Write
+	
+	if((SktId > 0)&&(B->Count > 0)){													// Socket OK? Anything?
+		if(B->Count == 1){																// Bare message
+			SKT->SocketWrite(&B->Data[20], B->Len - 20);								//
+		}else{
+			SKT->SocketWrite(B->Data, B->Len);											// Send OSC bundle
 		}
 	}
 }
 
+// ------------------------------------------------------------------------------------ //
+// Decode a single argument message ('i', 'f' or none)
+bool RPiOSC::Decode(const char *Data, int Len, OSCMessage *Msg)
+{
+	int Ofs, ALen;																		//
+	IntRaw rawI;																		//
+	
+	if((Len < 4)||(Data[0] != '/')){													// Not a message?
+		return false;																	//
+	}
+	ALen = strnlen(Data, Len);															//
+	Ofs = ((ALen / 4) + 1) * 4;															// Type tag
+	Msg->Address = Data;																//
+	Msg->Type = 0;																		//
+	Msg->Int = 0;																		//
+	Msg->Float = 0;																		//
+	if((ALen == Len)||(Ofs + 8 > Len)||(Data[Ofs] != ',')){								// No argument?
+		return (ALen < Len);															// Must be terminated
+	}
+	rawI.s[3] = Data[Ofs + 4];															// Big-Endian order
+	rawI.s[2] = Data[Ofs + 5];															//
+	rawI.s[1] = Data[Ofs + 6];															//
+	rawI.s[0] = Data[Ofs + 7];															//
+	Msg->Type = Data[Ofs + 1];															//
+	if(Msg->Type == 'f'){																// Float?
+		memcpy(&Msg->Float, rawI.s, sizeof(float));										//
+	}else if(Msg->Type == 'i'){															// Int?
+		Msg->Int = rawI.i;																//
+	}else{																				// Unsupported
+		return false;																	//
+	}
+	
+	return true;																		//
+}
+
 // ------------------------------------------------------------------------------------ //
 // OSC Receive
 void RPiOSC::Receive(char *Data, int Size)
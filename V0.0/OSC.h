@@ -18,6 +18,7 @@ Description:	OSC Interface for the Raspberry Pi.
 
 // -------------------------------------------------------------------------------------
 // Includes
+#include <stdint.h>												// Fixed width types
 #include "config.h"												//
 #include "UDPSocket.h"											// Simple UDP Socket Library
 
@@ -26,6 +27,9 @@ Description:	OSC Interface for the Raspberry Pi.
 // -------------------------------------------------------------------------------------
 // Constants
 #define OSC_BUFF_MAX		8192								// Buffer Maximum
+#define OSC_MSG_MAX			256									// Single message maximum (Encode)
+#define OSC_BUNDLE_MAX		1472								// Bundle maximum (One Ethernet frame)
+#define OSC_IMMEDIATE		1ULL								// Bundle time tag: now
 
 #define TCP_TYPE			SOCK_STREAM							// TCP type
 #define UDP_TYPE			SOCK_DGRAM							// UDP type
@@ -58,6 +62,23 @@ typedef union _floatRaw{
   char  s[4];
 } FloatRaw;
 
+// -------------------------------------------------------------------------------------
+// Decoded single argument OSC message
+typedef struct _oscMessage{
+	const char *Address;										// Points into the datagram
+	char Type;													// 'i', 'f' or 0 (No argument)
+	int Int;													//
+	float Float;												//
+} OSCMessage;
+
+// -------------------------------------------------------------------------------------
+// Bundle being built (Messages applied together by the receiver)
+typedef struct _oscBundle{
+	char Data[OSC_BUNDLE_MAX];									// '#bundle', time tag, [size, message]...
+	int Len;													// Bytes used
+	int Count;													// Messages
+} OSCBundle;
+
 // -------------------------------------------------------------------------------------
 // Define OSC Class
 class RPiOSC
@@ -77,6 +98,18 @@ public:
 	void Receive(char *Data, int Size);							//
 	int GetBytesAvailable(void);								//
 	
+	static int Encode(char *Buff, int Size, const char *Address);				// Returns length, 0 if too big
+	static int EncodeInt(char *Buff, int Size, const char *Address, int Value);	//
+	static int EncodeFloat(char *Buff, int Size, const char *Address, float Value);	//
+	static bool Decode(const char *Data, int Len, OSCMessage *Msg);				//
+	
+	static void BundleStart(OSCBundle *B, uint64_t TimeTag = OSC_IMMEDIATE);	// NTP format time tag
+	static bool BundleAddInt(OSCBundle *B, const char *Address, int Value);	// False if full
+	static bool BundleAddFloat(OSCBundle *B, const char *Address, float Value);	//
+	static bool BundleAppend(OSCBundle *B, const OSCBundle *From);	// From's messages too. False if full.
+	static uint64_t BundleTimeTag(const OSCBundle *B);			//
+	void SendBundle(OSCBundle *B);								// One datagram (A single message is sent bare)
+	
 	void OnRead(void);											//
 };
 
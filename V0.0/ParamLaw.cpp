@@ -0,0 +1,143 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			Parameter Law for RPi - Linux
+Filename:		ParamLaw.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	XR18 parameter law tables.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Built in laws (Expression functions, '<name>(units)' -> OSC float,
+	  '<name>_units(float)' -> units):
+		fader		-90 (-oo) .. +10 dB		X32 / XR18 fader, 4 linear segments
+		freq		20 .. 20000 Hz, log		EQ band frequency
+		lowcut		20 .. 400 Hz, log		Channel low cut
+		q			10 .. 0.3, log			EQ band Q (Goes down)
+		eqgain		-15 .. +15 dB			EQ band gain
+		pan			-100 .. +100			Channel pan
+		delay		0 .. 3000 mS			FX delay time (As MOLink has always sent it)
+	# Tables hold the units at LAW_POINTS + 1 evenly spaced floats. Float ->
+	  units is an index and a linear interpolation. Units -> float finds the
+	  segment from a bucket table (Buckets even in units, or in the float's
+	  exponent / mantissa bits, a rough log2, for the log laws) and a step or
+	  two along the (increasing) Key column, then interpolates the same. With
+	  256 segments a 20 Hz .. 20 kHz log law is within 0.01 % of log / pow,
+	  the fader segment ends fall on table points so it's exact.
+	# The tables are built at start up (Init), the compiler here doesn't do
+	  constexpr, and a table in memory costs the same to read.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <stdio.h>												// printf()
+#include <string.h>												// strncpy(), strncmp()
+#include <math.h>												// pow(), log()
+#include "ParamLaw.h"											// Parameter Law Class
+
+// ------------------------------------------------------------------------------------ //
+// Tables
+LawTable ParamLaw::Laws[LAW_MAX];								//
+int ParamLaw::Count = 0;										//
+
+// ------------------------------------------------------------------------------------ //
+// Build the XR18 laws. Call once before threads start (Find() calls it if not).
+void ParamLaw::Init(void)
+{
+	if(Count != 0){												// Done
+		return;													//
+	}
+	Add("fader", LAW_FADER, -90, 10);							//
+	Add("freq", LAW_LOG, 20, 20000);							//
+	Add("lowcut", LAW_LOG, 20, 400);							//
+	Add("q", LAW_LOG, 10, 0.3);									//
+	Add("eqgain", LAW_LIN, -15, 15);							//
+	Add("pan", LAW_LIN, -100, 100);								//
+	Add("delay", LAW_LIN, 0, 3000);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Build a law table. Returns its index, -1 if bad or the table is full.
+int ParamLaw::Add(const char *Name, int C, float Min, float Max)
+{
+	LawTable *L;												//
+
+	if((Count >= LAW_MAX)||(Min == Max)||((C == LAW_LOG)&&((Min <= 0)||(Max <= 0)))){
+		printf("\r\nERROR!!! Bad parameter law '%s'\r\n", Name);	//
+		return -1;												//
+	}
+	L = &Laws[Count];											//
+	memset(L, 0, sizeof(LawTable));								//
+	strncpy(L->Name, Name, LAW_NAME_MAX - 1);					//
+	L->Curve = C;												//
+	L->Min = Min;												//
+	L->Max = Max;												//
+	L->Sign = (Max > Min) ? 1 : -1;								// Key always goes up
+	for(int I = 0; I <= LAW_POINTS; I++){						//
+		L->Key[I] = L->Sign * Curve(C, Min, Max, (double)I / LAW_POINTS);	//
+	}
+	for(int I = 0; I < LAW_POINTS; I++){						//
+		L->Inv[I] = 1.0 / ((double)L->Key[I + 1] - L->Key[I]);	//
+	}
+	L->WarpLo = Warp(L, L->Key[0]);								// Buckets evenly over Warp(Key)
+	L->WarpScale = LAW_HINTS / (Warp(L, L->Key[LAW_POINTS]) - L->WarpLo);
+	for(int B = 0, I = 0; B < LAW_HINTS; B++){					// Last segment starting at or before each bucket
+		while((I < LAW_POINTS - 1)&&(Warp(L, L->Key[I + 1]) <= L->WarpLo + B / L->WarpScale)){
+			I++;												//
+		}
+		L->Hint[B] = I;											//
+	}
+	return Count++;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Law by name. Returns index, -1 if unknown.
+int ParamLaw::Find(const char *Name, int Len)
+{
+	Init();														// First use
+	for(int I = 0; I < Count; I++){								//
+		if((strlen(Laws[I].Name) == (size_t)Len)&&(strncmp(Name, Laws[I].Name, Len) == 0)){
+			return I;											//
+		}
+	}
+	return -1;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+const char *ParamLaw::Name(int Law)
+{
+	return ((Law >= 0)&&(Law < Count)) ? Laws[Law].Name : "?";	//
+}
+
+// ------------------------------------------------------------------------------------ //
+// OSC float -> units computed exactly
+float ParamLaw::Exact(int Law, float F)
+{
+	const LawTable *L = &Laws[Law];								//
+
+	F = (F < 0) ? 0 : (F > 1) ? 1 : F;							//
+	return Curve(L->Curve, L->Min, L->Max, F);					//
+}
+
+// ------------------------------------------------------------------------------------ //
+// The law itself, X = 0..1
+double ParamLaw::Curve(int C, double Min, double Max, double X)
+{
+	switch(C){
+		case LAW_LOG:											//
+			return Min * pow(Max / Min, X);						//
+		case LAW_FADER:											// Behringer's segments (Min / Max fixed)
+			if(X >= 0.5){ return X * 40 - 30; }
+			if(X >= 0.25){ return X * 80 - 50; }
+			if(X >= 0.0625){ return X * 160 - 70; }
+			return X * 480 - 90;
+		default:												// LAW_LIN
+			return Min + X * (Max - Min);						//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
@@ -0,0 +1,132 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			Parameter Law Header for RPi - Linux
+Filename:		ParamLaw.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	XR18 parameter laws. The mixer takes 0..1 floats that map to dB, Hz,
+				mS... through linear, logarithmic or segmented curves. Each law is a
+				table built once, so converting engineering units to the OSC float
+				(and back) is a few compares and one interpolation, no log / pow per
+				event.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _PARAMLAW_H
+#define _PARAMLAW_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdint.h>												// Fixed width types
+#include "config.h"												// General Configuration File
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define LAW_BITS			8									// Table segments = 2 ^ LAW_BITS
+#define LAW_POINTS			(1 << LAW_BITS)						//
+#define LAW_HINTS			(2 * LAW_POINTS)					// Search start buckets
+#define LAW_MAX				16									// Laws
+#define LAW_NAME_MAX		16									//
+
+// -------------------------------------------------------------------------------------
+// Curves
+enum LawCurve
+{
+	LAW_LIN = 1,												// Min + x (Max - Min)
+	LAW_LOG,													// Min (Max / Min) ^ x
+	LAW_FADER													// X32 / XR18 fader, 4 segments, -90 (-oo) .. +10 dB
+};
+
+// -------------------------------------------------------------------------------------
+// Law Table. Key is increasing (Units, or -Units when the law goes down, e.g. Q).
+typedef struct _lawTable{
+	char Name[LAW_NAME_MAX];									// Expression function name
+	uint8_t Curve;												// LawCurve
+	float Min, Max;												// Units at 0 / 1
+	float Sign;													// Units = Sign x Key
+	float Key[LAW_POINTS + 1];									// Key at x = i / LAW_POINTS
+	float Inv[LAW_POINTS];										// 1 / (Key[i + 1] - Key[i])
+	float WarpLo, WarpScale;									// Warp(Key) -> bucket
+	uint8_t Hint[LAW_HINTS];									// Bucket -> segment to start from
+} LawTable;
+
+// -------------------------------------------------------------------------------------
+// Define Parameter Law Class
+class ParamLaw
+{
+private:
+	static LawTable Laws[LAW_MAX];								// Built in first, then Add()ed
+	static int Count;											//
+
+	static double Curve(int C, double Min, double Max, double X);	// Exact law (Building only)
+	static inline float Warp(const LawTable *L, float K);		// Key spread evenly (Buckets)
+
+public:
+	static void Init(void);										// Build the XR18 laws (Once, before threads start)
+	static int Add(const char *Name, int C, float Min, float Max);	// Build a law. Returns its index, -1 if bad / full.
+	static int Find(const char *Name, int Len);					// Index, -1 = unknown
+	static const char *Name(int Law);							//
+
+	static inline float ToFloat(int Law, float Units);			// Units -> OSC float (Clamped 0..1)
+	static inline float ToUnits(int Law, float F);				// OSC float -> units
+	static float Exact(int Law, float F);						// OSC float -> units with log / pow (Checks, benchmarks)
+};
+
+// -------------------------------------------------------------------------------------
+// Inline Conversions
+inline float ParamLaw::Warp(const LawTable *L, float K)
+{
+	union { float F; int32_t I; } U;							//
+
+	if(L->Curve != LAW_LOG){									// Even enough already
+		return K;												//
+	}
+	U.F = K * L->Sign;											// Units (> 0). The float's bits are
+	return L->Sign * (float)U.I;								// a rough log2, going up with Key
+}
+
+inline float ParamLaw::ToFloat(int Law, float Units)
+{
+	const LawTable *L = &Laws[Law];								//
+	float K = Units * L->Sign;									//
+	int I, B;													//
+
+	if(K <= L->Key[0]){											// Below / above the range
+		return 0;												//
+	}
+	if(K >= L->Key[LAW_POINTS]){								//
+		return 1;												//
+	}
+	B = (int)((Warp(L, K) - L->WarpLo) * L->WarpScale);			// Bucket, then Key[I] <= K < Key[I + 1]
+	I = L->Hint[(B < 0) ? 0 : (B >= LAW_HINTS) ? LAW_HINTS - 1 : B];	// in a step or two
+	while(L->Key[I + 1] <= K){									//
+		I++;													//
+	}
+	while(L->Key[I] > K){										// (Rounding at a bucket edge)
+		I--;													//
+	}
+	return (I + (K - L->Key[I]) * L->Inv[I]) * (1.0f / LAW_POINTS);	//
+}
+
+inline float ParamLaw::ToUnits(int Law, float F)
+{
+	const LawTable *L = &Laws[Law];								//
+	float X;													//
+	int I;														//
+
+	if(F <= 0){													//
+		return L->Sign * L->Key[0];								//
+	}
+	if(F >= 1){													//
+		return L->Sign * L->Key[LAW_POINTS];					//
+	}
+	X = F * LAW_POINTS;											//
+	I = (int)X;													//
+	return L->Sign * (L->Key[I] + (X - I) * (L->Key[I + 1] - L->Key[I]));	//
+}
+
+// -------------------------------------------------------------------------------------
+#endif
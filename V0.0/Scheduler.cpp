@@ -0,0 +1,243 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			Scheduler for RPi - Linux
+Filename:		Scheduler.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	OSC bundles held until their time.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# At(due, bundle) from any thread: the bundle is copied into a free entry
+	  (Or added to one already waiting for that time, give or take
+	  SCHED_MERGE, one datagram per boundary) under a lock, the event loop is
+	  woken (eventfd) and arms the entry's timer for the absolute time. The
+	  timer wheel fires at most one LOOP_TICK (250 uS) late, never early, so
+	  the send lands within a fraction of a mS of the beat.
+	# Send(bundle) honours the bundle's time tag here: OSC_IMMEDIATE or a time
+	  gone goes now, a later one waits for it. The tag is sent as it is.
+	# Time tags are NTP (Seconds since 1900 . 32 bit fraction). CLK nS map to
+	  them through the offset to CLOCK_REALTIME taken at Open(). A virtual
+	  clock (Simulation) maps 0 to NTP 0, logs stay the same run to run.
+	# Report(): the error is the time sent minus the time due, measured when
+	  the timer fires (What the performer hears vs. the grid, before the
+	  network).
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <string.h>												// memset(), memcpy()
+#include <stdlib.h>												// llabs()
+#include <math.h>												// sqrt()
+#include <time.h>												// clock_gettime()
+#include <unistd.h>												// read(), write(), close()
+#include <sys/eventfd.h>										// eventfd()
+#include "Scheduler.h"											// Scheduler Class
+#include "Clock.h"												// Time source
+
+// ------------------------------------------------------------------------------------ //
+// Constructor
+Scheduler::Scheduler()
+{
+	memset(Entry, 0, sizeof(Entry));							//
+	for(int I = 0; I < SCHED_MAX; I++){							//
+		Entry[I].Timer.Fn = &Scheduler::OnTimer;				//
+		Entry[I].Timer.Arg = &Entry[I];							//
+		Entry[I].Owner = this;									//
+	}
+	pthread_mutex_init(&Lock, NULL);							//
+	WakeFd = -1;												//
+	Loop = NULL;												//
+	Osc = NULL;													//
+	Base = 0;													//
+	Sent = Merged = Dropped = 0;								//
+	ErrSum = ErrSq = 0;											//
+	ErrMax = 0;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+Scheduler::~Scheduler()
+{
+	Close();													//
+	pthread_mutex_destroy(&Lock);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Send to O, timed by L (NULL: no waiting, At() sends at once). Returns true if OK.
+bool Scheduler::Open(EventLoop *L, RPiOSC *O)
+{
+	struct timespec Ts;											//
+
+	if((O == NULL)||(WakeFd >= 0)){								//
+		return false;											//
+	}
+	Osc = O;													//
+	if(!CLK->IsVirtual()){										// CLK -> wall clock
+		clock_gettime(CLOCK_REALTIME, &Ts);						//
+		Base = (int64_t)(((NTP_UNIX_OFFSET + Ts.tv_sec) * NS_PER_SEC) + Ts.tv_nsec - CLK->Now());
+	}else{														// Virtual: from the start of the simulation
+		Base = -(int64_t)CLOCK_VIRTUAL_START;					//
+	}
+	if(L == NULL){												// Single thread (Benchmarks)
+		return true;											//
+	}
+	if((WakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0){	//
+		printf("\r\nERROR!!! Can't create scheduler eventfd...\r\n");
+		return false;											//
+	}
+	if(!L->Add(WakeFd, EPOLLIN, &Scheduler::OnWake, this)){		//
+		close(WakeFd);											//
+		WakeFd = -1;											//
+		return false;											//
+	}
+	Loop = L;													//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Drop what's waiting, stop the timers. Before the loop goes.
+void Scheduler::Close(void)
+{
+	if(Loop != NULL){											//
+		for(int I = 0; I < SCHED_MAX; I++){						//
+			Loop->StopTimer(&Entry[I].Timer);					//
+			Entry[I].State = SCHED_FREE;						//
+		}
+		Loop->Remove(WakeFd);									//
+		Loop = NULL;											//
+	}
+	if(WakeFd >= 0){											//
+		close(WakeFd);											//
+		WakeFd = -1;											//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Send B at Due (CLK nS), now if that's gone (Or there's no loop). False if nothing is free.
+bool Scheduler::At(uint64_t Due, const OSCBundle *B)
+{
+	OSCBundle Now;												//
+	SchedEntry *E = NULL;										//
+	uint64_t One = 1;											//
+
+	if(Osc == NULL){											// Not open
+		return false;											//
+	}
+	if((Loop == NULL)||(Due <= CLK->Now())){					// Due already
+		memcpy(&Now, B, sizeof(OSCBundle));						//
+		Osc->SendBundle(&Now);									//
+		return true;											//
+	}
+	pthread_mutex_lock(&Lock);									//
+	for(int I = 0; I < SCHED_MAX; I++){							// Waiting for (Nearly) the same time? One datagram
+		if((Entry[I].State != SCHED_FREE)&&(llabs((int64_t)(Entry[I].Due - Due)) <= (int64_t)SCHED_MERGE)&&RPiOSC::BundleAppend(&Entry[I].Bundle, B)){
+			Merged++;											//
+			pthread_mutex_unlock(&Lock);						//
+			return true;										//
+		}
+	}
+	for(int I = 0; (I < SCHED_MAX)&&(E == NULL); I++){			// Free entry
+		E = (Entry[I].State == SCHED_FREE) ? &Entry[I] : NULL;	//
+	}
+	if(E == NULL){												//
+		Dropped++;												//
+		pthread_mutex_unlock(&Lock);							//
+		printf("\r\nERROR!!! Scheduler full, bundle sent now\r\n");
+		memcpy(&Now, B, sizeof(OSCBundle));						// Late beats lost
+		Osc->SendBundle(&Now);									//
+		return false;											//
+	}
+	memcpy(&E->Bundle, B, sizeof(OSCBundle));					//
+	E->Due = Due;												//
+	E->State = SCHED_QUEUED;									//
+	pthread_mutex_unlock(&Lock);								//
+	if(write(WakeFd, &One, sizeof(One)) < 0){}					// Wake the event loop (Saturating: already woken)
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Send B at its time tag
+bool Scheduler::Send(const OSCBundle *B)
+{
+	uint64_t Tag = RPiOSC::BundleTimeTag(B);					//
+
+	return At((Tag <= OSC_IMMEDIATE) ? 0 : DueOf(Tag), B);		//
+}
+
+// ------------------------------------------------------------------------------------ //
+// CLK nS -> NTP time tag (Seconds << 32 | fraction)
+uint64_t Scheduler::TimeTag(uint64_t Due)
+{
+	uint64_t Ns = Due + Base;									//
+
+	return ((Ns / NS_PER_SEC) << 32) | (((Ns % NS_PER_SEC) << 32) / NS_PER_SEC);
+}
+
+// ------------------------------------------------------------------------------------ //
+// NTP time tag -> CLK nS (0 if before the clock started)
+uint64_t Scheduler::DueOf(uint64_t TimeTag)
+{
+	uint64_t Ns = ((TimeTag >> 32) * NS_PER_SEC) + (((TimeTag & 0xFFFFFFFF) * NS_PER_SEC) >> 32);
+
+	return ((int64_t)Ns > Base) ? Ns - Base : 0;				//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Bundles sent, how far from their time
+void Scheduler::Report(FILE *Out)
+{
+	pthread_mutex_lock(&Lock);									//
+	if(Sent + Dropped > 0){										//
+		fprintf(Out, "Scheduler: %llu bundles (%llu merged, %llu dropped), error mean %.1f uS, rms %.1f uS, max %.1f uS\r\n",
+			(unsigned long long)Sent, (unsigned long long)Merged, (unsigned long long)Dropped,
+			(Sent > 0) ? ErrSum / Sent / 1e3 : 0, (Sent > 0) ? sqrt(ErrSq / Sent) / 1e3 : 0, ErrMax / 1e3);
+	}
+	pthread_mutex_unlock(&Lock);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Bundles queued (Event loop): arm their timers
+void Scheduler::OnWake(int Fd, uint32_t Events, void *Arg)
+{
+	Scheduler *C = (Scheduler *)Arg;							//
+	uint64_t Cnt;												//
+
+	if(read(Fd, &Cnt, sizeof(Cnt)) < 0){}						// Consume (EAGAIN if none)
+	pthread_mutex_lock(&C->Lock);								//
+	for(int I = 0; I < SCHED_MAX; I++){							//
+		if(C->Entry[I].State == SCHED_QUEUED){					//
+			C->Loop->StartTimer(&C->Entry[I].Timer, C->Entry[I].Due);	// One-shot, absolute
+			C->Entry[I].State = SCHED_ARMED;					//
+		}
+	}
+	pthread_mutex_unlock(&C->Lock);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// An entry is due (Event loop): send it, note how late
+void Scheduler::OnTimer(void *Arg)
+{
+	SchedEntry *E = (SchedEntry *)Arg;							//
+	Scheduler *C = E->Owner;									//
+	uint64_t Now = CLK->Now();									//
+	int64_t Err;												//
+	OSCBundle B;												//
+
+	pthread_mutex_lock(&C->Lock);								// Copy out, free the entry
+	memcpy(&B, &E->Bundle, sizeof(OSCBundle));					//
+	Err = (int64_t)(Now - E->Due);								//
+	E->State = SCHED_FREE;										//
+	C->Sent++;													//
+	C->ErrSum += Err;											//
+	C->ErrSq += (double)Err * Err;								//
+	C->ErrMax = (llabs(Err) > C->ErrMax) ? llabs(Err) : C->ErrMax;	//
+	pthread_mutex_unlock(&C->Lock);								//
+	C->Osc->SendBundle(&B);										//
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
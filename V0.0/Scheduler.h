@@ -0,0 +1,90 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			Scheduler Header for RPi - Linux
+Filename:		Scheduler.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	OSC bundles sent at an absolute time. The XR18 applies a bundle as
+				soon as it arrives, whatever its time tag says, so MOLink keeps a
+				bundle until its time comes (Quantized map rules: the next beat /
+				bar) and sends it then, from an event loop timer.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _SCHEDULER_H
+#define _SCHEDULER_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdio.h>												// FILE
+#include <stdint.h>												// Fixed width types
+#include <pthread.h>											// Pending bundles lock
+#include "config.h"												// General Configuration File
+#include "OSC.h"												// OSC Class
+#include "EventLoop.h"											// Timers
+#include "Clock.h"												// NS_PER_US
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define SCHED_MAX			32									// Bundles waiting (Times, bundles for the same time merge)
+#define SCHED_MERGE			(LOOP_TICK * NS_PER_US)				// Bundles due this close go together (Same wheel tick)
+#define NTP_UNIX_OFFSET		2208988800ULL						// Seconds 1900 (NTP) to 1970 (Unix)
+
+// -------------------------------------------------------------------------------------
+// Entry states
+enum SchedState
+{
+	SCHED_FREE = 0,												//
+	SCHED_QUEUED,												// Waiting for the event loop to arm it
+	SCHED_ARMED													// Timer running
+};
+
+// -------------------------------------------------------------------------------------
+// Bundle waiting for its time
+typedef struct _schedEntry{
+	LoopTimer Timer;											// Arg = this entry
+	class Scheduler *Owner;										//
+	uint8_t State;												// SchedState
+	uint64_t Due;												// CLK nS
+	OSCBundle Bundle;											//
+} SchedEntry;
+
+// -------------------------------------------------------------------------------------
+// Define Scheduler Class
+class Scheduler
+{
+private:
+	SchedEntry Entry[SCHED_MAX];								//
+	pthread_mutex_t Lock;										// Entry states / bundles
+	int WakeFd;													// Wakes the loop to arm timers (eventfd, -1 = none)
+	EventLoop *Loop;											// NULL = sent straight away
+	RPiOSC *Osc;												//
+	int64_t Base;												// NTP nS - CLK nS
+
+	uint64_t Sent, Merged, Dropped;								// Bundles
+	double ErrSum, ErrSq;										// Sent - due (nS)
+	int64_t ErrMax;												//
+
+	static void OnWake(int Fd, uint32_t Events, void *Arg);		// Bundles queued (Event loop)
+	static void OnTimer(void *Arg);								// Entry due (Event loop)
+
+public:
+	Scheduler();												//
+	~Scheduler();												//
+
+	bool Open(EventLoop *L, RPiOSC *O);							// L = NULL, everything goes at once. Returns true if OK.
+	void Close(void);											// Drops what's waiting. Before the loop goes.
+
+	bool At(uint64_t Due, const OSCBundle *B);					// Send B at Due (CLK nS), now if gone. False if full (Any thread)
+	bool Send(const OSCBundle *B);								// At B's time tag
+	uint64_t TimeTag(uint64_t Due);								// CLK nS -> NTP time tag
+	uint64_t DueOf(uint64_t TimeTag);							// NTP time tag -> CLK nS
+
+	void Report(FILE *Out);										// Bundles sent, timing error
+};
+
+// -------------------------------------------------------------------------------------
+#endif
@@ -19,7 +19,17 @@ Notes:
 	Modify '/boot/cmdline.txt' - remove sections containing 'ttyAMA0'.
 	Modify '/etc/inittab' - comment out line 'T0:23:respawn:/sbin/getty -L ttyAMA0 115200 vt100'
 	
-	# Hack!!! Modify UART clock to support MIDI 31500 Baud rate (3MHz x 31250 / 38400)
+	# 31250 Baud is set exactly with termios2 / BOTHER (Any kernel since 2.6.x),
+	  no firmware changes needed. Remove the hack below if it was set up before.
+	  If the driver refuses BOTHER the old ASYNC_SPD_CUST divisor is tried.
+	# The port is also set ASYNC_LOW_LATENCY (Received bytes are pushed to the
+	  reader at once, not on the next tty flush) where the driver allows it, and
+	  VMIN 1 / VTIME 0: a read returns with the first byte, no inter-byte timer.
+	  The read thread waits in poll(), no spinning on FIONREAD.
+	# SerialClose() wakes the read thread through RxWakeFd and joins it before the
+	  port is closed, so the object can be deleted straight after.
+
+	# Old hack!!! Modify UART clock to support MIDI 31500 Baud rate (3MHz x 31250 / 38400)
 	* Add to '/boot/config.txt'
 	//init_uart_clock=2441406 
 	init_uart_clock=2460937 
@@ -29,6 +39,12 @@ Notes:
 	bcm2708.uart_clock=3000000
 	
 	* Command to test: 'vcgencmd measure_clock uart'
+
+	# MIDI OUT: SerialWrite() only queues (Binary, any byte incl. 0x00). The event
+	  loop hands bytes to the UART no faster than the wire takes them (3125 bytes/s),
+	  at most TX_AHEAD ahead, so the driver buffer never holds more than one message.
+	  WriteRealtime() skips the queue, a clock tick waits behind TX_AHEAD bytes at
+	  most, however much is queued. Nothing on the TX side touches the RX lock.
 // ------------------------------------------------------------------------------------ //
 */
 
@@ -39,10 +55,38 @@ Notes:
 #include <unistd.h>												// Used for UART
 #include <fcntl.h>												// Used for UART
 #include <termios.h>											// Used for UART
+#include <errno.h>												// EAGAIN
+#include <poll.h>												// poll()
 #include <sys/ioctl.h>											//
+#include <sys/eventfd.h>										// eventfd()
 #include <linux/serial.h>										//
 #include "Serial.h"												// Include Serial Class
+#include "Trace.h"												// Flight Recorder
+#include "Capture.h"											// MIDI Capture
+#include "Sim.h"												// Simulated MIDI OUT
+#include "Clock.h"												// Wire time
+
+
+// ------------------------------------------------------------------------------------ //
+// Kernel termios2 (TCGETS2 / TCSETS2). Own name, C libraries don't agree on declaring it.
+#ifndef BOTHER
+	#define BOTHER		0010000									// Speed in c_ispeed / c_ospeed
+#endif
+#define KERNEL_NCCS		19										// Kernel c_cc[] size (asm-generic)
 
+struct SerialTermios2{
+	tcflag_t c_iflag;											//
+	tcflag_t c_oflag;											//
+	tcflag_t c_cflag;											//
+	tcflag_t c_lflag;											//
+	cc_t c_line;												//
+	cc_t c_cc[KERNEL_NCCS];										//
+	speed_t c_ispeed;											// Baud (BOTHER)
+	speed_t c_ospeed;											//
+};
+
+#define SERIAL_TCGETS2	_IOR('T', 0x2A, struct SerialTermios2)	//
+#define SERIAL_TCSETS2	_IOW('T', 0x2B, struct SerialTermios2)	//
 
 // ------------------------------------------------------------------------------------ //
 // Constructor
@@ -50,7 +94,23 @@ Serial::Serial()
 {
 	Fd = -1;													// Initialise File Descriptor as error
 	OnReadEventPtr = NULL;										// Clear Callback Function Pointer
+	OnReadArgPtr = NULL;										//
+	OnReadArg = NULL;											//
+	Name[0] = 0;												// Main port
 	RxThreadActive = false;										// Init.
+	RxWakeFd = -1;												//
+	RxPtr = 0;													//
+	Capture = NULL;												//
+	pthread_mutex_init(&uartMutexes[0], NULL);					//
+	pthread_mutex_init(&uartMutexes[1], NULL);					//
+	TxHead = TxTail = 0;										// MIDI OUT queue empty
+	TxRtCnt = 0;												//
+	WireFree = 0;												//
+	Loop = NULL;												//
+	TxFd = -1;													//
+	memset(&TxTimer, 0, sizeof(TxTimer));						//
+	TxTimer.Fn = &Serial::OnTxTimer;							//
+	TxTimer.Arg = this;											//
 	
 	#ifdef DEBUG
 		printf("\r\nRPi Serial Startup...\r\n");
@@ -66,6 +126,7 @@ Serial::~Serial()
 		printf("\r\nRPi Serial Shutdown...\r\n");
 	#endif
 	
+	CloseTx();													// Stop MIDI OUT
 	SerialClose();												// Close Serial Port & Threads
 }
 
@@ -85,57 +146,26 @@ int Serial::BaudRateConstant(int BaudRate) {
 }    
 
 // ------------------------------------------------------------------------------------ //
-// Serial Port Open (With custom Baud Rate Support)
+// Serial Port Open, RPi's Onboard Serial Port
 int Serial::SerialOpen(int Baud)
+{
+	return SerialOpen(SERIAL_PORT, Baud);						//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Serial Port Open (With custom Baud Rate Support)
+int Serial::SerialOpen(const char *Port, int Baud)
 {
 	struct termios Options;										//
-	struct serial_struct SerInfo;								//
-	int Speed = 0;												//
+	int Speed = BaudRateConstant(Baud);							// 0 = not a standard rate (MIDI)
 	
 	// Open and configure serial port
-	if ((Fd = open (SERIAL_PORT, O_RDWR | O_NOCTTY | O_NDELAY | O_NONBLOCK)) == -1){
+	if ((Fd = open (Port, O_RDWR | O_NOCTTY | O_NDELAY | O_NONBLOCK)) == -1){
 		printf("\r\nERROR!!! Can't Open Serial Port...\r\n");
 		return -1;
 	}
 	
-	Speed = BaudRateConstant(Baud);
-
-	if (Speed == 0) {
-		// Custom divisor
-		SerInfo.reserved_char[0] = 0;
-		if (ioctl(Fd, TIOCGSERIAL, &SerInfo) < 0){
-			printf("\r\nERROR!!! Can't TIOCGSERIAL (1)...\r\n");
-			return -1;
-		}
-		SerInfo.flags &= ~ASYNC_SPD_MASK;
-		SerInfo.flags |= ASYNC_SPD_CUST;
-		SerInfo.custom_divisor = (SerInfo.baud_base + (Baud / 2)) / Baud;
-		if (SerInfo.custom_divisor < 1){ 
-			SerInfo.custom_divisor = 1;
-		}
-		if (ioctl(Fd, TIOCSSERIAL, &SerInfo) < 0){
-			printf("\r\nERROR!!! Can't TIOCSSERIAL...\r\n");
-			return -1;
-		}
-		if (ioctl(Fd, TIOCGSERIAL, &SerInfo) < 0){
-			printf("\r\nERROR!!! Can't TIOCGSERIAL (2)...\r\n");
-			return -1;
-		}
-		if (SerInfo.custom_divisor * Baud != SerInfo.baud_base) {
-			printf(	"Actual Baudrate is %d / %d = %f\r\n",
-					SerInfo.baud_base, SerInfo.custom_divisor,
-					(float)SerInfo.baud_base / SerInfo.custom_divisor);
-		}
-		#ifdef DEBUG
-			printf(	"Actual Baudrate is %d / %d = %f\n",
-					SerInfo.baud_base, SerInfo.custom_divisor,
-					(float)SerInfo.baud_base / SerInfo.custom_divisor);
-			printf("Baud Divisor: %i\r\n", SerInfo.custom_divisor);
-			printf("Baud Base: %i\r\n", SerInfo.baud_base);
-		#endif
-	}
-	
-	fcntl(Fd, F_SETFL, 0);
+	fcntl(Fd, F_SETFL, O_NONBLOCK);								// Writes never block (Paced by the TX queue), reads take FIONREAD bytes
 	tcgetattr(Fd, &Options);
 	cfsetispeed(&Options, Speed ?: B38400);
 	cfsetospeed(&Options, Speed ?: B38400);
@@ -148,17 +178,33 @@ int Serial::SerialOpen(int Baud)
     Options.c_cflag |= CS8 ;
     Options.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG) ;
     Options.c_oflag &= ~OPOST ;
-	Options.c_cc [VMIN]  =   0 ;
-    Options.c_cc [VTIME] = 100 ;	// Ten seconds (100 deciseconds)
+	Options.c_cc [VMIN]  =   1 ;	// Return with the first byte
+    Options.c_cc [VTIME] =   0 ;	// No inter-byte timer
 	if (tcsetattr(Fd, TCSANOW | TCSAFLUSH, &Options) != 0){
 		printf("\r\nERROR!!! Can't TCSANOW | TCSAFLUSH...\r\n");
 		return -1;
 	}
 	
+	if (Speed == 0) {											// Exact rate, else custom divisor
+		if (!SetExactBaud(Baud)) {
+			if (!SetCustomDivisor(Baud)) {
+				return -1;
+			}
+			tcsetattr(Fd, TCSANOW, &Options);					// Divisor takes effect at B38400
+		}
+	}
+	SetLowLatency();											// Where the driver allows it
+	
 	// Start Read Thread
 	if(!RxThreadActive){
+		if((RxWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0){	//
+			printf("\r\nERROR!!! Can't create UART RX eventfd...\r\n");
+			return -1;
+		}
+		__atomic_store_n(&RxThreadActive, true, __ATOMIC_RELEASE);	// Set before the thread runs (Close joins)
 		if(pthread_create(&uartThread, NULL, (void* (*)(void*))&Serial::ReadThread, this) != 0){
 			printf("\r\nERROR!!! Can't create UART RX Thread...\r\n");
+			__atomic_store_n(&RxThreadActive, false, __ATOMIC_RELEASE);	//
 			return -1;
 		}
 	}
@@ -170,11 +216,15 @@ int Serial::SerialOpen(int Baud)
 // Serial Port Close (Wrapper)
 void Serial::SerialClose(void)
 {
-	RxThreadActive = false;										// Clear Thread Active
-	usleep(1000);												// 1000us delay
-	
-	if(RxThreadActive){											// Thread active?
-		pthread_cancel(uartThread);								// Cancel thread
+	if(__atomic_load_n(&RxThreadActive, __ATOMIC_ACQUIRE)){		// Thread running?
+		uint64_t One = 1;										//
+		__atomic_store_n(&RxThreadActive, false, __ATOMIC_RELEASE);	// Clear Thread Active
+		if(write(RxWakeFd, &One, sizeof(One)) < 0){}			// Wake it out of poll() (Saturating: already woken)
+		pthread_join(uartThread, NULL);							// Gone before the port (And this object) is
+	}
+	if(RxWakeFd >= 0){											//
+		close(RxWakeFd);										//
+		RxWakeFd = -1;											//
 	}
 	
 	if(Fd >= 0){												// OK / Open?
@@ -184,13 +234,274 @@ void Serial::SerialClose(void)
 }
 
 // ------------------------------------------------------------------------------------ //
-// Serial Write
-void Serial::SerialWrite(const char *Data)
+// Set any Baud exactly with termios2 / BOTHER. Returns true if the driver took it.
+bool Serial::SetExactBaud(int Baud)
 {
-	pthread_mutex_lock(&uartMutexes[0]);						// Lock read thread
-	write (Fd, Data, strlen(Data)) ;							// Write to UART
-	usleep(1000);												// 1000us delay
-	pthread_mutex_unlock(&uartMutexes[0]) ;						// Unlock read thread
+	struct SerialTermios2 Tio;									//
+
+	if (ioctl(Fd, SERIAL_TCGETS2, &Tio) < 0){					//
+		return false;											//
+	}
+	Tio.c_cflag &= ~CBAUD;										//
+	Tio.c_cflag |= BOTHER;										//
+	Tio.c_ispeed = Baud;										//
+	Tio.c_ospeed = Baud;										//
+	if ((ioctl(Fd, SERIAL_TCSETS2, &Tio) < 0)||(ioctl(Fd, SERIAL_TCGETS2, &Tio) < 0)){	//
+		return false;											//
+	}
+	if ((int)Tio.c_ospeed != Baud) {							// Driver rounded it?
+		printf("Actual Baudrate is %u\r\n", Tio.c_ospeed);		//
+	}
+	#ifdef DEBUG
+		printf("Baud (BOTHER): %u\r\n", Tio.c_ospeed);
+	#endif
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Set Baud with the (deprecated) ASYNC_SPD_CUST divisor, used at B38400. Returns true if OK.
+bool Serial::SetCustomDivisor(int Baud)
+{
+	struct serial_struct SerInfo;								//
+
+	SerInfo.reserved_char[0] = 0;
+	if (ioctl(Fd, TIOCGSERIAL, &SerInfo) < 0){
+		printf("\r\nERROR!!! Can't TIOCGSERIAL (1)...\r\n");
+		return false;
+	}
+	SerInfo.flags &= ~ASYNC_SPD_MASK;
+	SerInfo.flags |= ASYNC_SPD_CUST;
+	SerInfo.custom_divisor = (SerInfo.baud_base + (Baud / 2)) / Baud;
+	if (SerInfo.custom_divisor < 1){ 
+		SerInfo.custom_divisor = 1;
+	}
+	if (ioctl(Fd, TIOCSSERIAL, &SerInfo) < 0){
+		printf("\r\nERROR!!! Can't TIOCSSERIAL...\r\n");
+		return false;
+	}
+	if (ioctl(Fd, TIOCGSERIAL, &SerInfo) < 0){
+		printf("\r\nERROR!!! Can't TIOCGSERIAL (2)...\r\n");
+		return false;
+	}
+	if (SerInfo.custom_divisor * Baud != SerInfo.baud_base) {
+		printf(	"Actual Baudrate is %d / %d = %f\r\n",
+				SerInfo.baud_base, SerInfo.custom_divisor,
+				(float)SerInfo.baud_base / SerInfo.custom_divisor);
+	}
+	#ifdef DEBUG
+		printf("Baud Divisor: %i\r\n", SerInfo.custom_divisor);
+		printf("Baud Base: %i\r\n", SerInfo.baud_base);
+	#endif
+	return true;
+}
+
+// ------------------------------------------------------------------------------------ //
+// ASYNC_LOW_LATENCY, received bytes go to the reader at once. Not all drivers have it.
+void Serial::SetLowLatency(void)
+{
+	struct serial_struct SerInfo;								//
+
+	if (ioctl(Fd, TIOCGSERIAL, &SerInfo) < 0){					// Not a serial driver (pty, USB...)?
+		return;													//
+	}
+	SerInfo.flags |= ASYNC_LOW_LATENCY;							//
+	if (ioctl(Fd, TIOCSSERIAL, &SerInfo) < 0){					//
+		#ifdef DEBUG
+			printf("No ASYNC_LOW_LATENCY on this port\r\n");
+		#endif
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Queue Len bytes for MIDI OUT (Any thread, never blocks). Returns false if the queue is full.
+bool Serial::SerialWrite(const char *Data, int Len)
+{
+	uint32_t Used;												//
+	bool Kick;													//
+
+	if((Len <= 0)||(TxFd < 0)){									// Nothing / not started?
+		return false;											//
+	}
+	pthread_mutex_lock(&uartMutexes[1]);						// Lock TX queue
+	Used = TxHead - TxTail;										//
+	if(Used + Len > TX_BUFFER_SIZE){							// No room? Drop the whole message
+		pthread_mutex_unlock(&uartMutexes[1]);					//
+		TRACE(TRC_MIDI_TX_OVF, Len, Used);						//
+		return false;											//
+	}
+	for(int I = 0; I < Len; I++){								//
+		TxData[(TxHead + I) & (TX_BUFFER_SIZE - 1)] = (uint8_t)Data[I];	//
+	}
+	TxHead += Len;												//
+	Kick = (Used == 0);											// Was idle? Loop isn't waiting on the timer
+	pthread_mutex_unlock(&uartMutexes[1]);						// Unlock TX queue
+
+	if(Kick){													// Wake the event loop
+		uint64_t One = 1;										//
+		if(write(TxFd, &One, sizeof(One)) < 0){}				// (Counter saturating: already kicked)
+	}
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Write one system realtime byte (0xF8-0xFF) ahead of everything queued, at once.
+// Realtime bytes may go between the bytes of any other message.
+void Serial::WriteRealtime(uint8_t Byte)
+{
+	uint64_t Now = CLK->Now();									//
+	bool Kick = false;											//
+
+	pthread_mutex_lock(&uartMutexes[1]);						// Lock TX queue
+	if((TxRtCnt == 0)&&(TxOut(&Byte, 1) == 1)){					// Straight out?
+		WireFree = ((WireFree > Now) ? WireFree : Now) + MIDI_BYTE_NS;	//
+	}else if(TxRtCnt < TX_RT_MAX){								// UART full, first out when it has room
+		TxRt[TxRtCnt++] = Byte;									//
+		Kick = (TxFd >= 0);										//
+	}
+	pthread_mutex_unlock(&uartMutexes[1]);						// Unlock TX queue
+
+	if(Kick){													// Wake the event loop
+		uint64_t One = 1;										//
+		if(write(TxFd, &One, sizeof(One)) < 0){}				// (Counter saturating: already kicked)
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Drain MIDI OUT from event loop L. Returns true if OK.
+bool Serial::OpenTx(EventLoop *L)
+{
+	if((L == NULL)||(TxFd >= 0)){								//
+		return false;											//
+	}
+	if((TxFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0){	//
+		printf("\r\nERROR!!! Can't create MIDI OUT eventfd...\r\n");
+		return false;											//
+	}
+	if(!L->Add(TxFd, EPOLLIN, &Serial::OnTxKick, this)){		//
+		close(TxFd);											//
+		TxFd = -1;												//
+		return false;											//
+	}
+	Loop = L;													//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Stop MIDI OUT (Anything still queued is dropped). Before the loop goes.
+void Serial::CloseTx(void)
+{
+	if(Loop != NULL){											//
+		Loop->StopTimer(&TxTimer);								//
+		Loop->Remove(TxFd);										//
+		Loop = NULL;											//
+	}
+	if(TxFd >= 0){												//
+		close(TxFd);											//
+		TxFd = -1;												//
+	}
+	pthread_mutex_lock(&uartMutexes[1]);						// Lock TX queue
+	TxTail = TxHead;											//
+	TxRtCnt = 0;												//
+	pthread_mutex_unlock(&uartMutexes[1]);						// Unlock TX queue
+}
+
+// ------------------------------------------------------------------------------------ //
+// Bytes queued, not handed to the UART yet
+int Serial::TxPending(void)
+{
+	int Used;													//
+
+	pthread_mutex_lock(&uartMutexes[1]);						// Lock TX queue
+	Used = (int)(TxHead - TxTail) + TxRtCnt;					//
+	pthread_mutex_unlock(&uartMutexes[1]);						// Unlock TX queue
+	return Used;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Hand Len bytes to the UART (Simulation: the log). Returns bytes taken, 0 if it's full.
+int Serial::TxOut(const uint8_t *Data, int Len)
+{
+	int Ret = Len;												// No port (Replay) = sent
+
+	if(SIM != NULL){											// Simulation?
+		Simulator::MIDISink(Name, Data, Len);					// Log it
+	}else if(Fd >= 0){											// Open?
+		if((Ret = write(Fd, Data, Len)) < 0){					// Write to UART
+			Ret = ((errno == EAGAIN)||(errno == EINTR)) ? 0 : Len;	// Full? Try again. Broken? Drop
+		}
+	}
+	if(Ret > 0){												//
+		TRACE(TRC_MIDI_TX, Ret, Data[0]);						//
+	}
+	return Ret;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Send what the wire has room for (Realtime first) and set the timer for the rest.
+// Event loop, TX lock held.
+void Serial::Drain(void)
+{
+	uint64_t Now = CLK->Now();									//
+	int Room, Len, Sent;										//
+
+	if(WireFree < Now){											// Wire idle
+		WireFree = Now;											//
+	}
+	while(TxRtCnt > 0){											// Realtime waiting? Regardless of room
+		if(TxOut(TxRt, 1) != 1){								// Still full
+			break;												//
+		}
+		memmove(TxRt, &TxRt[1], --TxRtCnt);						//
+		WireFree += MIDI_BYTE_NS;								//
+	}
+	while((TxRtCnt == 0)&&(TxHead != TxTail)){					// Queue, up to TX_AHEAD on the wire
+		Room = (int)(((TX_AHEAD * MIDI_BYTE_NS) - (int64_t)(WireFree - Now)) / MIDI_BYTE_NS);	//
+		if(Room <= 0){											//
+			break;												//
+		}
+		Len = TX_BUFFER_SIZE - (TxTail & (TX_BUFFER_SIZE - 1));	// Up to the wrap
+		if(Len > (int)(TxHead - TxTail)){						//
+			Len = TxHead - TxTail;								//
+		}
+		if(Len > Room){											//
+			Len = Room;											//
+		}
+		if((Sent = TxOut(&TxData[TxTail & (TX_BUFFER_SIZE - 1)], Len)) <= 0){	// UART full?
+			break;												//
+		}
+		TxTail += Sent;											//
+		WireFree += (uint64_t)Sent * MIDI_BYTE_NS;				//
+	}
+	if((TxRtCnt > 0)||(TxHead != TxTail)){						// More? When a byte has room (Or the UART, next byte time)
+		uint64_t Due = WireFree - ((TX_AHEAD - 1) * MIDI_BYTE_NS);	//
+		Loop->StartTimer(&TxTimer, (Due > Now) ? Due : Now + MIDI_BYTE_NS);	//
+	}else{
+		Loop->StopTimer(&TxTimer);								//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI OUT bytes queued (Event loop)
+void Serial::OnTxKick(int Fd, uint32_t Events, void *Arg)
+{
+	Serial *C = (Serial *)Arg;									//
+	uint64_t Cnt;												//
+
+	if(read(Fd, &Cnt, sizeof(Cnt)) < 0){}						// Consume (EAGAIN if none)
+	pthread_mutex_lock(&C->uartMutexes[1]);						// Lock TX queue
+	C->Drain();													//
+	pthread_mutex_unlock(&C->uartMutexes[1]);					// Unlock TX queue
+}
+
+// ------------------------------------------------------------------------------------ //
+// Room on the wire for more (Event loop timer)
+void Serial::OnTxTimer(void *Arg)
+{
+	Serial *C = (Serial *)Arg;									//
+
+	pthread_mutex_lock(&C->uartMutexes[1]);						// Lock TX queue
+	C->Drain();													//
+	pthread_mutex_unlock(&C->uartMutexes[1]);					// Unlock TX queue
 }
 
 // ------------------------------------------------------------------------------------ //
@@ -208,20 +519,64 @@ int Serial::SerialRead(char *Data)
 	return RxSize;												//
 }
 
+// ------------------------------------------------------------------------------------ //
+// Inject data as if it was read from the UART (Replay). Calls the read event.
+void Serial::Inject(const char *Data, int Len)
+{
+	pthread_mutex_lock(&uartMutexes[0]);						// Lock read thread
+	if(RxPtr + Len <= RX_BUFFER_SIZE){							// Buffer OK?
+		memcpy(&RxData[RxPtr], Data, Len);						// Save
+		RxPtr += Len;											// Update byte counter
+		OnReadEvent();											// Call On Serial Read Event
+	}
+	pthread_mutex_unlock(&uartMutexes[0]);						// Unlock read thread
+}
+
+// ------------------------------------------------------------------------------------ //
+// Record everything read from the UART to Cap (NULL to stop)
+void Serial::SetCapture(MIDICapture *Cap)
+{
+	pthread_mutex_lock(&uartMutexes[0]);						// Lock read thread
+	Capture = Cap;												//
+	pthread_mutex_unlock(&uartMutexes[0]);						// Unlock read thread
+}
+
 // ------------------------------------------------------------------------------------ //
 // Set On Read Event Function Pointer (OnReadEventPtr) / Set Callback Function
 void Serial::SetOnReadEvent(void *(*FnPtr)(void))
 {
 	if(FnPtr != NULL){
 		OnReadEventPtr = FnPtr;
+		OnReadArgPtr = NULL;
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Set On Read Event with an argument, Fn(Arg) (Replaces the one above)
+void Serial::SetOnReadEvent(void *(*FnPtr)(void *), void *Arg)
+{
+	if(FnPtr != NULL){
+		OnReadArg = Arg;
+		OnReadArgPtr = FnPtr;
+		OnReadEventPtr = NULL;
 	}
 }
 
+// ------------------------------------------------------------------------------------ //
+// Port name, tags MIDI OUT in the simulation log
+void Serial::SetName(const char *PortName)
+{
+	strncpy(Name, PortName, SERIAL_NAME_MAX - 1);				//
+	Name[SERIAL_NAME_MAX - 1] = 0;								//
+}
+
 // ------------------------------------------------------------------------------------ //
 // On Serial Read Event (Fixed)
 void Serial::OnReadEvent(void)
 {
-	if(OnReadEventPtr != NULL){									// Callback function set?
+	if(OnReadArgPtr != NULL){									// Callback with argument?
+		OnReadArgPtr(OnReadArg);								//
+	}else if(OnReadEventPtr != NULL){							// Callback function set?
 		OnReadEventPtr();										// Call, Callback function here
 	}
 }
@@ -233,17 +588,33 @@ void *Serial::ReadThread(Serial *C)
 	char Buff[(RX_BUFFER_SIZE / 4) + 1];						// 
 	int Bytes;													//
 	
-	C->RxThreadActive = true;									// Set Thread Active
+	if(TRC != NULL){ TRC->SetThreadName("UART RX"); }			// Claim trace ring
 	do{
+		struct pollfd Pfd[2] = {{C->Fd, POLLIN, 0}, {C->RxWakeFd, POLLIN, 0}};	// Sleep until data or SerialClose()
+		if ((poll(Pfd, 2, -1) <= 0)||(Pfd[1].revents != 0)){	// Interrupted / closing?
+			continue;											// (Loop test exits)
+		}
 		if ((ioctl(C->Fd, FIONREAD, &Bytes) != -1)&&(Bytes > 0)){	// Any Data present?
+			if(Bytes > RX_BUFFER_SIZE / 4){						// Rest on the next pass
+				Bytes = RX_BUFFER_SIZE / 4;						//
+			}
 			pthread_mutex_lock(&C->uartMutexes[0]);				// Lock thread
 			if(read(C->Fd, Buff, Bytes) == Bytes){				// Read OK?
+				if(TRC != NULL){								// Tracing?
+					uint32_t Raw[2] = {0, 0};					//
+					memcpy(Raw, Buff, (Bytes < 8) ? Bytes : 8);	// First 8 bytes
+					TRC->Log(TRC_MIDI_RX, Bytes, Raw[0], Raw[1]);	//
+				}
+				if(C->Capture != NULL){							// Capturing?
+					C->Capture->Record(Buff, Bytes);			// Save with ingest time
+				}
 				if(C->RxPtr < RX_BUFFER_SIZE){					// Buffer OK?
 					memcpy(&C->RxData[C->RxPtr], Buff, Bytes);	// Save 
 					C->RxPtr += Bytes;							// Update byte counter
 					C->OnReadEvent();							// Call On Serial Read Event
 				}else{											// Buffer Full?
 					// Reset / Flush buffer
+					TRACE(TRC_MIDI_OVF, C->RxPtr);				//
 					tcflush (C->Fd, TCIOFLUSH);					//
 					C->RxPtr = 0;								//
 					memset(C->RxData, 0x00, RX_BUFFER_SIZE);	//
@@ -251,6 +622,8 @@ void *Serial::ReadThread(Serial *C)
 			}
 			pthread_mutex_unlock(&C->uartMutexes[0]) ;			// Unlock thread
 		}
-	}while(C->RxThreadActive);									// Loop while active
+	}while(__atomic_load_n(&C->RxThreadActive, __ATOMIC_ACQUIRE));	// Loop while active
+	
+	return NULL;
 }
 // ------------------------------------------------------------------------------------ //
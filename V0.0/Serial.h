@@ -6,7 +6,8 @@ Author:			Paul Vilas-Boas
 Version:		0.0
 Date:			22/05/2015
 
-Description:	Interfaces to the UART (RPi's On-Board UART).
+Description:	Interfaces to the UART (RPi's On-Board UART). MIDI OUT goes through a
+				queue paced to the wire rate and drained by the event loop.
 	
 // -------------------------------------------------------------------------------------
 */
@@ -17,13 +18,22 @@ Description:	Interfaces to the UART (RPi's On-Board UART).
 // -------------------------------------------------------------------------------------
 // Includes
 #include "config.h"												// General Configuration File
+#include "EventLoop.h"											// MIDI OUT pacing timer
+#include <stdint.h>												// Fixed width types
 #include <pthread.h>											// Threads
 
+class MIDICapture;												// Capture Class (Capture.h)
+
 // -------------------------------------------------------------------------------------
 // Constants
 #define MIDI_BAUD		31250									// MIDI Baud Rate
 #define RX_BUFFER_SIZE	4096									// UART Receive Buffer Size
 #define SERIAL_PORT		"/dev/ttyAMA0"							// RPi's Onboard Serial Port
+#define MIDI_BYTE_NS	320000									// One byte on the wire in nS (10 bits at MIDI_BAUD, 3125 bytes/s)
+#define SERIAL_NAME_MAX	16										// Port name length
+#define TX_BUFFER_SIZE	4096									// MIDI OUT queue (Power of 2)
+#define TX_AHEAD		3										// Bytes handed to the UART ahead of the wire (Realtime waits behind at most this)
+#define TX_RT_MAX		16										// Realtime bytes waiting for UART space
 
 // -------------------------------------------------------------------------------------
 // Define Serial Class
@@ -31,26 +41,56 @@ class Serial
 {
 private:
 	int Fd;														//
-	pthread_mutex_t uartMutexes[2];								//
+	pthread_mutex_t uartMutexes[2];								// [0] RX, [1] TX queue
 	pthread_t uartThread;										//
-	bool RxThreadActive;										//
+	bool RxThreadActive;										// Set from open to close (Joined there)
+	int RxWakeFd;												// Wakes the read thread to exit (eventfd, -1 = none)
 	int RxPtr;													//
 	char RxData[RX_BUFFER_SIZE + 1];							//
 	void *(*OnReadEventPtr)(void);								//
+	void *(*OnReadArgPtr)(void *);								// Callback with an argument (Several ports)
+	void *OnReadArg;											//
+	char Name[SERIAL_NAME_MAX];									// Port name (Simulation log, "" = main)
+	MIDICapture *Capture;										// Record incoming chunks (NULL = off)
+
+	uint8_t TxData[TX_BUFFER_SIZE];								// MIDI OUT queue
+	uint32_t TxHead, TxTail;									// Free running, masked on use
+	uint8_t TxRt[TX_RT_MAX];									// Realtime bytes the UART had no room for
+	int TxRtCnt;												//
+	uint64_t WireFree;											// Everything handed to the UART is on the wire by then (CLK nS)
+	EventLoop *Loop;											// Drains the queue (NULL = not started)
+	int TxFd;													// Wakes the loop for new bytes (eventfd, -1 = none)
+	LoopTimer TxTimer;											// Room for the next byte
 	
 	static void *ReadThread(Serial *);							//
+	bool SetExactBaud(int Baud);								// termios2 / BOTHER
+	bool SetCustomDivisor(int Baud);							// ASYNC_SPD_CUST (Deprecated, fallback)
+	void SetLowLatency(void);									// ASYNC_LOW_LATENCY if the driver has it
+	int TxOut(const uint8_t *Data, int Len);					// To the UART (Or simulation log), returns bytes taken
+	void Drain(void);											// Send what the wire has room for, TX lock held
+	static void OnTxKick(int Fd, uint32_t Events, void *Arg);	// Bytes queued (Event loop)
+	static void OnTxTimer(void *Arg);							// Room for more (Event loop)
 	
 public:
 	Serial();													//
 	~Serial();													//
 	
 	int BaudRateConstant(int BaudRate);							//
-	int SerialOpen(int Baud);									//
+	int SerialOpen(int Baud);									// Open SERIAL_PORT
+	int SerialOpen(const char *Port, int Baud);					// Open any tty (USB MIDI, pty...)
 	void SerialClose(void);										//
-	void SerialWrite(const char *Data);							//
+	bool SerialWrite(const char *Data, int Len);				// Queue MIDI OUT (Never blocks). False if full
+	void WriteRealtime(uint8_t Byte);							// System realtime byte (Clock...), ahead of the queue
+	bool OpenTx(EventLoop *L);									// Drain MIDI OUT from L. Returns true if OK.
+	void CloseTx(void);											//
+	int TxPending(void);										// Bytes queued, not yet handed to the UART
 	int SerialRead(char *Data);									//
+	void Inject(const char *Data, int Len);						// Deliver data as if read from the UART
+	void SetCapture(MIDICapture *Cap);							//
 
 	void SetOnReadEvent(void *(*FnPtr)(void));					//
+	void SetOnReadEvent(void *(*FnPtr)(void *), void *Arg);		// Fn(Arg)
+	void SetName(const char *PortName);							//
 	void OnReadEvent(void);										//
 };
 
@@ -0,0 +1,259 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			Simulator for Linux
+Filename:		Sim.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Stand-ins for the hardware when MOLink runs on a VirtualClock.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Run - './MOLink -v -p session.cap [-g switches.txt] [-o sim.log] [-t seconds]'
+	  '-v' swaps the real clock for a VirtualClock, the capture is replayed in
+	  virtual time, foot switches follow the GPIO script and OSC / MIDI OUT go
+	  to the log.
+	  Two runs with the same inputs produce identical logs.
+	# GPIO script example (FS3 tapped twice, 500mS apart):
+		1000 2 0
+		1050 2 1
+		1500 2 0
+		1550 2 1
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <stdio.h>												// printf()
+#include <stdlib.h>												// qsort()
+#include <string.h>												// strlen()
+#include <stdarg.h>												// va_list
+#include "Sim.h"												// Simulator Class
+#include "Clock.h"												// Virtual time
+
+// ------------------------------------------------------------------------------------ //
+// Globals
+Simulator *SIM = NULL;											// Global Simulator
+
+// ------------------------------------------------------------------------------------ //
+// Sort script by time, keep file order otherwise
+static int CompareEvent(const void *A, const void *B)
+{
+	const SimEvent *EA = (const SimEvent *)A;					//
+	const SimEvent *EB = (const SimEvent *)B;					//
+
+	if(EA->Time != EB->Time){									//
+		return (EA->Time < EB->Time) ? -1 : 1;					//
+	}
+	return (EA->Seq > EB->Seq) - (EA->Seq < EB->Seq);			// qsort() isn't stable
+}
+
+// ------------------------------------------------------------------------------------ //
+// Constructor
+Simulator::Simulator()
+{
+	Log = stdout;												//
+	Events = NULL;												//
+	EventCount = 0;												//
+	EventPtr = 0;												//
+	memset(Pins, 0, sizeof(Pins));								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+Simulator::~Simulator()
+{
+	Close();													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Open Log (NULL = stdout)
+bool Simulator::Open(const char *LogFile)
+{
+	if(LogFile != NULL){										// Log to file?
+		if((Log = fopen(LogFile, "w")) == NULL){				//
+			printf("\r\nERROR!!! Can't Open Simulation Log...\r\n");
+			Log = stdout;										//
+			return false;										//
+		}
+	}
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Load GPIO Script
+bool Simulator::LoadGPIO(const char *Script)
+{
+	FILE *FPtr;													//
+	char FLine[256];											//
+	double Ms;													//
+	int Pin, Level;												//
+	int LineNo = 0;												//
+
+	if((FPtr = fopen(Script, "r")) == NULL){					// Open script
+		printf("\r\nERROR!!! Can't Open GPIO Script...\r\n");
+		return false;
+	}
+
+	delete []Events;											//
+	Events = new SimEvent[SIM_EVENTS_MAX];						//
+	EventCount = 0;												//
+	EventPtr = 0;												//
+	while((fgets(FLine, sizeof(FLine), FPtr) != NULL)&&(EventCount < SIM_EVENTS_MAX)){
+		LineNo++;												//
+		if(FLine[0] == '#'){									// Comment?
+			continue;											//
+		}
+		if((sscanf(FLine, "%lf %d %d", &Ms, &Pin, &Level) == 3)&&(Pin >= 0)&&(Pin < SIM_PINS)){
+			Events[EventCount].Time = CLOCK_VIRTUAL_START + (uint64_t)(Ms * NS_PER_MS);
+			Events[EventCount].Pin = Pin;						//
+			Events[EventCount].Level = Level ? 1 : 0;			//
+			Events[EventCount].Seq = LineNo;					//
+			EventCount++;										//
+		}
+	}
+	fclose(FPtr);												//
+
+	qsort(Events, EventCount, sizeof(SimEvent), CompareEvent);	//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Close Log
+void Simulator::Close(void)
+{
+	if((Log != NULL)&&(Log != stdout)){							//
+		fclose(Log);											//
+	}
+	Log = stdout;												//
+	delete []Events;											//
+	Events = NULL;												//
+	EventCount = 0;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Apply script events due by now
+void Simulator::ApplyEvents(void)
+{
+	uint64_t Time = CLK->Now();									//
+
+	while((EventPtr < EventCount)&&(Events[EventPtr].Time <= Time)){
+		Pins[Events[EventPtr].Pin] = Events[EventPtr].Level;	//
+		EventPtr++;												//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// GPIO Input
+int Simulator::DigitalRead(int Pin)
+{
+	if((Pin < 0)||(Pin >= SIM_PINS)){							//
+		return -1;												//
+	}
+	ApplyEvents();												//
+	return Pins[Pin];											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// GPIO Output, logs changes
+void Simulator::DigitalWrite(int Pin, int Level)
+{
+	if((Pin < 0)||(Pin >= SIM_PINS)){							//
+		return;													//
+	}
+	Level = Level ? 1 : 0;										//
+	if(Pins[Pin] != Level){										// Edge?
+		Pins[Pin] = Level;										//
+		Print("GPIO %d %d", Pin, Level);						//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Input with pull-up idles high (until the script says otherwise)
+void Simulator::PullUp(int Pin)
+{
+	if((Pin >= 0)&&(Pin < SIM_PINS)){							//
+		Pins[Pin] = 1;											//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// OSC stand-in. Decodes the datagram to one log line.
+void Simulator::OSCSink(const char *Data, int Len)
+{
+	char Line[512];												//
+	int Ofs, Tag, LPtr;											//
+	unsigned int Raw;											//
+	float F;													//
+
+	if(SIM == NULL){											//
+		return;													//
+	}
+	if((Len >= 16)&&(memcmp(Data, "#bundle", 8) == 0)){			// Bundle? Time tag, then each message
+		Raw = ((unsigned char)Data[12] << 24)|((unsigned char)Data[13] << 16)|((unsigned char)Data[14] << 8)|(unsigned char)Data[15];
+		SIM->Print("OSC #bundle %08x%08x", ((unsigned char)Data[8] << 24)|((unsigned char)Data[9] << 16)|
+			((unsigned char)Data[10] << 8)|(unsigned char)Data[11], Raw);	//
+		for(Ofs = 16; Ofs + 4 <= Len; Ofs += 4 + Tag){			//
+			Tag = ((unsigned char)Data[Ofs + 2] << 8)|(unsigned char)Data[Ofs + 3];	// Element size
+			if((Tag <= 0)||(Ofs + 4 + Tag > Len)){				//
+				break;											//
+			}
+			OSCSink(&Data[Ofs + 4], Tag);						//
+		}
+		return;													//
+	}
+
+	LPtr = snprintf(Line, sizeof(Line), "OSC %.*s", (int)strnlen(Data, Len), Data);
+	Ofs = ((strnlen(Data, Len) / 4) + 1) * 4;					// Type tag
+	if((Ofs < Len)&&(Data[Ofs] == ',')){						// Typed?
+		Tag = Ofs + 1;											//
+		Ofs = ((strnlen(&Data[Ofs], Len - Ofs) / 4) + 1) * 4 + Ofs;	// Arguments
+		for(; (Tag < Len)&&(Data[Tag] != 0)&&(Ofs + 4 <= Len)&&(LPtr < (int)sizeof(Line) - 32); Tag++, Ofs += 4){
+			Raw = ((unsigned char)Data[Ofs] << 24)|((unsigned char)Data[Ofs + 1] << 16)|
+				  ((unsigned char)Data[Ofs + 2] << 8)|(unsigned char)Data[Ofs + 3];
+			if(Data[Tag] == 'f'){								// Float?
+				memcpy(&F, &Raw, sizeof(F));					//
+				LPtr += snprintf(&Line[LPtr], sizeof(Line) - LPtr, " f %.6f", F);
+			}else{												// Int
+				LPtr += snprintf(&Line[LPtr], sizeof(Line) - LPtr, " %c %d", Data[Tag], (int)Raw);
+			}
+		}
+	}
+	SIM->Print("%s", Line);										//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI OUT stand-in, logs 'MIDI F8 ...' (hex bytes), 'MIDI:<port> ...' for other ports
+void Simulator::MIDISink(const char *Port, const uint8_t *Data, int Len)
+{
+	char Line[512];												//
+	int LPtr;													//
+
+	if(SIM == NULL){											//
+		return;													//
+	}
+	LPtr = snprintf(Line, sizeof(Line), ((Port != NULL)&&(Port[0] != 0)) ? "MIDI:%s" : "MIDI", Port);	//
+	for(int I = 0; (I < Len)&&(LPtr < (int)sizeof(Line) - 4); I++){	//
+		LPtr += snprintf(&Line[LPtr], sizeof(Line) - LPtr, " %02X", Data[I]);	//
+	}
+	SIM->Print("%s", Line);										//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Print log line '[seconds.microseconds] text'
+void Simulator::Print(const char *Fmt, ...)
+{
+	va_list Args;												//
+	uint64_t Time = CLK->Now();									//
+
+	Time -= CLOCK_VIRTUAL_START;								// From the start of the simulation
+	fprintf(Log, "[%6llu.%06llu] ", (unsigned long long)(Time / NS_PER_SEC), (unsigned long long)((Time % NS_PER_SEC) / NS_PER_US));
+	va_start(Args, Fmt);										//
+	vfprintf(Log, Fmt, Args);									//
+	va_end(Args);												//
+	fprintf(Log, "\n");											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
@@ -0,0 +1,73 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			Simulator Header for Linux
+Filename:		Sim.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Stand-ins for the hardware when MOLink runs on a VirtualClock.
+				GPIO inputs follow a script, GPIO outputs, OSC datagrams and MIDI
+				OUT bytes are written to a log stamped with virtual time.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _SIM_H
+#define _SIM_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdio.h>												// FILE
+#include <stdint.h>												// Fixed width types
+#include "config.h"												// General Configuration File
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define SIM_PINS			64									// Simulated GPIO pins (wiringPi numbers)
+#define SIM_EVENTS_MAX		65536								// GPIO script events
+
+// -------------------------------------------------------------------------------------
+// GPIO Script Event. Script lines: '<time mS> <pin> <level>', '#' comments.
+typedef struct _simEvent{
+	uint64_t Time;												// Virtual time (nS)
+	int Pin;													// wiringPi pin
+	int Level;													// 0 or 1
+	int Seq;													// Script line (Same time: file order)
+} SimEvent;
+
+// -------------------------------------------------------------------------------------
+// Define Simulator Class
+class Simulator
+{
+private:
+	FILE *Log;													// Output log
+	SimEvent *Events;											// GPIO script (time order)
+	int EventCount;												//
+	int EventPtr;												// Next event to apply
+	int Pins[SIM_PINS];											// Pin levels
+
+	void ApplyEvents(void);										// Apply script up to now
+
+public:
+	Simulator();												//
+	~Simulator();												//
+
+	bool Open(const char *LogFile);								// NULL = stdout
+	bool LoadGPIO(const char *Script);							//
+	void Close(void);											//
+
+	int DigitalRead(int Pin);									// GPIO input stand-in
+	void DigitalWrite(int Pin, int Level);						// GPIO output stand-in (Logs edges)
+	void PullUp(int Pin);										// Idle level of an input
+	static void OSCSink(const char *Data, int Len);				// UDP stand-in (Logs OSC)
+	static void MIDISink(const char *Port, const uint8_t *Data, int Len);	// MIDI OUT stand-in (Logs bytes)
+	void Print(const char *Fmt, ...);							// Log line stamped with virtual time
+};
+
+// -------------------------------------------------------------------------------------
+// Global Simulator (NULL when running on hardware)
+extern Simulator *SIM;											//
+
+// -------------------------------------------------------------------------------------
+#endif
@@ -0,0 +1,562 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			Tempo for Linux
+Filename:		Tempo.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	MIDI clock tempo estimator, beat phase tracker, published tempo and transport.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Every (BPM_SAMPLE + 2) ticks the elapsed time is measured and converted:
+	  BPM = 60s * Ticks / (24 * Elapsed). With BPM_SAMPLE 10 that is every half beat.
+	# Times come from the caller, so the tracker works the same on real or virtual
+	  time and has no shared state with anything else.
+	# BeatPhase follows every tick with an alpha-beta filter: the next tick is
+	  predicted from the filtered last tick and period, the error moves the phase
+	  by BEAT_PHASE_GAIN and the period by BEAT_PERIOD_GAIN. UART / USB jitter is
+	  averaged out but the phase never drifts, a clock running a little fast or
+	  slow is followed by the period term. An error over half a tick (Tempo jump,
+	  clock stopped and restarted) starts again from that tick.
+	# TempoState is a seqlock: writers (MIDI IN, foot switches) take a mutex
+	  among themselves, readers (LED, OSC) copy the value and retry if the
+	  sequence moved or was odd, so they never block a writer or each other.
+	  A change also bumps an eventfd, the event loop sends the new tempo as
+	  soon as it is readable, whatever the LED is doing.
+	# Tick 0 is the first tick after a MIDI Start, otherwise the first one seen
+	  (After a gap of 4 ticks or more).
+	  Downbeats are extrapolated from the filtered state, so the LED can be
+	  scheduled on absolute time ahead of the tick that marks it.
+	# Transport follows Start / Stop / Continue and the Song Position Pointer:
+	  Start plays from position 0, Stop keeps the position, SPP (1/16 steps,
+	  SPP_TICKS clocks each) moves it, Continue plays on from it. Clocks move
+	  it only while playing. It is published like TempoState (Seqlock, one
+	  writer, the MIDI IN thread), and on every Start / Continue MOLink puts
+	  the beat phase on the song position (BeatPhase::Locate()), so the bar
+	  grid (Beat LED, quantized rules) stays on the looper's bars across any
+	  stop / start, whatever clocks came in between.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <math.h>												// roundf(), llround(), sqrt()
+#include <stdlib.h>												// llabs()
+#include <unistd.h>												// read(), write(), close()
+#include <sys/eventfd.h>										// eventfd()
+#include "Tempo.h"												// Tempo Classes
+#include "Trace.h"												// Flight Recorder
+
+// ------------------------------------------------------------------------------------ //
+// Constructor
+TempoTracker::TempoTracker(int Sample)
+{
+	Ticks = Sample + 2;											// Ticks per measurement
+	Reset();													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Reset (Next tick starts a new measurement)
+void TempoTracker::Reset(void)
+{
+	Cnt = 0;													//
+	Last = 0;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI clock tick at time Now (nS). Returns BPM when a measurement completes, else 0.
+int TempoTracker::Tick(uint64_t Now, int64_t *Period)
+{
+	int64_t Delta;												//
+
+	if(Last == 0){												// First tick?
+		Last = Now;												//
+		Cnt = 1;												//
+		return 0;												//
+	}
+	if(Cnt < Ticks){											// Keep counting
+		Cnt++;													//
+		return 0;												//
+	}
+
+	Delta = (int64_t)(Now - Last);								// Ticks x tick period
+	Last = Now;													//
+	Cnt = 1;													//
+	if(Period != 0){											//
+		*Period = Delta;										//
+	}
+	if(Delta <= 0){												//
+		return 0;												//
+	}
+	return (int)roundf((float)((60.0e9 * Ticks) / (MIDI_PPQN * (double)Delta)));	// Round off to nearest BPM
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
+// Beat Phase
+// ------------------------------------------------------------------------------------ //
+// Constructor
+BeatPhase::BeatPhase()
+{
+	pthread_mutex_init(&Mutex, NULL);							//
+	Valid = false;												//
+	Heard = false;												//
+	Last = 0;													//
+	LastRaw = 0;												//
+	TickNs = 0;													//
+	Count = MIDI_PPQN - 1;										// First tick is a downbeat
+	Bar = BEAT_BAR - 1;											// of the first beat
+	Beats = 0;													//
+	ErrSum = ErrSq = 0;											//
+	ErrMax = 0;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+BeatPhase::~BeatPhase()
+{
+	pthread_mutex_destroy(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI clock tick arrived at Now (nS)
+void BeatPhase::Tick(uint64_t Now)
+{
+	pthread_mutex_lock(&Mutex);									//
+	if(!Valid){													// Nothing to predict from yet
+		if(Heard &&(Now > LastRaw)){							// Period from two ticks
+			TickNs = (double)(Now - LastRaw);					//
+			Valid = true;										//
+		}
+		Last = Now;												//
+	}else{
+		uint64_t Pred = Last + llround(TickNs);					// Predicted arrival
+		int64_t Err = (int64_t)(Now - Pred);					//
+
+		if(llabs(Err) > (int64_t)(TickNs / 2)){					// Lost? Start again from here
+			if(Heard &&(Now > LastRaw)&&(Now - LastRaw < (uint64_t)(TickNs * 4))){	// Clock running? Take the new period
+				TickNs = (double)(Now - LastRaw);				//
+			}else{												// Clock (re)appeared, first one seen is tick 0
+				Count = MIDI_PPQN - 1;							//
+				Bar = BEAT_BAR - 1;								//
+			}
+			Last = Now;											//
+		}else{
+			Last = Pred + (int64_t)(Err * BEAT_PHASE_GAIN);		// Phase
+			TickNs += Err * BEAT_PERIOD_GAIN;					// Period
+			if(Count == MIDI_PPQN - 1){							// Downbeat? Error vs. where the LED went
+				Beats++;										//
+				ErrSum += Err;									//
+				ErrSq += (double)Err * Err;						//
+				if(llabs(Err) > ErrMax){						//
+					ErrMax = llabs(Err);						//
+				}
+			}
+		}
+	}
+	LastRaw = Now;												//
+	Heard = true;												//
+	Count = (Count + 1) % MIDI_PPQN;							//
+	Bar = (Count == 0) ? (Bar + 1) % BEAT_BAR : Bar;			//
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI Start: the next tick is tick 0 of the first beat
+void BeatPhase::Start(void)
+{
+	Locate(0);													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// The next tick is song position Song (MIDI clocks from the start: Continue after a Stop / SPP)
+void BeatPhase::Locate(uint32_t Song)
+{
+	int Pos = (int)((Song + (BEAT_BAR * MIDI_PPQN) - 1) % (BEAT_BAR * MIDI_PPQN));	// The tick before it
+
+	pthread_mutex_lock(&Mutex);									//
+	Count = Pos % MIDI_PPQN;									//
+	Bar = Pos / MIDI_PPQN;										//
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Downbeat at Beat, then every BeatNs (Tap tempo, the tap starts a bar)
+void BeatPhase::Set(uint64_t Beat, uint64_t BeatNs)
+{
+	pthread_mutex_lock(&Mutex);									//
+	Last = Beat;												//
+	Count = 0;													//
+	Bar = 0;													//
+	TickNs = (double)BeatNs / MIDI_PPQN;						//
+	Valid = (BeatNs > 0);										//
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// New tempo, the grid is re-anchored on the last downbeat before Now
+void BeatPhase::SetPeriod(uint64_t Now, uint64_t BeatNs)
+{
+	uint64_t Beat = Now;										//
+	int64_t Pos;												// Ticks into the bar
+
+	pthread_mutex_lock(&Mutex);									//
+	if(Valid){													// Have a phase?
+		uint64_t Span = llround(TickNs * MIDI_PPQN);			//
+		Beat = NextBeat(Now);									//
+		Beat = (Beat > Span) ? Beat - Span : Now;				// Previous downbeat
+		Pos = (Bar * MIDI_PPQN) + Count + llround((double)(int64_t)(Beat - Last) / TickNs);	// Its place in the bar
+		Pos = ((Pos % (BEAT_BAR * MIDI_PPQN)) + (BEAT_BAR * MIDI_PPQN)) % (BEAT_BAR * MIDI_PPQN);	//
+		Bar = (int)(Pos / MIDI_PPQN);							//
+	}else{														//
+		Bar = 0;												//
+	}
+	Last = Beat;												//
+	Count = 0;													//
+	TickNs = (double)BeatNs / MIDI_PPQN;						//
+	Valid = (BeatNs > 0);										//
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// First downbeat after After (nS), 0 if there is no tempo yet. BeatNs = beat period.
+uint64_t BeatPhase::Next(uint64_t After, uint64_t *BeatNs)
+{
+	uint64_t Beat;												//
+
+	pthread_mutex_lock(&Mutex);									//
+	Beat = NextBeat(After);										//
+	if(BeatNs != 0){											//
+		*BeatNs = llround(TickNs * MIDI_PPQN);					//
+	}
+	pthread_mutex_unlock(&Mutex);								//
+	return Beat;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// First tick after After (nS), 0 if there is no tempo yet. Index = tick in beat (0 = downbeat).
+uint64_t BeatPhase::NextTick(uint64_t After, int *Index)
+{
+	uint64_t Tick = 0;											//
+	uint64_t N = 0;												// Ticks on from Last
+
+	pthread_mutex_lock(&Mutex);									//
+	if(Valid &&(TickNs > 0)){									// Have a tempo?
+		if(After >= Last){										// Whole ticks on to After
+			N = (uint64_t)floor((After - Last) / TickNs) + 1;	//
+		}
+		Tick = Last + llround(N * TickNs);						// Always from Last, nothing accumulates
+		while(Tick <= After){									// Rounding
+			Tick = Last + llround(++N * TickNs);				//
+		}
+		if(Index != 0){											//
+			*Index = (int)((Count + N) % MIDI_PPQN);			//
+		}
+	}
+	pthread_mutex_unlock(&Mutex);								//
+	return Tick;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// First tick after After that is a whole number of Ticks into its bar (1 = any tick, MIDI_PPQN =
+// a beat, BEAT_BAR x MIDI_PPQN = the bar), 0 if there is no tempo yet. Ticks should divide a bar.
+uint64_t BeatPhase::NextGrid(uint64_t After, int Ticks)
+{
+	uint64_t Tick = 0;											//
+	uint64_t N = 0;												// Ticks on from Last
+	int Pos;													// Ticks into the bar
+
+	pthread_mutex_lock(&Mutex);									//
+	if(Valid &&(TickNs > 0)&&(Ticks > 0)){						// Have a tempo?
+		if(After >= Last){										// Whole ticks on to After (As NextTick())
+			N = (uint64_t)floor((After - Last) / TickNs) + 1;	//
+		}
+		while(Last + llround(N * TickNs) <= After){				// Rounding
+			N++;												//
+		}
+		Pos = (int)(((Bar * MIDI_PPQN) + Count + N) % (BEAT_BAR * MIDI_PPQN));	//
+		N += (Ticks - (Pos % Ticks)) % Ticks;					// On to the grid
+		Tick = Last + llround(N * TickNs);						//
+	}
+	pthread_mutex_unlock(&Mutex);								//
+	return Tick;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Next() with Mutex held
+uint64_t BeatPhase::NextBeat(uint64_t After)
+{
+	double Span = TickNs * MIDI_PPQN;							// Beat period
+	uint64_t Beat;												//
+
+	if(!Valid){													// No tempo
+		return 0;												//
+	}
+	Beat = Last + llround(((MIDI_PPQN - Count) % MIDI_PPQN) * TickNs);	// Downbeat at / after Last
+	if(Beat <= After){											// Whole beats on to After
+		Beat += llround((floor((After - Beat) / Span) + 1) * Span);	//
+		while(Beat <= After){									// Rounding
+			Beat += llround(Span);								//
+		}
+	}
+	return Beat;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Print downbeat prediction error (What the beat LED is off by)
+void BeatPhase::Report(FILE *Out)
+{
+	pthread_mutex_lock(&Mutex);									//
+	if(Beats > 0){												//
+		double Mean = ErrSum / Beats;							//
+		fprintf(Out, "Beat phase: %llu downbeats, %.3f BPM, error mean %.1f uS, rms %.1f uS, max %.1f uS\r\n",
+			(unsigned long long)Beats, 60e9 / (TickNs * MIDI_PPQN), Mean / 1e3, sqrt(ErrSq / Beats) / 1e3, ErrMax / 1e3);
+	}
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
+// Tempo State
+// ------------------------------------------------------------------------------------ //
+// Constructor
+TempoState::TempoState()
+{
+	pthread_mutex_init(&Mutex, NULL);							//
+	Seq = 0;													//
+	Value.BPM = 0;												// Nothing published
+	Value.BeatNs = 0;											//
+	Value.Time = 0;												//
+	EventFd = -1;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+TempoState::~TempoState()
+{
+	Close();													//
+	pthread_mutex_destroy(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Create the change notification eventfd. Returns true if OK.
+bool TempoState::Open(void)
+{
+	if(EventFd >= 0){											// Already open?
+		return true;											//
+	}
+	if((EventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0){	//
+		printf("\r\nERROR!!! Tempo: eventfd() failed\r\n");
+		return false;											//
+	}
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Close
+void TempoState::Close(void)
+{
+	if(EventFd >= 0){											//
+		close(EventFd);											//
+		EventFd = -1;											//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Change notification descriptor (-1 = none)
+int TempoState::Fd(void)
+{
+	return EventFd;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Publish BPM at Time (CLK nS). Returns true (and notifies) if it changed.
+bool TempoState::Publish(int BPM, uint64_t Time)
+{
+	uint32_t S;													//
+	uint64_t One = 1;											//
+
+	if(BPM <= 0){												//
+		return false;											//
+	}
+	pthread_mutex_lock(&Mutex);									//
+	if(BPM == Value.BPM){										// Same tempo
+		pthread_mutex_unlock(&Mutex);							//
+		return false;											//
+	}
+	S = Seq;													//
+	__atomic_store_n(&Seq, S + 1, __ATOMIC_RELAXED);			// Odd, readers retry
+	__atomic_thread_fence(__ATOMIC_RELEASE);					//
+	__atomic_store_n(&Value.BPM, BPM, __ATOMIC_RELAXED);		//
+	__atomic_store_n(&Value.BeatNs, (60 * 1000000000ULL) / BPM, __ATOMIC_RELAXED);	//
+	__atomic_store_n(&Value.Time, Time, __ATOMIC_RELAXED);		//
+	__atomic_store_n(&Seq, S + 2, __ATOMIC_RELEASE);			// Even, value complete
+	pthread_mutex_unlock(&Mutex);								//
+
+	if(EventFd >= 0){											// Wake the reader
+		if(write(EventFd, &One, sizeof(One)) < 0){}				// (Counter saturating is fine)
+	}
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Current tempo (Lock free, any thread)
+void TempoState::Read(TempoValue *V)
+{
+	uint32_t S1, S2;											//
+
+	do{
+		S1 = __atomic_load_n(&Seq, __ATOMIC_ACQUIRE);			//
+		V->BPM = __atomic_load_n(&Value.BPM, __ATOMIC_RELAXED);	//
+		V->BeatNs = __atomic_load_n(&Value.BeatNs, __ATOMIC_RELAXED);	//
+		V->Time = __atomic_load_n(&Value.Time, __ATOMIC_RELAXED);	//
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);				//
+		S2 = __atomic_load_n(&Seq, __ATOMIC_RELAXED);			//
+	}while((S1 & 1)||(S1 != S2));								// Writer was busy? Again
+}
+
+// ------------------------------------------------------------------------------------ //
+// Consume change notifications (Read() gives the latest value)
+void TempoState::Clear(void)
+{
+	uint64_t Count;												//
+
+	if(EventFd >= 0){											//
+		if(read(EventFd, &Count, sizeof(Count)) < 0){}			// EAGAIN if none
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
+// Transport
+// ------------------------------------------------------------------------------------ //
+// Constructor
+Transport::Transport()
+{
+	Seq = 0;													//
+	Value.State = TRANSPORT_STOPPED;							//
+	Value.Song = 0;												//
+	Value.Time = 0;												//
+	Value.Runs = 0;												//
+	Starts = Stops = Continues = Locates = 0;					//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI Start: song position 0, the next clock plays it
+void Transport::Start(void)
+{
+	Starts++;													//
+	Publish(TRANSPORT_PLAYING, 0, 0, Value.Runs + 1);			//
+	TRACE(TRC_TRANSPORT, TRANSPORT_PLAYING, 0);					//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI Stop: clocks no longer move the position
+void Transport::Stop(void)
+{
+	Stops++;													//
+	Publish(TRANSPORT_STOPPED, Value.Song, Value.Time, Value.Runs);	//
+	TRACE(TRC_TRANSPORT, TRANSPORT_STOPPED, Value.Song);		//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI Continue: the next clock plays the position (Where it stopped, or the last SPP)
+void Transport::Continue(void)
+{
+	Continues++;												//
+	Publish(TRANSPORT_PLAYING, Value.Song, 0, Value.Runs + 1);	//
+	TRACE(TRC_TRANSPORT, TRANSPORT_PLAYING, Value.Song);		//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Song Position Pointer (In 1/16 notes). Sent while stopped, before a Continue.
+void Transport::Locate(int Sixteenths)
+{
+	Locates++;													//
+	Publish(Value.State, Sixteenths * SPP_TICKS, 0, Value.Runs);	//
+	TRACE(TRC_TRANSPORT, Value.State, Value.Song);				//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI clock at Now (nS). Returns true if playing (The position moved on).
+bool Transport::Tick(uint64_t Now)
+{
+	if(Value.State != TRANSPORT_PLAYING){						// (Writer's own copy, no lock needed)
+		return false;											//
+	}
+	Publish(TRANSPORT_PLAYING, Value.Song + 1, Now, Value.Runs);	//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Song position, MIDI clocks (Writer side)
+uint32_t Transport::Song(void)
+{
+	return Value.Song;											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Seqlock write (One writer, see TempoState::Publish())
+void Transport::Publish(int State, uint32_t Song, uint64_t Time, uint32_t Runs)
+{
+	uint32_t S = Seq;											//
+
+	__atomic_store_n(&Seq, S + 1, __ATOMIC_RELAXED);			// Odd, readers retry
+	__atomic_thread_fence(__ATOMIC_RELEASE);					//
+	__atomic_store_n(&Value.State, State, __ATOMIC_RELAXED);	//
+	__atomic_store_n(&Value.Song, Song, __ATOMIC_RELAXED);		//
+	__atomic_store_n(&Value.Time, Time, __ATOMIC_RELAXED);		//
+	__atomic_store_n(&Value.Runs, Runs, __ATOMIC_RELAXED);		//
+	__atomic_store_n(&Seq, S + 2, __ATOMIC_RELEASE);			// Even, value complete
+}
+
+// ------------------------------------------------------------------------------------ //
+// Current state / position (Lock free, any thread)
+void Transport::Read(TransportValue *V)
+{
+	uint32_t S1, S2;											//
+
+	do{
+		S1 = __atomic_load_n(&Seq, __ATOMIC_ACQUIRE);			//
+		V->State = __atomic_load_n(&Value.State, __ATOMIC_RELAXED);	//
+		V->Song = __atomic_load_n(&Value.Song, __ATOMIC_RELAXED);	//
+		V->Time = __atomic_load_n(&Value.Time, __ATOMIC_RELAXED);	//
+		V->Runs = __atomic_load_n(&Value.Runs, __ATOMIC_RELAXED);	//
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);				//
+		S2 = __atomic_load_n(&Seq, __ATOMIC_RELAXED);			//
+	}while((S1 & 1)||(S1 != S2));								// Writer was busy? Again
+}
+
+// ------------------------------------------------------------------------------------ //
+// Song position (MIDI clocks) -> bar (From 1), beat in bar (From 1), tick in beat (From 0)
+void Transport::Split(uint32_t Song, int *Bar, int *Beat, int *Tick)
+{
+	*Bar = (int)(Song / (BEAT_BAR * MIDI_PPQN)) + 1;			//
+	*Beat = (int)((Song / MIDI_PPQN) % BEAT_BAR) + 1;			//
+	*Tick = (int)(Song % MIDI_PPQN);							//
+}
+
+// ------------------------------------------------------------------------------------ //
+// State, position and transport messages seen
+void Transport::Report(FILE *Out)
+{
+	TransportValue V;											//
+	int Bar, Beat, Tick;										//
+	uint32_t St = __atomic_load_n(&Starts, __ATOMIC_RELAXED);	// Each counter read once
+	uint32_t Sp = __atomic_load_n(&Stops, __ATOMIC_RELAXED);	// (MIDI thread still counting)
+	uint32_t Co = __atomic_load_n(&Continues, __ATOMIC_RELAXED);	//
+	uint32_t Lo = __atomic_load_n(&Locates, __ATOMIC_RELAXED);	//
+
+	Read(&V);													//
+	Split(V.Song, &Bar, &Beat, &Tick);							//
+	if(St + Co + Lo > 0){										// Ever moved?
+		fprintf(Out, "Transport: %s at %d:%d:%02d, %u starts, %u stops, %u continues, %u song positions\r\n",
+			(V.State == TRANSPORT_PLAYING) ? "playing" : "stopped", Bar, Beat, Tick,
+			St, Sp, Co, Lo);
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
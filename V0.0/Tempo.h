@@ -0,0 +1,162 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			Tempo Header for Linux
+Filename:		Tempo.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	MIDI clock tempo estimator (24 ticks per quarter note), beat phase
+				tracker (When the next downbeat is, for the beat LED), the published
+				tempo (Seqlock, change notification on an eventfd) and the MIDI
+				transport (Start / Stop / Continue, song position, seqlock).
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _TEMPO_H
+#define _TEMPO_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdio.h>												// FILE
+#include <stdint.h>												// Fixed width types
+#include <pthread.h>											// Mutex
+#include "config.h"												// General Configuration File
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define MIDI_PPQN			24									// MIDI clock ticks per quarter note
+#define BEAT_BAR			4									// Beats per bar (4/4)
+#define SPP_TICKS			6									// MIDI clock ticks per Song Position Pointer step (1/16)
+#define BEAT_PHASE_GAIN		0.125								// Phase correction per tick (Of the prediction error)
+#define BEAT_PERIOD_GAIN	0.0083								// Period correction per tick (Critically damped with the above)
+
+// -------------------------------------------------------------------------------------
+// Define Tempo Tracker Class
+class TempoTracker
+{
+private:
+	int Ticks;													// Ticks per measurement
+	int Cnt;													// Ticks since last measurement
+	uint64_t Last;												// Time of last measurement (nS, 0 = none)
+
+public:
+	TempoTracker(int Sample = BPM_SAMPLE);						// Measure every Sample + 2 ticks
+
+	void Reset(void);											//
+	int Tick(uint64_t Now, int64_t *Period = 0);				// Returns BPM, 0 if not measured this tick
+};
+
+// -------------------------------------------------------------------------------------
+// Define Beat Phase Class. Written by the MIDI IN / foot switch side, read by the LED.
+class BeatPhase
+{
+private:
+	pthread_mutex_t Mutex;										//
+	bool Valid;													// Have a phase (Last, TickNs)
+	bool Heard;													// Have a tick (LastRaw)
+	uint64_t Last;												// Filtered time of the last tick (nS)
+	uint64_t LastRaw;											// Arrival of the last tick (nS)
+	double TickNs;												// Filtered tick period (nS)
+	int Count;													// Tick in beat of Last (0 = downbeat)
+	int Bar;													// Beat in bar of Last (0 = first, after a Start / tap)
+
+	uint64_t Beats;												// Downbeats measured
+	double ErrSum, ErrSq;										// Prediction error at downbeats (nS)
+	int64_t ErrMax;												// Largest |error| (nS)
+
+	uint64_t NextBeat(uint64_t After);							// Next() with Mutex held
+
+public:
+	BeatPhase();												//
+	~BeatPhase();												//
+
+	void Tick(uint64_t Now);									// MIDI clock tick (0xF8) arrived at Now
+	void Start(void);											// MIDI Start (0xFA), next tick is a downbeat
+	void Set(uint64_t Beat, uint64_t BeatNs);					// Downbeat at Beat, BeatNs apart (Tap tempo)
+	void SetPeriod(uint64_t Now, uint64_t BeatNs);				// New tempo, keep the phase at Now
+	uint64_t Next(uint64_t After, uint64_t *BeatNs = 0);		// First downbeat after After (nS, 0 = no tempo)
+	uint64_t NextTick(uint64_t After, int *Index = 0);			// First tick after After (nS, 0 = no tempo), Index in beat
+	uint64_t NextGrid(uint64_t After, int Ticks);				// First multiple of Ticks into a bar after After (nS, 0 = no tempo)
+	void Locate(uint32_t Song);									// Next tick is song position Song (MIDI clocks, Start = 0)
+
+	void Report(FILE *Out);										// Print phase error statistics
+};
+
+// -------------------------------------------------------------------------------------
+// Published Tempo
+typedef struct _tempoValue{
+	int BPM;													//
+	uint64_t BeatNs;											// Beat period (nS)
+	uint64_t Time;												// Published at (CLK nS)
+} TempoValue;
+
+// -------------------------------------------------------------------------------------
+// Define Tempo State Class. Any thread publishes, readers never block or wait.
+class TempoState
+{
+private:
+	pthread_mutex_t Mutex;										// Writers only
+	uint32_t Seq;												// Seqlock, odd while writing
+	TempoValue Value;											//
+	int EventFd;												// Change notification (-1 = none)
+
+public:
+	TempoState();												//
+	~TempoState();												//
+
+	bool Open(void);											// Create eventfd. Returns true if OK.
+	void Close(void);											//
+	int Fd(void);												// Readable after a change (-1 = none)
+
+	bool Publish(int BPM, uint64_t Time);						// New tempo, published at Time. True if it changed
+	void Read(TempoValue *V);									// Current tempo (Lock free)
+	void Clear(void);											// Consume change notifications
+};
+
+// -------------------------------------------------------------------------------------
+// Transport states
+enum TransportRun
+{
+	TRANSPORT_STOPPED = 0,										// Stop (Or nothing yet), clocks don't move the position
+	TRANSPORT_PLAYING											// Start / Continue, every clock moves it on
+};
+
+// -------------------------------------------------------------------------------------
+// Published Transport
+typedef struct _transportValue{
+	int State;													// TransportRun
+	uint32_t Song;												// Song position, MIDI clocks from the start (The next clock's)
+	uint64_t Time;												// Last clock that moved it (CLK nS, 0 = none since a Start / locate)
+	uint32_t Runs;												// Starts + continues (Changes on every restart)
+} TransportValue;
+
+// -------------------------------------------------------------------------------------
+// Define Transport Class. The MIDI IN thread writes (One writer), readers never block or wait.
+class Transport
+{
+private:
+	uint32_t Seq;												// Seqlock, odd while writing
+	TransportValue Value;										//
+	uint32_t Starts, Stops, Continues, Locates;					// Messages (Writer only)
+
+	void Publish(int State, uint32_t Song, uint64_t Time, uint32_t Runs);	// Seqlock write
+
+public:
+	Transport();												//
+
+	void Start(void);											// 0xFA: position 0, plays from the next clock
+	void Stop(void);											// 0xFC: position kept
+	void Continue(void);										// 0xFB: plays on from the position
+	void Locate(int Sixteenths);								// 0xF2 Song Position Pointer (Stopped)
+	bool Tick(uint64_t Now);									// 0xF8. True if playing (Position moved on)
+	uint32_t Song(void);										// Song position (Writer side)
+
+	void Read(TransportValue *V);								// Current state / position (Lock free, any thread)
+	static void Split(uint32_t Song, int *Bar, int *Beat, int *Tick);	// Clocks -> bar / beat / tick (From 1, 1, 0)
+	void Report(FILE *Out);										// State, position, messages
+};
+
+// -------------------------------------------------------------------------------------
+#endif
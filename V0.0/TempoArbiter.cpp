@@ -0,0 +1,361 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			Tempo Arbiter for Linux
+Filename:		TempoArbiter.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Tempo source priorities, fall back and glide.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Priority (config.h TEMPO_PRIORITY), e.g. "tap clock osc mtc fixed": the
+	  first source alive is followed. Sources not listed are never followed,
+	  'fixed' is added at the end if missing so there's always a tempo.
+	# Alive: MIDI clock once it has been measured and while its ticks come
+	  (TEMPO_SILENT), time code while its quarter frames come, tap and OSC
+	  from their first tempo until let go (Hold for auto / '/tempo 0'),
+	  fixed always. Clock and time code going silent forget their tempo, the
+	  next one is measured afresh.
+	# Time code carries no tempo: it keeps the tempo it took over with, so a
+	  DAW rolling time code without clock holds the delay where it was. Tap
+	  does the same on the first tap, the second one sets the tempo.
+	# Handover (Another source followed) glides at TEMPO_SLEW BPM / S from the
+	  event loop timer, one BPM at a time: the delay time steps through every
+	  value in between instead of jumping. A new tempo from the source being
+	  followed (Tap, clock change) goes out at once unless it's gliding, then
+	  the glide heads for it.
+	# Feed() comes from the MIDI IN thread (Clock, time code) and the event
+	  loop (Tap, OSC), it chooses at once under the lock, the timer only
+	  notices silence and glides. The tempo is published (TempoFn) under
+	  the lock, from whichever thread moved it, so two threads can't swap
+	  their publishes over and leave an old tempo out. TempoFn only takes
+	  the TempoState / BeatPhase locks, never this one.
+	# OSC tempo input: '/tempo ,f <BPM>' or ',i' to UDP TEMPO_OSC_PORT from
+	  any host (A DAW, a phone), read on the event loop.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <string.h>												// memset(), strcmp(), strtok_r()
+#include <math.h>												// lroundf()
+#include <unistd.h>												// close()
+#include <sys/socket.h>											// socket(), bind(), recv()
+#include <netinet/in.h>											// sockaddr_in
+#include "TempoArbiter.h"										// Tempo Arbiter Class
+#include "OSC.h"												// OSC Decode
+#include "Clock.h"												// Time source
+#include "Trace.h"												// Flight Recorder
+
+// ------------------------------------------------------------------------------------ //
+// Source names (Priority list, report)
+static const char *SourceName[TEMPO_SOURCES] = {"clock", "tap", "mtc", "osc", "fixed"};
+
+// ------------------------------------------------------------------------------------ //
+// Constructor
+TempoArbiter::TempoArbiter()
+{
+	memset(Bpm, 0, sizeof(Bpm));								//
+	memset(Heard, 0, sizeof(Heard));							//
+	memset(Silent, 0, sizeof(Silent));							//
+	memset(Hold, 0, sizeof(Hold));								//
+	Silent[TEMPO_SRC_CLOCK] = TEMPO_SILENT * NS_PER_MS;			//
+	Silent[TEMPO_SRC_MTC] = TEMPO_SILENT * NS_PER_MS;			//
+	Hold[TEMPO_SRC_TAP] = true;									// First tap
+	Hold[TEMPO_SRC_MTC] = true;									//
+	Orders = 0;													//
+	for(int I = 0; I < TEMPO_SOURCES; I++){						//
+		Order[I] = TEMPO_SRC_FIXED;								//
+		Rank[I] = TEMPO_SOURCES;								//
+	}
+	Active = TEMPO_SRC_FIXED;									//
+	Target = Current = 0;										//
+	Sent = 0;													//
+	Min = 0;													//
+	Max = 1000;													//
+	Fn = NULL;													//
+	pthread_mutex_init(&Lock, NULL);							//
+	Loop = NULL;												//
+	memset(&Timer, 0, sizeof(Timer));							//
+	Timer.Fn = &TempoArbiter::OnTimer;							//
+	Timer.Arg = this;											//
+	OscFd = -1;													//
+	Handovers = 0;												//
+	OscIn = 0;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+TempoArbiter::~TempoArbiter()
+{
+	Close();													//
+	pthread_mutex_destroy(&Lock);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Sources in Priority order (Names, highest first), Fixed BPM to start with, published through F.
+// L = NULL: no glide, no silence checks (Single thread). Returns true if OK.
+bool TempoArbiter::Open(EventLoop *L, TempoFn F, int Fixed, int TempoMin, int TempoMax, const char *Priority)
+{
+	char List[TEMPO_PRIORITY_MAX];								//
+	char *Tok, *Save;											//
+	int S;														//
+
+	if((F == NULL)||(Fn != NULL)){								// Already open?
+		return false;											//
+	}
+	strncpy(List, (Priority != NULL) ? Priority : "fixed", sizeof(List) - 1);	//
+	List[sizeof(List) - 1] = 0;									//
+	for(Tok = strtok_r(List, " ,\t", &Save); Tok != NULL; Tok = strtok_r(NULL, " ,\t", &Save)){
+		for(S = 0; (S < TEMPO_SOURCES)&&(strcmp(Tok, SourceName[S]) != 0); S++);	// Which?
+		if(S == TEMPO_SOURCES){									//
+			printf("\r\nERROR!!! Unknown tempo source '%s' (clock, tap, mtc, osc, fixed)...\r\n", Tok);
+			return false;										//
+		}
+		if(Rank[S] == TEMPO_SOURCES){							// Listed twice? First one counts
+			Rank[S] = Orders;									//
+			Order[Orders++] = S;								//
+		}
+	}
+	if(Rank[TEMPO_SRC_FIXED] == TEMPO_SOURCES){					// Always something to follow
+		Rank[TEMPO_SRC_FIXED] = Orders;							//
+		Order[Orders++] = TEMPO_SRC_FIXED;						//
+	}
+
+	pthread_mutex_lock(&Lock);									//
+	Min = (float)TempoMin;										//
+	Max = (float)TempoMax;										//
+	Fn = F;														//
+	Bpm[TEMPO_SRC_FIXED] = (float)Fixed;						//
+	Heard[TEMPO_SRC_FIXED] = 1;									//
+	Active = TEMPO_SRC_FIXED;									//
+	Target = Current = (float)Fixed;							//
+	Choose(CLK->Now());											//
+	Publish();													//
+	pthread_mutex_unlock(&Lock);								//
+	if(L != NULL){												// Silence checks, glide
+		Loop = L;												//
+		Loop->StartTimer(&Timer, CLK->Now() + (TEMPO_ARB_TICK * NS_PER_MS), TEMPO_ARB_TICK * NS_PER_MS);	//
+	}
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// OSC tempo input on UDP Port (Any address), read on the loop. Returns true if OK.
+bool TempoArbiter::Listen(int Port)
+{
+	struct sockaddr_in Addr;									//
+	int On = 1;													//
+
+	if((Loop == NULL)||(OscFd >= 0)){							// Not open / listening already
+		return false;											//
+	}
+	if((OscFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) < 0){	//
+		printf("\r\nERROR!!! Can't create OSC tempo socket...\r\n");
+		return false;											//
+	}
+	setsockopt(OscFd, SOL_SOCKET, SO_REUSEADDR, &On, sizeof(On));	//
+	memset(&Addr, 0, sizeof(Addr));								//
+	Addr.sin_family = AF_INET;									//
+	Addr.sin_addr.s_addr = htonl(INADDR_ANY);					//
+	Addr.sin_port = htons(Port);								//
+	if((bind(OscFd, (struct sockaddr *)&Addr, sizeof(Addr)) < 0)||(!Loop->Add(OscFd, EPOLLIN, &TempoArbiter::OnOsc, this))){
+		printf("\r\nERROR!!! Can't listen for OSC tempo on port %d...\r\n", Port);
+		close(OscFd);											//
+		OscFd = -1;												//
+		return false;											//
+	}
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Stop the timer and the OSC input. Before the loop goes.
+void TempoArbiter::Close(void)
+{
+	if(Loop != NULL){											//
+		Loop->StopTimer(&Timer);								//
+		if(OscFd >= 0){											//
+			Loop->Remove(OscFd);								//
+		}
+		Loop = NULL;											//
+	}
+	if(OscFd >= 0){												//
+		close(OscFd);											//
+		OscFd = -1;												//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Source has a tempo (BPM, Now its time) or is still there (BPM 0). Any thread.
+void TempoArbiter::Feed(int Source, float BPM, uint64_t Now)
+{
+	int Was;													//
+	bool Gliding;												//
+
+	if((Source < 0)||(Source >= TEMPO_SOURCES)||((BPM != 0)&&((BPM < Min)||(BPM >= Max)))){	// Out of range?
+		return;													//
+	}
+	pthread_mutex_lock(&Lock);									//
+	if(Fn == NULL){												// Not open
+		pthread_mutex_unlock(&Lock);							//
+		return;													//
+	}
+	if(BPM > 0){												//
+		Bpm[Source] = BPM;										//
+	}
+	Heard[Source] = Now;										//
+	Was = Active;												//
+	Gliding = (Current != Target);								//
+	Choose(Now);												//
+	if((Active == Was)&&(!Gliding)){							// Same source, settled? Its tempo at once
+		Current = Target;										//
+	}
+	Publish();													//
+	pthread_mutex_unlock(&Lock);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Source gone at once (Its tempo forgotten)
+void TempoArbiter::Release(int Source)
+{
+	if((Source < 0)||(Source >= TEMPO_SOURCES)||(Source == TEMPO_SRC_FIXED)){	//
+		return;													//
+	}
+	pthread_mutex_lock(&Lock);									//
+	Bpm[Source] = 0;											//
+	Heard[Source] = 0;											//
+	Choose(CLK->Now());											//
+	Publish();													//
+	pthread_mutex_unlock(&Lock);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Source followed now
+int TempoArbiter::Source(void)
+{
+	return __atomic_load_n(&Active, __ATOMIC_RELAXED);			//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Sources, the one followed and its tempo, handovers
+void TempoArbiter::Report(FILE *Out)
+{
+	pthread_mutex_lock(&Lock);									//
+	if(Fn != NULL){												//
+		fprintf(Out, "Tempo: %s at %.1f BPM (%d sent), %u handovers, %llu OSC tempos, sources",
+			SourceName[Active], Current, Sent, Handovers, (unsigned long long)OscIn);
+		for(int I = 0; I < Orders; I++){						// Priority order
+			if(Bpm[Order[I]] > 0){								//
+				fprintf(Out, " %s %.1f", SourceName[Order[I]], Bpm[Order[I]]);
+			}else{
+				fprintf(Out, " %s -", SourceName[Order[I]]);	//
+			}
+		}
+		fprintf(Out, "\r\n");									//
+	}
+	pthread_mutex_unlock(&Lock);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Fed within its silence time (Or not let go), with a tempo or holding one. Lock held.
+bool TempoArbiter::Alive(int S, uint64_t Now)
+{
+	if((Rank[S] >= Orders)||(Heard[S] == 0)){					// Not used / never fed / let go
+		return false;											//
+	}
+	if((Silent[S] > 0)&&(Now > Heard[S] + Silent[S])){			// Gone quiet? Measured afresh next time
+		Bpm[S] = 0;												//
+		Heard[S] = 0;											//
+		return false;											//
+	}
+	return (Bpm[S] > 0) || Hold[S];								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Follow the first alive source in priority order, a handover glides. Lock held.
+void TempoArbiter::Choose(uint64_t Now)
+{
+	int S = TEMPO_SRC_FIXED;									//
+
+	for(int I = 0; I < Orders; I++){							//
+		if(Alive(Order[I], Now)){								//
+			S = Order[I];										//
+			break;												//
+		}
+	}
+	if(S != Active){											// Handover
+		if((Bpm[S] <= 0)&&Hold[S]){								// No tempo of its own? Keeps the one now
+			Bpm[S] = Current;									//
+		}
+		Active = S;												//
+		Handovers++;											//
+		TRACE(TRC_TEMPO_SOURCE, S, lroundf(Bpm[S]));			//
+	}
+	Target = (Bpm[S] > 0) ? Bpm[S] : Current;					//
+	if((Loop == NULL)||(TEMPO_SLEW == 0)){						// No glide
+		Current = Target;										//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Tempo moved on to another whole BPM? Published. Lock held, so publishes from the MIDI IN
+// thread and the event loop go out in the order they were taken (The last one stays).
+void TempoArbiter::Publish(void)
+{
+	int B = (int)lroundf(Current);								//
+
+	if((B == Sent)||(Fn == NULL)){								// Same / not open
+		return;													//
+	}
+	Sent = B;													//
+	Fn(B, Active);												// Never takes Lock (Nor waits on a thread that does)
+}
+
+// ------------------------------------------------------------------------------------ //
+// Every TEMPO_ARB_TICK (Event loop): silence, one glide step
+void TempoArbiter::OnTimer(void *Arg)
+{
+	TempoArbiter *C = (TempoArbiter *)Arg;						//
+	const float Step = (TEMPO_SLEW * TEMPO_ARB_TICK) / 1000.0f;	// BPM per tick
+
+	pthread_mutex_lock(&C->Lock);								//
+	C->Choose(CLK->Now());										//
+	if(C->Current < C->Target){									// Glide
+		C->Current = (C->Target - C->Current > Step) ? C->Current + Step : C->Target;	//
+	}else if(C->Current > C->Target){							//
+		C->Current = (C->Current - C->Target > Step) ? C->Current - Step : C->Target;	//
+	}
+	C->Publish();												//
+	pthread_mutex_unlock(&C->Lock);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// OSC tempo datagrams (Event loop): /tempo ,f or ,i BPM, 0 lets go
+void TempoArbiter::OnOsc(int Fd, uint32_t Events, void *Arg)
+{
+	TempoArbiter *C = (TempoArbiter *)Arg;						//
+	char Data[OSC_MSG_MAX];										//
+	OSCMessage Msg;												//
+	float BPM;													//
+	int Len;													//
+
+	while((Len = recv(Fd, Data, sizeof(Data), 0)) > 0){			// All waiting
+		if((!RPiOSC::Decode(Data, Len, &Msg))||(strcmp(Msg.Address, TEMPO_OSC_ADDRESS) != 0)||(Msg.Type == 0)){
+			continue;											// Not a tempo
+		}
+		BPM = (Msg.Type == 'f') ? Msg.Float : (float)Msg.Int;	//
+		if(BPM <= 0){											// Let go
+			C->Release(TEMPO_SRC_OSC);							//
+			continue;											//
+		}
+		C->Feed(TEMPO_SRC_OSC, BPM, CLK->Now());				//
+		pthread_mutex_lock(&C->Lock);							//
+		C->OscIn++;												//
+		pthread_mutex_unlock(&C->Lock);							//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
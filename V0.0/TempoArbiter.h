@@ -0,0 +1,102 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			Tempo Arbiter Header for Linux
+Filename:		TempoArbiter.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Picks the tempo MOLink follows from MIDI clock, tap, MIDI time code,
+				an OSC tempo input and a fixed default, by priority, falls back when
+				the one followed goes silent and glides to the new tempo on a
+				handover so the delay time never jumps.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _TEMPOARBITER_H
+#define _TEMPOARBITER_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdio.h>												// FILE
+#include <stdint.h>												// Fixed width types
+#include <pthread.h>											// Source lock
+#include "config.h"												// General Configuration File
+#include "EventLoop.h"											// Check / glide timer
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define TEMPO_ARB_TICK		20									// mS between silence checks / glide steps
+#define TEMPO_SLEW			20									// BPM per second at most on a handover (0 = jump)
+#define TEMPO_SILENT		1000								// No MIDI clock / time code for mS? Gone
+#define TEMPO_OSC_ADDRESS	"/tempo"							// OSC tempo input: /tempo ,f <BPM> (Or ,i, 0 = let go)
+#define TEMPO_PRIORITY_MAX	64									// Priority list length
+
+// -------------------------------------------------------------------------------------
+// Tempo sources
+enum TempoSource
+{
+	TEMPO_SRC_CLOCK = 0,										// MIDI clock (Measured), gone after TEMPO_SILENT
+	TEMPO_SRC_TAP,												// Tap tempo, until let go (Hold for auto)
+	TEMPO_SRC_MTC,												// MIDI time code running (No tempo in it, keeps the one it took over)
+	TEMPO_SRC_OSC,												// OSC / UDP tempo input, until let go (/tempo 0)
+	TEMPO_SRC_FIXED,											// Default, always there
+	TEMPO_SOURCES												//
+};
+
+// -------------------------------------------------------------------------------------
+// Tempo published (BPM, source followed). From the feeding thread or the event loop, with the
+// arbiter locked: mustn't call back into it.
+typedef void (*TempoFn)(int BPM, int Source);					//
+
+// -------------------------------------------------------------------------------------
+// Define Tempo Arbiter Class
+class TempoArbiter
+{
+private:
+	float Bpm[TEMPO_SOURCES];									// Latest per source (0 = none of its own)
+	uint64_t Heard[TEMPO_SOURCES];								// Last fed (CLK nS, 0 = never / let go)
+	uint64_t Silent[TEMPO_SOURCES];								// Gone after nS unfed (0 = until let go)
+	bool Hold[TEMPO_SOURCES];									// No tempo of its own, keeps the one it took over
+	int Order[TEMPO_SOURCES];									// Highest priority first
+	int Orders;													//
+	int Rank[TEMPO_SOURCES];									// Place in Order (Orders = not used)
+
+	int Active;													// Source followed
+	float Target;												// Its tempo
+	float Current;												// Tempo now, gliding to Target
+	int Sent;													// Last BPM published
+	float Min, Max;												// Tempo range (Feeds outside are ignored)
+	TempoFn Fn;													//
+	pthread_mutex_t Lock;										// Any feeding thread + the event loop
+
+	EventLoop *Loop;											// NULL = no glide, no silence checks
+	LoopTimer Timer;											// Every TEMPO_ARB_TICK
+	int OscFd;													// OSC tempo input socket (-1 = none)
+	uint32_t Handovers;											//
+	uint64_t OscIn;												// OSC tempo messages taken
+
+	bool Alive(int S, uint64_t Now);							// Fed recently / not let go, with a tempo (Lock held)
+	void Choose(uint64_t Now);									// Follow the first alive source (Lock held)
+	void Publish(void);											// Sent moved? Through Fn (Lock held)
+	static void OnTimer(void *Arg);								// Silence / glide (Event loop)
+	static void OnOsc(int Fd, uint32_t Events, void *Arg);		// OSC tempo datagrams (Event loop)
+
+public:
+	TempoArbiter();												//
+	~TempoArbiter();											//
+
+	bool Open(EventLoop *L, TempoFn F, int Fixed, int TempoMin, int TempoMax, const char *Priority);	// Publishes Fixed. Returns true if OK.
+	bool Listen(int Port);										// OSC tempo input on UDP Port. Returns true if OK.
+	void Close(void);											// Before the loop goes
+
+	void Feed(int Source, float BPM, uint64_t Now);				// (Any thread) BPM 0 = still here, same tempo
+	void Release(int Source);									// Gone at once (Tap: back to auto)
+	int Source(void);											// Followed now
+
+	void Report(FILE *Out);										// Sources, followed, handovers
+};
+
+// -------------------------------------------------------------------------------------
+#endif
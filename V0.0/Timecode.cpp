@@ -0,0 +1,507 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			MIDI Time Code for Linux
+Filename:		Timecode.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	MIDI Time Code reader and generator.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Quarter frames go 0..7 over two frames: frames lo / hi, seconds, minutes,
+	  hours (+ rate). Piece 0 goes out as the frame it carries starts, so when
+	  piece 7 completes a time code we are 1.75 frames on from it. From then on
+	  every quarter frame in order moves the position on a quarter frame, no
+	  waiting for the next complete set, and each complete set is checked
+	  against it (A jump relocates). Out of order (Rewind, lost bytes) drops
+	  the lock until the next complete set.
+	# Decoded in the MIDI IN callback as the bytes are parsed, published with
+	  a seqlock (As the transport), so nothing waits between the UART and a
+	  reader. The time is the ingest time of the read, wire time included.
+	# Drift: the quarter frame arrivals go through the same filter as the beat
+	  phase (Phase + period, critically damped), the filtered time is where
+	  the position is pinned. Ratio = time code nS per CLK nS, from the
+	  filtered period for the first MTC_BASELINE, then from everything since
+	  the lock (The period filter wanders a few 10s of ppm with the jitter,
+	  the long baseline doesn't). At() moves the position on with it between
+	  quarter frames (Sub frame resolution). Arrivals further out than half a
+	  quarter frame (USB bursts) restart the phase, not the period.
+	# Drop frame (29.97): labels 00 and 01 are skipped every minute but every
+	  tenth, positions are real frames x 1001 / 30 mS.
+	# The generator sleeps to absolute deadlines, Origin + N x quarter frame
+	  (As the MIDI clock out), nothing adds up. Piece 0 always starts an even
+	  frame. Start / Continue send a full frame first, ahead of the deadline
+	  by its wire time, so slaves locate before the first quarter frame.
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <math.h>												// llround(), sqrt()
+#include <stdlib.h>												// llabs()
+#include <string.h>												// memset()
+#include "Timecode.h"											// MIDI Time Code Classes
+#include "MIDI.h"												// MIDI Status Bytes
+#include "Clock.h"												// Time source
+#include "Trace.h"												// Flight Recorder
+
+// ------------------------------------------------------------------------------------ //
+// Frames per second (Labels) and names by MTCRate
+static const int RateFps[4] = {24, 25, 30, 30};
+static const char *RateName[4] = {"24", "25", "29.97 drop", "30"};
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
+// MIDI Time Code Reader
+// ------------------------------------------------------------------------------------ //
+// Constructor
+MIDITimecode::MIDITimecode()
+{
+	Seq = 0;													//
+	Value.Rate = MTC_25;										//
+	Value.Running = false;										//
+	Value.Position = 0;											//
+	Value.Time = 0;												//
+	Value.Ratio = 1.0;											//
+	Value.Locks = 0;											//
+	Locks = 0;													//
+	memset(Nibble, 0, sizeof(Nibble));							//
+	Seen = 0;													//
+	Locked = false;												//
+	Q = 0;														//
+	Rate = MTC_25;												//
+	Valid = false;												//
+	Last = LastRaw = 0;											//
+	QfNs = 0;													//
+	Since = SinceQ = 0;											//
+	Quarters = Fulls = Relocates = Errors = 0;					//
+	Measured = 0;												//
+	ErrSq = 0;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Quarter frame (0xF1 dd) at Now (nS). Returns true if locked (The position moved on).
+bool MIDITimecode::QuarterFrame(uint8_t Data, uint64_t Now)
+{
+	int Piece = (Data >> 4) & 0x07;								//
+	double Nominal;												// Quarter frame at the rate (nS)
+	double Ratio;												// Time code nS per CLK nS
+	uint64_t Code;												// Frames the complete time code says
+
+	Quarters++;													//
+	if(Locked){													// In order? A quarter frame on
+		if(Piece == (int)((Q + 1) % MTC_PIECES)){				//
+			Q++;												//
+		}else{													// Lost (Rewind, bytes dropped)
+			Locked = false;										//
+			Valid = false;										//
+			Errors++;											//
+			Publish(false, Value.Position, Value.Time, Value.Ratio);	//
+			TRACE(TRC_MTC, 0, Q / 4);							//
+		}
+	}
+	Nibble[Piece] = Data & 0x0F;								//
+	Seen = (Piece == 0) ? 1 : ((Piece == Seen) ? Seen + 1 : 0);	// Pieces 0.. in a row
+	if(Seen == MTC_PIECES){										// Complete time code? Check / lock
+		Seen = 0;												//
+		Code = Frames((Nibble[7] >> 1) & 0x03, ((Nibble[7] & 0x01) << 4) | Nibble[6],
+			((Nibble[5] & 0x03) << 4) | Nibble[4], ((Nibble[3] & 0x03) << 4) | Nibble[2], ((Nibble[1] & 0x01) << 4) | Nibble[0]);
+		if((!Locked)||(Q != (Code * 4) + 7)||(Rate != ((Nibble[7] >> 1) & 0x03))){	// Not where it should be? Relocate
+			Relocates += Locked ? 1 : 0;						//
+			Q = (Code * 4) + 7;									// Piece 7 is 1.75 frames on
+			Rate = (Nibble[7] >> 1) & 0x03;						//
+			Locked = true;										//
+			Valid = false;										//
+			Locks++;											//
+			TRACE(TRC_MTC, 1, Code);							//
+		}
+	}
+	if(!Locked){												//
+		LastRaw = Now;											//
+		return false;											//
+	}
+
+	Nominal = FrameNs(Rate) / 4;								//
+	if(!Valid){													// Nothing to predict from yet, start at the nominal rate
+		QfNs = Nominal;											//
+		Last = Now;												//
+		Since = Now;											//
+		SinceQ = Q;												//
+		Valid = true;											//
+	}else{
+		uint64_t Pred = Last + llround(QfNs);					// Predicted arrival
+		int64_t Err = (int64_t)(Now - Pred);					//
+
+		if(llabs(Err) > (int64_t)(QfNs / 2)){					// Burst / gap? Phase from here, keep the period
+			Last = Now;											//
+		}else{
+			Last = Pred + (int64_t)(Err * MTC_PHASE_GAIN);		// Phase
+			QfNs += Err * MTC_PERIOD_GAIN;						// Period
+			Measured++;											//
+			ErrSq += (double)Err * Err;							//
+		}
+	}
+	LastRaw = Now;												//
+	Ratio = Nominal / QfNs;										// Filter's, settling
+	if(Last > Since + (MTC_BASELINE * NS_PER_MS)){				// Long enough? Since the lock, the jitter averages out
+		Ratio = ((Q - SinceQ) * Nominal) / (Last - Since);		//
+	}
+	Publish(true, llround(Q * Nominal), Last, Ratio);			//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Full frame SysEx (F0 7F <dev> 01 01 hr mn sc fr F7): locate, stopped until quarter frames
+// come. Returns true if SysEx was one.
+bool MIDITimecode::FullFrame(const uint8_t *SysEx, int Len, uint64_t Now)
+{
+	uint64_t Code;												//
+
+	if((SysEx == NULL)||(Len != MTC_FULL_LEN)||(SysEx[1] != 0x7F)||(SysEx[3] != 0x01)||(SysEx[4] != 0x01)){	// Not MTC?
+		return false;											//
+	}
+	Fulls++;													//
+	Rate = (SysEx[5] >> 5) & 0x03;								//
+	Code = Frames(Rate, SysEx[5] & 0x1F, SysEx[6] & 0x3F, SysEx[7] & 0x3F, SysEx[8] & 0x1F);	//
+	Locked = false;												// Quarter frames lock again
+	Valid = false;												//
+	Seen = 0;													//
+	Locks++;													//
+	Publish(false, llround(Code * FrameNs(Rate)), Now, 1.0);	//
+	TRACE(TRC_MTC, 2, Code);									//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Seqlock write (One writer, see TempoState::Publish())
+void MIDITimecode::Publish(bool Running, uint64_t Position, uint64_t Time, double Ratio)
+{
+	uint32_t S = Seq;											//
+
+	__atomic_store_n(&Seq, S + 1, __ATOMIC_RELAXED);			// Odd, readers retry
+	__atomic_thread_fence(__ATOMIC_RELEASE);					//
+	__atomic_store_n(&Value.Rate, Rate, __ATOMIC_RELAXED);		//
+	__atomic_store_n(&Value.Running, Running, __ATOMIC_RELAXED);	//
+	__atomic_store_n(&Value.Position, Position, __ATOMIC_RELAXED);	//
+	__atomic_store_n(&Value.Time, Time, __ATOMIC_RELAXED);		//
+	__atomic_store(&Value.Ratio, &Ratio, __ATOMIC_RELAXED);		//
+	__atomic_store_n(&Value.Locks, Locks, __ATOMIC_RELAXED);	//
+	__atomic_store_n(&Seq, S + 2, __ATOMIC_RELEASE);			// Even, value complete
+}
+
+// ------------------------------------------------------------------------------------ //
+// Current time code (Lock free, any thread)
+void MIDITimecode::Read(MTCValue *V)
+{
+	uint32_t S1, S2;											//
+
+	do{
+		S1 = __atomic_load_n(&Seq, __ATOMIC_ACQUIRE);			//
+		V->Rate = __atomic_load_n(&Value.Rate, __ATOMIC_RELAXED);	//
+		V->Running = __atomic_load_n(&Value.Running, __ATOMIC_RELAXED);	//
+		V->Position = __atomic_load_n(&Value.Position, __ATOMIC_RELAXED);	//
+		V->Time = __atomic_load_n(&Value.Time, __ATOMIC_RELAXED);	//
+		__atomic_load(&Value.Ratio, &V->Ratio, __ATOMIC_RELAXED);	//
+		V->Locks = __atomic_load_n(&Value.Locks, __ATOMIC_RELAXED);	//
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);				//
+		S2 = __atomic_load_n(&Seq, __ATOMIC_RELAXED);			//
+	}while((S1 & 1)||(S1 != S2));								// Writer was busy? Again
+}
+
+// ------------------------------------------------------------------------------------ //
+// Time code at Now (nS from 00:00:00:00): moved on at the measured rate while quarter frames
+// come, where it stopped otherwise.
+uint64_t MIDITimecode::At(const MTCValue *V, uint64_t Now, bool *Running)
+{
+	bool On = V->Running && (V->Time != 0) && (Now < V->Time + (MTC_TIMEOUT * NS_PER_MS));	//
+
+	if(Running != NULL){										//
+		*Running = On;											//
+	}
+	if((!On)||(Now <= V->Time)){								//
+		return V->Position;										//
+	}
+	return V->Position + llround((Now - V->Time) * V->Ratio);	//
+}
+
+// ------------------------------------------------------------------------------------ //
+// One frame at Rate (nS)
+double MIDITimecode::FrameNs(int Rate)
+{
+	return (Rate == MTC_30_DROP) ? (NS_PER_SEC * 1001.0) / 30000 : (double)NS_PER_SEC / RateFps[Rate & 0x03];
+}
+
+// ------------------------------------------------------------------------------------ //
+// H:M:S:F -> frames from 00:00:00:00 (Drop frame: less the labels skipped)
+uint64_t MIDITimecode::Frames(int Rate, int H, int M, int S, int F)
+{
+	uint64_t Mins = ((uint64_t)H * 60) + M;						//
+	uint64_t N = (((Mins * 60) + S) * RateFps[Rate & 0x03]) + F;	//
+
+	if(Rate == MTC_30_DROP){									// 2 a minute, but every tenth
+		N -= 2 * (Mins - (Mins / 10));							//
+	}
+	return N;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Frames from 00:00:00:00 -> H:M:S:F (Drop frame: labels skipped put back, 17982 frames per 10 minutes)
+void MIDITimecode::Label(uint64_t Frames, int Rate, int *H, int *M, int *S, int *F)
+{
+	int Fps = RateFps[Rate & 0x03];								//
+	uint64_t Tens, Rem;											//
+
+	if(Rate == MTC_30_DROP){									//
+		Tens = Frames / 17982;									//
+		Rem = Frames % 17982;									//
+		Frames += (18 * Tens) + ((Rem > 1) ? 2 * ((Rem - 2) / 1798) : 0);	//
+	}
+	*F = (int)(Frames % Fps);									//
+	*S = (int)((Frames / Fps) % 60);							//
+	*M = (int)((Frames / (Fps * 60)) % 60);						//
+	*H = (int)((Frames / (Fps * 3600)) % 24);					//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Rate, position, drift and messages seen
+void MIDITimecode::Report(FILE *Out)
+{
+	MTCValue V;													//
+	bool On;													//
+	int H, M, S, F;												//
+
+	Read(&V);													//
+	Label((uint64_t)(At(&V, CLK->Now(), &On) / FrameNs(V.Rate)), V.Rate, &H, &M, &S, &F);	//
+	if(__atomic_load_n(&Quarters, __ATOMIC_RELAXED) + __atomic_load_n(&Fulls, __ATOMIC_RELAXED) > 0){
+		fprintf(Out, "MIDI time code in: %s fps at %02d:%02d:%02d:%02d %s, drift %+.1f ppm, jitter rms %.1f uS, %llu quarter frames, %llu full frames, %llu relocates, %llu errors\r\n",
+			RateName[V.Rate & 0x03], H, M, S, F, On ? "running" : "stopped", (V.Ratio - 1) * 1e6,
+			(Measured > 0) ? sqrt(ErrSq / Measured) / 1e3 : 0.0,
+			(unsigned long long)Quarters, (unsigned long long)Fulls, (unsigned long long)Relocates, (unsigned long long)Errors);
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
+// MIDI Time Code Generator
+// ------------------------------------------------------------------------------------ //
+// Constructor
+MIDITimecodeOut::MIDITimecodeOut()
+{
+	Port = NULL;												//
+	Rate = MTC_25;												//
+	Active = false;												//
+	Join = false;												//
+	Enabled = false;											//
+	pthread_mutex_init(&Mutex, NULL);							//
+	Run = false;												//
+	Origin = From = Held = 0;									//
+	Gen = 0;													//
+	Sent = Dropped = Fulls = 0;									//
+	LateSum = 0;												//
+	LateMax = 0;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+MIDITimecodeOut::~MIDITimecodeOut()
+{
+	Close();													//
+	pthread_mutex_destroy(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Start the time code thread, FrameRate (MTCRate) to Out once enabled and started. Returns true if OK.
+bool MIDITimecodeOut::Open(Serial *Out, int FrameRate)
+{
+	if((Out == NULL)||Active){									//
+		return false;											//
+	}
+	if((FrameRate < MTC_24)||(FrameRate > MTC_30)){				//
+		printf("\r\nERROR!!! Unknown MTC frame rate %d...\r\n", FrameRate);
+		return false;											//
+	}
+	Port = Out;													//
+	Rate = FrameRate;											//
+	Active = true;												//
+	CLK->Expect("MTC Out");										// Virtual time: announce thread
+	if(pthread_create(&ThreadId, NULL, (void* (*)(void*))&MIDITimecodeOut::TimecodeThread, this) != 0){
+		printf("\r\nERROR!!! Can't create MTC Thread...\r\n");
+		Active = false;											//
+		return false;											//
+	}
+	Join = true;												//
+	return true;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Stop the time code thread (Returns within a quarter frame or MTC_OUT_IDLE)
+void MIDITimecodeOut::Close(void)
+{
+	__atomic_store_n(&Active, false, __ATOMIC_RELEASE);			//
+	if(Join){													// Started?
+		pthread_join(ThreadId, NULL);							//
+		Join = false;											//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Send time code (Master) or not
+void MIDITimecodeOut::Enable(bool On)
+{
+	__atomic_store_n(&Enabled, On, __ATOMIC_RELEASE);			//
+}
+
+// ------------------------------------------------------------------------------------ //
+// 00:00:00:00 at At (CLK nS, 0 = now)
+void MIDITimecodeOut::Start(uint64_t At)
+{
+	pthread_mutex_lock(&Mutex);									//
+	Run = true;													//
+	Origin = (At == 0) ? CLK->Now() : At;						//
+	From = Held = 0;											//
+	Gen++;														//
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Stop at once, the position is held for a Continue
+void MIDITimecodeOut::Stop(void)
+{
+	pthread_mutex_lock(&Mutex);									//
+	Run = false;												//
+	Gen++;														//
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// On from the held position at At (CLK nS, 0 = now)
+void MIDITimecodeOut::Continue(uint64_t At)
+{
+	pthread_mutex_lock(&Mutex);									//
+	Run = true;													//
+	Origin = (At == 0) ? CLK->Now() : At;						//
+	From = Held;												//
+	Gen++;														//
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Print position and timing (Lateness vs. the deadline)
+void MIDITimecodeOut::Report(FILE *Out)
+{
+	int H, M, S, F;												//
+
+	pthread_mutex_lock(&Mutex);									//
+	if(Sent > 0){												//
+		MIDITimecode::Label(Held, Rate, &H, &M, &S, &F);		//
+		fprintf(Out, "MIDI time code out: %s fps at %02d:%02d:%02d:%02d, %llu quarter frames, %llu full frames, %llu dropped, late mean %.1f uS, max %.1f uS\r\n",
+			RateName[Rate], H, M, S, F, (unsigned long long)Sent, (unsigned long long)Fulls, (unsigned long long)Dropped,
+			(LateSum / Sent) / 1e3, LateMax / 1e3);
+	}
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI Time Code Thread. Sleeps to each quarter frame's absolute deadline from Origin.
+void *MIDITimecodeOut::TimecodeThread(MIDITimecodeOut *C)
+{
+	double QfNs = MIDITimecode::FrameNs(C->Rate) / 4;			// Quarter frame (nS)
+	uint64_t Now, Due, Frame, Origin = 0, From = 0, Q = 0, Skip;	//
+	uint32_t Gen = 0;											// Start / continue being sent
+	bool Run, Full = false;										// Full frame before the next quarter frame
+	int64_t Late;												// nS
+	int H, M, S, F, Piece;										//
+	uint8_t Msg[MTC_FULL_LEN];									//
+
+	if(TRC != NULL){ TRC->SetThreadName("MTC Out"); }			// Claim trace ring
+	CLK->Attach("MTC Out");										// Virtual time: join clock
+	while(__atomic_load_n(&C->Active, __ATOMIC_ACQUIRE)){
+		Now = CLK->Now();										//
+		pthread_mutex_lock(&C->Mutex);							//
+		Run = C->Run && __atomic_load_n(&C->Enabled, __ATOMIC_ACQUIRE);	//
+		if(C->Gen != Gen){										// Started / continued? From its origin
+			Gen = C->Gen;										//
+			Origin = C->Origin;									//
+			From = C->From;										//
+			Q = 0;												//
+			Full = true;										//
+		}
+		pthread_mutex_unlock(&C->Mutex);						//
+		if(!Run){												// Stopped / not the master?
+			CLK->SleepUntil(Now + (MTC_OUT_IDLE * NS_PER_MS));	//
+			continue;											//
+		}
+
+		Due = Origin + llround(Q * QfNs);						// Absolute, from the origin
+		if(Due + (MTC_OUT_RESYNC * NS_PER_MS) < Now){			// Stalled? Next time code from now, located again
+			Skip = (((uint64_t)((Now - Origin) / QfNs) / MTC_PIECES) + 1) * MTC_PIECES;	//
+			pthread_mutex_lock(&C->Mutex);						//
+			C->Dropped += Skip - Q;								//
+			pthread_mutex_unlock(&C->Mutex);					//
+			Q = Skip;											//
+			Full = true;										//
+			continue;											//
+		}
+		Frame = From + ((Q / MTC_PIECES) * 2);					// Frame piece 0 carries
+		MIDITimecode::Label(Frame, C->Rate, &H, &M, &S, &F);	//
+		if(Full){												// Locate first, on the wire by the deadline
+			CLK->SleepUntil(Due - (MTC_FULL_LEN * MIDI_BYTE_NS));	//
+			Msg[0] = MIDI_SYSEX;								// F0 7F 7F 01 01 hr mn sc fr F7
+			Msg[1] = 0x7F;										// Real time universal
+			Msg[2] = 0x7F;										// All devices
+			Msg[3] = 0x01;										// MTC
+			Msg[4] = 0x01;										// Full frame
+			Msg[5] = (uint8_t)((C->Rate << 5) | H);				//
+			Msg[6] = (uint8_t)M;								//
+			Msg[7] = (uint8_t)S;								//
+			Msg[8] = (uint8_t)F;								//
+			Msg[9] = MIDI_SYSEX_END;							//
+			if(__atomic_load_n(&C->Gen, __ATOMIC_ACQUIRE) == Gen){	// Not stopped meanwhile?
+				C->Port->SerialWrite((const char *)Msg, MTC_FULL_LEN);	//
+				pthread_mutex_lock(&C->Mutex);					//
+				C->Fulls++;										//
+				pthread_mutex_unlock(&C->Mutex);				//
+			}
+			Full = false;										//
+		}
+
+		CLK->SleepUntil(Due);									//
+		if(__atomic_load_n(&C->Gen, __ATOMIC_ACQUIRE) != Gen){	// Stopped / restarted meanwhile?
+			continue;											//
+		}
+		Piece = (int)(Q % MTC_PIECES);							//
+		switch(Piece){											// Low nibble first
+			case 0: Msg[1] = F & 0x0F; break;					//
+			case 1: Msg[1] = F >> 4; break;						//
+			case 2: Msg[1] = S & 0x0F; break;					//
+			case 3: Msg[1] = S >> 4; break;						//
+			case 4: Msg[1] = M & 0x0F; break;					//
+			case 5: Msg[1] = M >> 4; break;						//
+			case 6: Msg[1] = H & 0x0F; break;					//
+			default: Msg[1] = (H >> 4) | (C->Rate << 1); break;	// Hours bit 4, rate
+		}
+		Msg[0] = MIDI_MTC_QF;									//
+		Msg[1] |= (uint8_t)(Piece << 4);						//
+		C->Port->SerialWrite((const char *)Msg, 2);				//
+		Late = (int64_t)(CLK->Now() - Due);						// Error vs. the deadline
+
+		pthread_mutex_lock(&C->Mutex);							//
+		C->Sent++;												//
+		C->LateSum += Late;										//
+		if(Late > C->LateMax){									//
+			C->LateMax = Late;									//
+		}
+		if(C->Gen == Gen){										// Where a Continue goes on from (Next time code)
+			C->Held = Frame + 2;								//
+		}
+		pthread_mutex_unlock(&C->Mutex);						//
+		Q++;													//
+	}
+	CLK->Detach();												// Virtual time: leave clock
+	return NULL;
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
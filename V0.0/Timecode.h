@@ -0,0 +1,143 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			MIDI Time Code Header for Linux
+Filename:		Timecode.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	MIDI Time Code (MTC). The reader decodes quarter frames (0xF1) and
+				full frame SysEx into a time code position with its drift against
+				our clock (Seqlock, readers never block). The generator sends MTC
+				from MOLink's own clock when it's the master (Manual tempo).
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _TIMECODE_H
+#define _TIMECODE_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdio.h>												// FILE
+#include <stdint.h>												// Fixed width types
+#include <pthread.h>											// Threads
+#include "config.h"												// General Configuration File
+#include "Serial.h"												// MIDI OUT
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define MTC_PIECES			8									// Quarter frames per time code (Two frames)
+#define MTC_FULL_LEN		10									// Full frame SysEx: F0 7F <dev> 01 01 hr mn sc fr F7
+#define MTC_TIMEOUT			100									// No quarter frame for mS? Stopped
+#define MTC_PHASE_GAIN		0.125								// Phase correction per quarter frame (As BEAT_PHASE_GAIN)
+#define MTC_PERIOD_GAIN		0.0083								// Period correction per quarter frame
+#define MTC_BASELINE		2000									// Locked for mS? Drift from everything since the lock
+#define MTC_OUT_IDLE		10									// Check for enable / start every mS when not sending
+#define MTC_OUT_RESYNC		100									// Further behind than mS? Restart from now (With a full frame)
+
+// -------------------------------------------------------------------------------------
+// Frame rates (Bits 5-6 of the hours)
+enum MTCRate
+{
+	MTC_24 = 0,													// Film
+	MTC_25,														// PAL
+	MTC_30_DROP,												// 29.97 drop frame (NTSC)
+	MTC_30														// 30 non drop
+};
+
+// -------------------------------------------------------------------------------------
+// Published time code
+typedef struct _mtcValue{
+	int Rate;													// MTCRate
+	bool Running;												// Quarter frames coming (Check Time against MTC_TIMEOUT too)
+	uint64_t Position;											// Time code at Time (nS from 00:00:00:00)
+	uint64_t Time;												// Last quarter frame / full frame (CLK nS, filtered, 0 = none)
+	double Ratio;												// Time code nS per CLK nS (1 + drift)
+	uint32_t Locks;												// Changes on every lock / relocate
+} MTCValue;
+
+// -------------------------------------------------------------------------------------
+// Define MIDI Time Code Reader Class. The MIDI IN thread writes (One writer), readers never block or wait.
+class MIDITimecode
+{
+private:
+	uint32_t Seq;												// Seqlock, odd while writing
+	MTCValue Value;												//
+
+	uint8_t Nibble[MTC_PIECES];									// Pieces of the time code being collected
+	int Seen;													// Pieces 0.. in a row (MTC_PIECES = complete)
+	bool Locked;												// Q is known
+	uint64_t Q;													// Quarter frames from 00:00:00:00 (Of the last one)
+	int Rate;													// MTCRate
+	bool Valid;													// Have a period (Last, QfNs)
+	uint64_t Last;												// Filtered time of the last quarter frame (nS)
+	uint64_t LastRaw;											// Arrival of the last quarter frame (nS, 0 = none)
+	double QfNs;												// Filtered quarter frame period (nS)
+	uint64_t Since, SinceQ;										// Arrival / quarter frame at the lock (Drift baseline)
+	uint32_t Locks;												// Locks / relocates / full frames (Published)
+
+	uint64_t Quarters, Fulls, Relocates, Errors;				// Messages (Writer only)
+	uint64_t Measured;											// Quarter frames in the jitter
+	double ErrSq;												// Arrival vs. prediction (nS)
+
+	void Publish(bool Running, uint64_t Position, uint64_t Time, double Ratio);	// Seqlock write (Rate, Locks as they are)
+
+public:
+	MIDITimecode();												//
+
+	bool QuarterFrame(uint8_t Data, uint64_t Now);				// 0xF1 dd at Now. True if locked (Position known)
+	bool FullFrame(const uint8_t *SysEx, int Len, uint64_t Now);	// F0 7F .. F7. True if it was MTC (Locate)
+
+	void Read(MTCValue *V);										// Current time code (Lock free, any thread)
+	static uint64_t At(const MTCValue *V, uint64_t Now, bool *Running = 0);	// Time code at Now (nS), moved on if running
+	static double FrameNs(int Rate);							// One frame (nS)
+	static uint64_t Frames(int Rate, int H, int M, int S, int F);	// Label -> frames from 00:00:00:00 (Drop frame skips labels)
+	static void Label(uint64_t Frames, int Rate, int *H, int *M, int *S, int *F);	// Frames -> label
+	void Report(FILE *Out);										// Position, drift, messages
+};
+
+// -------------------------------------------------------------------------------------
+// Define MIDI Time Code Generator Class
+class MIDITimecodeOut
+{
+private:
+	Serial *Port;												// MIDI OUT
+	int Rate;													// MTCRate
+	pthread_t ThreadId;											//
+	bool Active;												// Thread running
+	bool Join;													// Thread to join on Close()
+	bool Enabled;												// Master (Manual tempo)
+
+	pthread_mutex_t Mutex;										// Run / Origin / From / Gen, statistics
+	bool Run;													// Started / continued, not stopped since
+	uint64_t Origin;											// Quarter frame 0 at (CLK nS)
+	uint64_t From;												// Frame at Origin (Even, piece 0 starts a time code)
+	uint64_t Held;												// Frame reached (Where a Continue goes on from)
+	uint32_t Gen;												// Changes on every start / continue / stop
+
+	uint64_t Sent;												// Quarter frames sent
+	uint64_t Dropped;											// Skipped after a stall
+	uint64_t Fulls;												// Full frames sent
+	double LateSum;												// Write time - deadline (nS)
+	int64_t LateMax;											//
+
+	static void *TimecodeThread(MIDITimecodeOut *C);			//
+
+public:
+	MIDITimecodeOut();											//
+	~MIDITimecodeOut();											//
+
+	bool Open(Serial *Out, int FrameRate);						// Start the time code thread. Returns true if OK.
+	void Close(void);											//
+	void Enable(bool On);										// Send (Master) or not
+
+	void Start(uint64_t At);									// 00:00:00:00 at At (CLK nS, the downbeat the MIDI Start goes on)
+	void Stop(void);											// At once, the position is held
+	void Continue(uint64_t At);									// On from the held position at At
+
+	void Report(FILE *Out);										// Print timing statistics
+};
+
+// -------------------------------------------------------------------------------------
+#endif
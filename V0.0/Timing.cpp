@@ -0,0 +1,303 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			Timing for RPi - Linux
+Filename:		Timing.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Named interval timers and profiling zones.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Interval timers read CLK, so tap tempo etc. works the same in a simulation.
+	  A timer belongs to whoever uses it, one writer, any number of readers.
+	# Zones always measure real time (CPU cost). Any thread can enter any
+	  zone: each thread adds to its own counters (Own cache line, plain
+	  stores, no atomic read-modify-write) and Report() merges them. Threads
+	  past TIMING_THREADS - 1 share the last slot, with atomics. Cost is two
+	  clock_gettime() (vDSO) and a few stores.
+	# Timer() and Zone() take a mutex, call them once and keep the pointer
+	  (PROFILE_ZONE() does this with a function static).
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <string.h>												// strncpy(), strcmp()
+#include <time.h>												// clock_gettime()
+#include "Timing.h"												// Timing Classes
+#include "Clock.h"												// Time source
+
+// ------------------------------------------------------------------------------------ //
+// Globals
+static Timing Service;											// Default instance
+Timing *TIM = &Service;											// Global Timing Service
+int Timing::Threads = 0;										// Stats slots claimed
+static __thread int ThreadSlot = -1;							// Calling thread's stats slot
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
+// Interval Timer
+// ------------------------------------------------------------------------------------ //
+// Constructor
+IntervalTimer::IntervalTimer()
+{
+	Begin = 0;													//
+	Last = 0;													//
+	Name[0] = 0;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// (Re)start
+void IntervalTimer::Start(void)
+{
+	Begin = CLK->Now();											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Stop, returns interval since Start (nS, 0 if not started)
+uint64_t IntervalTimer::Stop(void)
+{
+	uint64_t Now = CLK->Now();									//
+
+	if(Begin == 0){												// Not started?
+		return 0;												//
+	}
+	Last = Now - Begin;											//
+	Begin = 0;													//
+	return Last;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Interval since Start or the previous Lap, and restart (nS, 0 on the first call)
+uint64_t IntervalTimer::Lap(void)
+{
+	return LapAt(CLK->Now());									//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Lap() for an event that happened at Now (CLK nS), e.g. a time stamped edge
+uint64_t IntervalTimer::LapAt(uint64_t Now)
+{
+	uint64_t Prev = Begin;										//
+
+	Begin = Now;												// Restart
+	if(Prev == 0){												// First lap?
+		return 0;												//
+	}
+	Last = Now - Prev;											//
+	return Last;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Running time so far (nS, 0 if not started)
+uint64_t IntervalTimer::Elapsed(void)
+{
+	uint64_t Start = Begin;										//
+
+	return (Start == 0) ? 0 : CLK->Now() - Start;				//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Last Stop() / Lap() result (nS)
+uint64_t IntervalTimer::Interval(void)
+{
+	return Last;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+bool IntervalTimer::Running(void)
+{
+	return (Begin != 0);										//
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
+// Timing Service
+// ------------------------------------------------------------------------------------ //
+// Constructor
+Timing::Timing()
+{
+	pthread_mutex_init(&Mutex, NULL);							//
+	TimerCnt = 0;												//
+	ZoneCnt = 0;												//
+	memset(Zones, 0, sizeof(Zones));							//
+	memset(&Overflow, 0, sizeof(Overflow));						//
+	strncpy(Overflow.Name, "(Other)", TIMING_NAME_MAX - 1);		//
+	Reset();													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+Timing::~Timing()
+{
+	pthread_mutex_destroy(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Find or create a named interval timer (NULL if the table is full)
+IntervalTimer *Timing::Timer(const char *Name)
+{
+	IntervalTimer *T = NULL;									//
+
+	pthread_mutex_lock(&Mutex);									//
+	for(int I = 0; I < TimerCnt; I++){							// Existing?
+		if(strcmp(Timers[I].Name, Name) == 0){					//
+			T = &Timers[I];										//
+			break;												//
+		}
+	}
+	if((T == NULL)&&(TimerCnt < TIMING_TIMERS)){				// New?
+		T = &Timers[TimerCnt++];								//
+		strncpy(T->Name, Name, TIMING_NAME_MAX - 1);			//
+		T->Name[TIMING_NAME_MAX - 1] = 0;						//
+	}
+	pthread_mutex_unlock(&Mutex);								//
+
+	if(T == NULL){												//
+		printf("\r\nERROR!!! Timing: no free timer for '%s'\r\n", Name);
+	}
+	return T;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Find or create a profiling zone (Shares '(Other)' if the table is full)
+TimingZone *Timing::Zone(const char *Name)
+{
+	TimingZone *Z = NULL;										//
+
+	pthread_mutex_lock(&Mutex);									//
+	for(int I = 0; I < ZoneCnt; I++){							// Existing?
+		if(strcmp(Zones[I].Name, Name) == 0){					//
+			Z = &Zones[I];										//
+			break;												//
+		}
+	}
+	if(Z == NULL){												// New?
+		if(ZoneCnt < TIMING_ZONES){								//
+			Z = &Zones[ZoneCnt];								//
+			strncpy(Z->Name, Name, TIMING_NAME_MAX - 1);		//
+			for(int T = 0; T < TIMING_THREADS; T++){			//
+				Z->Stats[T].Min = UINT64_MAX;					//
+			}
+			__atomic_store_n(&ZoneCnt, ZoneCnt + 1, __ATOMIC_RELEASE);	// Visible to Report() once named
+		}else{
+			Z = &Overflow;										//
+		}
+	}
+	pthread_mutex_unlock(&Mutex);								//
+
+	return Z;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// CLOCK_MONOTONIC in nS (Real time, whatever CLK is)
+uint64_t Timing::Now(void)
+{
+	struct timespec Ts;											//
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);						//
+	return ((uint64_t)Ts.tv_sec * NS_PER_SEC) + Ts.tv_nsec;		//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Add one sample to a zone (Any thread)
+void Timing::Add(TimingZone *Z, uint64_t Ns)
+{
+	int I = (ThreadSlot >= 0) ? ThreadSlot : Slot();			//
+	TimingStats *S = &Z->Stats[I];								//
+	uint64_t Cur;												//
+
+	if(I < TIMING_THREADS - 1){									// Own slot? Only this thread writes it
+		__atomic_store_n(&S->Count, S->Count + 1, __ATOMIC_RELAXED);	// (Stores so Report() never reads half)
+		__atomic_store_n(&S->Total, S->Total + Ns, __ATOMIC_RELAXED);	//
+		if(Ns < S->Min){										//
+			__atomic_store_n(&S->Min, Ns, __ATOMIC_RELAXED);	//
+		}
+		if(Ns > S->Max){										//
+			__atomic_store_n(&S->Max, Ns, __ATOMIC_RELAXED);	//
+		}
+		return;													//
+	}
+
+	__atomic_fetch_add(&S->Count, 1, __ATOMIC_RELAXED);			// Shared slot
+	__atomic_fetch_add(&S->Total, Ns, __ATOMIC_RELAXED);		//
+	Cur = __atomic_load_n(&S->Min, __ATOMIC_RELAXED);			// New minimum?
+	while((Ns < Cur)&&!__atomic_compare_exchange_n(&S->Min, &Cur, Ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){}
+	Cur = __atomic_load_n(&S->Max, __ATOMIC_RELAXED);			// New maximum?
+	while((Ns > Cur)&&!__atomic_compare_exchange_n(&S->Max, &Cur, Ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Claim the calling thread's stats slot (First Add(), the last one is shared)
+int Timing::Slot(void)
+{
+	int I = __atomic_fetch_add(&Threads, 1, __ATOMIC_RELAXED);	//
+
+	ThreadSlot = (I < TIMING_THREADS - 1) ? I : TIMING_THREADS - 1;	//
+	return ThreadSlot;											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Every thread's counters of Z added up into S
+void Timing::Merge(const TimingZone *Z, TimingStats *S)
+{
+	S->Count = S->Total = S->Max = 0;							//
+	S->Min = UINT64_MAX;										//
+	for(int T = 0; T < TIMING_THREADS; T++){					//
+		const TimingStats *P = &Z->Stats[T];					//
+		uint64_t Min = __atomic_load_n(&P->Min, __ATOMIC_RELAXED);	//
+		uint64_t Max = __atomic_load_n(&P->Max, __ATOMIC_RELAXED);	//
+		S->Count += __atomic_load_n(&P->Count, __ATOMIC_RELAXED);	//
+		S->Total += __atomic_load_n(&P->Total, __ATOMIC_RELAXED);	//
+		S->Min = (Min < S->Min) ? Min : S->Min;					//
+		S->Max = (Max > S->Max) ? Max : S->Max;					//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Clear zone aggregates (Names kept)
+void Timing::Reset(void)
+{
+	pthread_mutex_lock(&Mutex);									//
+	for(int I = 0; I <= ZoneCnt; I++){							// Zones + Overflow
+		TimingZone *Z = (I < ZoneCnt) ? &Zones[I] : &Overflow;	//
+		for(int T = 0; T < TIMING_THREADS; T++){				// (A sample being added may survive)
+			__atomic_store_n(&Z->Stats[T].Count, 0, __ATOMIC_RELAXED);	//
+			__atomic_store_n(&Z->Stats[T].Total, 0, __ATOMIC_RELAXED);	//
+			__atomic_store_n(&Z->Stats[T].Min, UINT64_MAX, __ATOMIC_RELAXED);	//
+			__atomic_store_n(&Z->Stats[T].Max, 0, __ATOMIC_RELAXED);	//
+		}
+	}
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Print zone table (uS) and last timer intervals
+void Timing::Report(FILE *Out)
+{
+	int Zn = __atomic_load_n(&ZoneCnt, __ATOMIC_ACQUIRE);		//
+
+	fprintf(Out, "%-24s %10s %12s %10s %10s %10s\r\n", "Zone", "Count", "Total mS", "Avg uS", "Min uS", "Max uS");
+	for(int I = 0; I <= Zn; I++){								// Zones + Overflow
+		TimingZone *Z = (I < Zn) ? &Zones[I] : &Overflow;		//
+		TimingStats S;											//
+
+		Merge(Z, &S);											// All threads
+		if(S.Count == 0){										// Never entered?
+			continue;											//
+		}
+		fprintf(Out, "%-24s %10llu %12.3f %10.3f %10.3f %10.3f\r\n", Z->Name, (unsigned long long)S.Count,
+			S.Total / 1e6, (S.Total / (double)S.Count) / 1e3, S.Min / 1e3, S.Max / 1e3);
+	}
+
+	pthread_mutex_lock(&Mutex);									//
+	for(int I = 0; I < TimerCnt; I++){							//
+		fprintf(Out, "%-24s %10s %12s %10.3f\r\n", Timers[I].Name, "timer", "", Timers[I].Interval() / 1e3);
+	}
+	pthread_mutex_unlock(&Mutex);								//
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
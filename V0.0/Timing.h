@@ -0,0 +1,138 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			Timing Header for RPi - Linux
+Filename:		Timing.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Named interval timers and profiling zones. Every user gets its own
+				timer, so threads can't corrupt each other's measurements.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _TIMING_H
+#define _TIMING_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdio.h>												// FILE
+#include <stdint.h>												// Fixed width types
+#include <pthread.h>											// Mutex
+#include "config.h"												// General Configuration File
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define TIMING_TIMERS		16									// Max. named interval timers
+#define TIMING_ZONES		32									// Max. profiling zones
+#define TIMING_NAME_MAX		24									// Name length
+#define TIMING_THREADS		16									// Threads with their own zone counters (The rest share one)
+
+// -------------------------------------------------------------------------------------
+// Profiling zone, time spent between PROFILE_ZONE() and the end of its scope (Names by line)
+#define PROFILE_JOIN(A, B)	A##B								//
+#define PROFILE_LINE(A, B)	PROFILE_JOIN(A, B)					//
+#define PROFILE_ZONE(Name)	static TimingZone *PROFILE_LINE(ProfileZoneAt, __LINE__) = TIM->Zone(Name); \
+							ProfileScope PROFILE_LINE(ProfileScopeAt, __LINE__)(PROFILE_LINE(ProfileZoneAt, __LINE__))
+
+// -------------------------------------------------------------------------------------
+// Interval Timer (Clock time, follows virtual time in a simulation)
+class IntervalTimer
+{
+private:
+	volatile uint64_t Begin;									// Start time (nS, 0 = not started)
+	volatile uint64_t Last;										// Last measured interval (nS)
+
+public:
+	char Name[TIMING_NAME_MAX];									//
+
+	IntervalTimer();											//
+
+	void Start(void);											// (Re)start
+	uint64_t Stop(void);										// Interval since Start (nS)
+	uint64_t Lap(void);											// Interval since Start / last Lap, restarts (nS, 0 = first)
+	uint64_t LapAt(uint64_t Now);								// Lap() for an event stamped Now (CLK nS)
+	uint64_t Elapsed(void);										// Running time, timer untouched (nS)
+	uint64_t Interval(void);									// Last Stop / Lap result (nS)
+	bool Running(void);											//
+};
+
+// -------------------------------------------------------------------------------------
+// Profiling Zone Counters, one thread's (Own cache line)
+typedef struct __attribute__((aligned(64))) _timingStats{
+	uint64_t Count;												// Times entered
+	uint64_t Total;												// nS
+	uint64_t Min;												// nS
+	uint64_t Max;												// nS
+} TimingStats;
+
+// -------------------------------------------------------------------------------------
+// Profiling Zone Aggregate (Real CLOCK_MONOTONIC, even in a simulation)
+typedef struct _timingZone{
+	char Name[TIMING_NAME_MAX];									//
+	TimingStats Stats[TIMING_THREADS];							// Per thread, merged by Report()
+} TimingZone;
+
+// -------------------------------------------------------------------------------------
+// Scoped Zone Measurement (Adds to Zone when it goes out of scope)
+class ProfileScope
+{
+private:
+	TimingZone *Zone;											//
+	uint64_t Begin;												//
+
+public:
+	ProfileScope(TimingZone *Z);								//
+	~ProfileScope();											//
+};
+
+// -------------------------------------------------------------------------------------
+// Define Timing Class
+class Timing
+{
+private:
+	pthread_mutex_t Mutex;										// Registration only
+	IntervalTimer Timers[TIMING_TIMERS];						//
+	int TimerCnt;												//
+	TimingZone Zones[TIMING_ZONES];								//
+	int ZoneCnt;												//
+	TimingZone Overflow;										// Zone table full
+	static int Threads;											// Stats slots claimed
+
+	static int Slot(void);										// This thread's stats slot
+	static void Merge(const TimingZone *Z, TimingStats *S);		// All threads' counters
+
+public:
+	Timing();													//
+	~Timing();													//
+
+	IntervalTimer *Timer(const char *Name);						// Find / create, NULL if table full
+	TimingZone *Zone(const char *Name);							// Find / create (Never NULL)
+
+	static uint64_t Now(void);									// CLOCK_MONOTONIC in nS
+	static void Add(TimingZone *Z, uint64_t Ns);				// Add one sample to a zone
+
+	void Reset(void);											// Clear zone aggregates
+	void Report(FILE *Out);										// Print zone table
+};
+
+// -------------------------------------------------------------------------------------
+// Inline Profiling
+inline ProfileScope::ProfileScope(TimingZone *Z)
+{
+	Zone = Z;													//
+	Begin = Timing::Now();										//
+}
+
+inline ProfileScope::~ProfileScope()
+{
+	Timing::Add(Zone, Timing::Now() - Begin);					//
+}
+
+// -------------------------------------------------------------------------------------
+// Global Timing Service
+extern Timing *TIM;												//
+
+// -------------------------------------------------------------------------------------
+#endif
@@ -0,0 +1,481 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			MOLink Microbenchmarks for Linux
+Filename:		Bench.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Measures the MOLink building blocks and the MIDI IN -> OSC OUT path.
+				One JSON object per line on stdout, so results from two builds (or
+				two Pis) can be compared with any script.
+
+// ------------------------------------------------------------------------------------ //
+Setting up:
+
+Make & Run - 'make bench' (Builds Tools/Bench and runs it)
+
+Execute - 'Tools/Bench [-x]'   -x skips the end-to-end test (pty + UDP loopback)
+
+// ------------------------------------------------------------------------------------ //
+Benchmarks:
+	midi_parse		MIDIParser, clock ticks mixed with CC / notes (running status)
+	osc_encode_int	RPiOSC::EncodeInt()
+	osc_encode_float	RPiOSC::EncodeFloat()
+	osc_decode		RPiOSC::Decode()
+	tempo_tick		TempoTracker::Tick()
+	mtc_quarter		MIDITimecode::QuarterFrame(), 25 fps time code with jitter, locked
+	trace_log		Trace::Log() into the mmap'd ring
+	profile_zone	PROFILE_ZONE() enter + leave
+	loop_timer		EventLoop::StartTimer() re-arm, BENCH_TIMERS timers armed
+	midi_map_small	MIDIMap::Message(), 4 rules, CCs that fire nothing
+	midi_map_large	The same with BENCH_MAP_RULES rules (Should cost the same)
+	param_law_float	ParamLaw::ToFloat(), Hz -> XR18 EQ frequency float (Table)
+	param_law_units	ParamLaw::ToUnits(), the other way
+	param_law_libm	The same law with log / pow (What the tables replace)
+	mod_tick		Modulator::Tick(), MOD_MAX LFOs (All waves) into bundles, per tick
+	e2e_latency		CC written to a pty -> Serial read thread -> MIDIParser ->
+					EncodeInt -> UDPSocket -> loopback datagram received
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <stdio.h>												//
+#include <stdlib.h>												// posix_openpt(), qsort()
+#include <string.h>												//
+#include <unistd.h>												// write(), getopt()
+#include <fcntl.h>												// O_RDWR
+#include <termios.h>											// cfmakeraw()
+#include "../Clock.h"											// Time source
+#include "../MIDI.h"											// MIDI Parser
+#include "../Tempo.h"											// Tempo Tracker
+#include "../Timecode.h"										// MIDI Time Code
+#include "../OSC.h"												// OSC Encode / Decode
+#include "../Trace.h"											// Flight Recorder
+#include "../Timing.h"											// Profiling Zones
+#include "../EventLoop.h"										// Timer Wheel
+#include "../Serial.h"											// Serial Class
+#include "../UDPSocket.h"										// UDP Socket Class
+#include "../MIDIMap.h"											// MIDI to OSC map
+#include "../ParamLaw.h"										// XR18 parameter laws
+#include "../Modulator.h"										// Ramps / LFOs
+
+// ------------------------------------------------------------------------------------ //
+// Constants
+#define BENCH_STREAM		(1024 * 1024)						// MIDI stream size
+#define BENCH_E2E_COUNT		2000								// End-to-end round trips
+#define BENCH_E2E_PORT		39000								// Loopback UDP port (+ pid % 1000)
+#define BENCH_TRACE_FILE	"/tmp/MOLinkBench.trace"			//
+#define BENCH_TIMERS		4096								// Timers armed for loop_timer
+#define BENCH_MAP_RULES		768									// Rules in midi_map_large (16 channels x 48 CCs)
+
+// ------------------------------------------------------------------------------------ //
+// Globals
+static volatile uint32_t Sink;									// Keeps results alive
+static Serial *BenchUART;										// End-to-end, MIDI IN
+static UDPSocket *BenchSKT;										// End-to-end, OSC OUT
+static MIDIParser BenchParser;									// End-to-end, parser
+
+// ------------------------------------------------------------------------------------ //
+// Report throughput result
+static void Report(const char *Name, uint64_t Ops, uint64_t Ns)
+{
+	printf("{\"bench\":\"%s\",\"ops\":%llu,\"ns_per_op\":%.3f,\"ops_per_sec\":%.0f}\n", Name,
+		(unsigned long long)Ops, (double)Ns / Ops, Ops / (Ns / 1e9));
+	fflush(stdout);
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI Parse throughput
+static void BenchMIDIParse(void)
+{
+	uint8_t *Stream = new uint8_t[BENCH_STREAM];				//
+	MIDIParser Parser;											//
+	MIDIMessage Msg;											//
+	uint64_t Start, Msgs = 0;									//
+	int Ptr = 0, N = 0;											//
+
+	while(Ptr < BENCH_STREAM - 8){								// Build stream
+		Stream[Ptr++] = MIDI_TICK;								// Clock tick
+		if((++N % 8) == 0){										// Every 8 ticks a CC
+			if((N % 16) == 0){ Stream[Ptr++] = MIDI_CC; }		// Running status every other one
+			Stream[Ptr++] = 0x50;								//
+			Stream[Ptr++] = N & 0x7F;							//
+		}
+		if((N % 24) == 0){										// Note on, tick in the middle
+			Stream[Ptr++] = MIDI_NOTE_ON;						//
+			Stream[Ptr++] = 60;									//
+			Stream[Ptr++] = MIDI_TICK;							//
+			Stream[Ptr++] = 100;								//
+			Stream[Ptr++] = MIDI_CC;							// Restore CC running status
+			Stream[Ptr++] = 0x51;								//
+			Stream[Ptr++] = 0;									//
+		}
+	}
+	Stream[0] = MIDI_CC;										// Start with a status
+
+	Start = CLK->Now();											//
+	for(int Rep = 0; Rep < 20; Rep++){							//
+		for(int B = 0; B < Ptr; B++){							//
+			if(Parser.Parse(Stream[B], &Msg)){					//
+				Msgs++;											//
+				Sink += Msg.Raw[0];								//
+			}
+		}
+	}
+	Report("midi_parse", (uint64_t)Ptr * 20, CLK->Now() - Start);	// Per byte
+	delete []Stream;											//
+	(void)Msgs;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// OSC Encode / Decode
+static void BenchOSC(void)
+{
+	char Buff[OSC_MSG_MAX];										//
+	OSCMessage Msg;												//
+	uint64_t Start;												//
+	const int Count = 2000000;									//
+	int Len = 0;												//
+
+	Start = CLK->Now();											//
+	for(int I = 0; I < Count; I++){								//
+		Len = RPiOSC::EncodeInt(Buff, sizeof(Buff), "/config/mute/1", I & 1);
+		Sink += Buff[Len - 1];									//
+	}
+	Report("osc_encode_int", Count, CLK->Now() - Start);		//
+
+	Start = CLK->Now();											//
+	for(int I = 0; I < Count; I++){								//
+		Len = RPiOSC::EncodeFloat(Buff, sizeof(Buff), "/fx/3/par/01", I * 0.0001f);
+		Sink += Buff[Len - 1];									//
+	}
+	Report("osc_encode_float", Count, CLK->Now() - Start);		//
+
+	Start = CLK->Now();											//
+	for(int I = 0; I < Count; I++){								//
+		Buff[Len - 1] = (char)I;								// Defeat hoisting
+		if(RPiOSC::Decode(Buff, Len, &Msg)){					//
+			Sink += (uint32_t)Msg.Float;						//
+		}
+	}
+	Report("osc_decode", Count, CLK->Now() - Start);			//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Tempo estimator cost per tick
+static void BenchTempo(void)
+{
+	TempoTracker Tracker;										//
+	uint64_t Start, Time = NS_PER_SEC;							//
+	const int Count = 10000000;									//
+
+	Start = CLK->Now();											//
+	for(int I = 0; I < Count; I++){								//
+		Time += 20833333 + (I & 0xFFF);							// ~120 BPM with jitter
+		Sink += Tracker.Tick(Time);								//
+	}
+	Report("tempo_tick", Count, CLK->Now() - Start);			//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI time code decoder cost per quarter frame (Frames counted up from 00:00:00:00)
+static void BenchTimecode(void)
+{
+	MIDITimecode *Mtc = new MIDITimecode();						//
+	uint8_t *Data = new uint8_t[BENCH_STREAM];					//
+	uint64_t Start, Time = NS_PER_SEC;							//
+	int H, M, S, F, Nibble[MTC_PIECES];							//
+
+	for(int I = 0; I < BENCH_STREAM; I += MTC_PIECES){			// Quarter frame data bytes
+		MIDITimecode::Label((I / MTC_PIECES) * 2, MTC_25, &H, &M, &S, &F);	//
+		Nibble[0] = F & 0x0F; Nibble[1] = F >> 4; Nibble[2] = S & 0x0F; Nibble[3] = S >> 4;
+		Nibble[4] = M & 0x0F; Nibble[5] = M >> 4; Nibble[6] = H & 0x0F; Nibble[7] = (H >> 4) | (MTC_25 << 1);
+		for(int P = 0; P < MTC_PIECES; P++){					//
+			Data[I + P] = (uint8_t)((P << 4) | Nibble[P]);		//
+		}
+	}
+	Start = CLK->Now();											//
+	for(int I = 0; I < BENCH_STREAM; I++){						//
+		Time += 10000000 + (I & 0xFFF);							// 25 fps with jitter
+		Sink += Mtc->QuarterFrame(Data[I], Time);				//
+	}
+	Report("mtc_quarter", BENCH_STREAM, CLK->Now() - Start);	//
+	delete[] Data;												//
+	delete Mtc;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Trace ring throughput
+static void BenchTrace(void)
+{
+	Trace *T = new Trace();										//
+	uint64_t Start;												//
+	const int Count = 10000000;									//
+
+	if(!T->Open(BENCH_TRACE_FILE)){								//
+		delete T;												//
+		return;													//
+	}
+	Start = CLK->Now();											//
+	for(int I = 0; I < Count; I++){								//
+		T->Log(TRC_USER, I, I >> 8);							//
+	}
+	Report("trace_log", Count, CLK->Now() - Start);				//
+	delete T;													//
+	unlink(BENCH_TRACE_FILE);									//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Profiling zone overhead
+static void BenchProfile(void)
+{
+	uint64_t Start;												//
+	const int Count = 10000000;									//
+
+	Start = CLK->Now();											//
+	for(int I = 0; I < Count; I++){								//
+		PROFILE_ZONE("Bench");									//
+		Sink += I;												//
+	}
+	Report("profile_zone", Count, CLK->Now() - Start);			//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Timer wheel, re-arm cost with many timers waiting (1 mS .. 1 minute out)
+static void BenchLoopTimer(void)
+{
+	EventLoop *Loop = new EventLoop();							// Not opened, wheel only
+	LoopTimer *Timers = new LoopTimer[BENCH_TIMERS];			//
+	uint64_t Start, Now = CLK->Now();							//
+	uint32_t Seed = 1;											//
+	const int Count = 10000000;									//
+
+	memset(Timers, 0, sizeof(LoopTimer) * BENCH_TIMERS);		//
+	for(int I = 0; I < BENCH_TIMERS; I++){						//
+		Seed = (Seed * 1103515245) + 12345;						// LCG, repeatable
+		Loop->StartTimer(&Timers[I], Now + ((Seed >> 8) % 60000 + 1) * NS_PER_MS);	//
+	}
+
+	Start = CLK->Now();											//
+	for(int I = 0; I < Count; I++){								// Push one timer out, as a debounce / keepalive does
+		LoopTimer *T = &Timers[I & (BENCH_TIMERS - 1)];			//
+		Loop->StartTimer(T, T->Due + NS_PER_MS);				//
+	}
+	Report("loop_timer", Count, CLK->Now() - Start);			//
+
+	delete Loop;												// Unlinks the timers
+	delete []Timers;											//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MIDI map lookup, small and large map. Values 64-127 so the toggles (0-63) never send.
+static void BenchMIDIMap(void)
+{
+	RPiOSC *Osc = new RPiOSC();									// Not opened, nothing is sent
+	MIDIMap *Map = new MIDIMap();								//
+	char *Text = new char[BENCH_MAP_RULES * 48];				//
+	MIDIMessage Msg;											//
+	uint64_t Start;												//
+	const int Count = 10000000;									//
+	int Len = 0;												//
+
+	Msg.Len = 3;												//
+	Msg.SysEx = NULL;											//
+	Msg.SysExLen = 0;											//
+	Map->Open(Osc, NULL);										//
+	for(int Size = 4; Size <= BENCH_MAP_RULES; Size = (Size == 4) ? BENCH_MAP_RULES : Size + 1){
+		Len = 0;												//
+		for(int R = 0; R < Size; R++){							//
+			Len += sprintf(&Text[Len], "cc %d %d 0-63 toggle /ch/%02d/mix/on i\n", (R % 16) + 1, R / 16, (R % 16) + 1);
+		}
+		if(!Map->LoadText(Text)){								//
+			break;												//
+		}
+		Start = CLK->Now();										//
+		for(int I = 0; I < Count; I++){							//
+			Msg.Raw[0] = MIDI_CC | (I & 0x0F);					//
+			Msg.Raw[1] = (I >> 4) & 0x3F;						// Mapped and unmapped CCs
+			Msg.Raw[2] = 64 + (I & 0x3F);						//
+			Sink += Map->Message(&Msg);							//
+		}
+		Report((Size == 4) ? "midi_map_small" : "midi_map_large", Count, CLK->Now() - Start);	//
+	}
+	delete Map;													//
+	delete Osc;													//
+	delete []Text;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Parameter law conversions, 20 Hz .. 20 kHz log law, table vs log / pow
+static void BenchParamLaw(void)
+{
+	int Law = ParamLaw::Find("freq", 4);						//
+	uint64_t Start;												//
+	const int Count = 10000000;									//
+	float Sum = 0;												//
+
+	Start = CLK->Now();											//
+	for(int I = 0; I < Count; I++){								//
+		Sum += ParamLaw::ToFloat(Law, 20 + (I & 0x3FFF) * 1.2f);	// 20 .. 19680 Hz
+	}
+	Report("param_law_float", Count, CLK->Now() - Start);		//
+	Start = CLK->Now();											//
+	for(int I = 0; I < Count; I++){								//
+		Sum += ParamLaw::ToUnits(Law, (I & 0x3FFF) * (1.0f / 0x3FFF));	//
+	}
+	Report("param_law_units", Count, CLK->Now() - Start);		//
+	Start = CLK->Now();											//
+	for(int I = 0; I < Count; I++){								//
+		Sum += ParamLaw::Exact(Law, (I & 0x3FFF) * (1.0f / 0x3FFF));	//
+	}
+	Report("param_law_libm", Count, CLK->Now() - Start);		//
+	Sink += (uint32_t)Sum;										//
+}
+
+// ------------------------------------------------------------------------------------ //
+// End-to-end, Serial read event: parse and forward CCs as OSC
+static void *BenchMIDIRead(void)
+{
+	char Buff[RX_BUFFER_SIZE + 1];								//
+	char Out[OSC_MSG_MAX];										//
+	MIDIMessage Msg;											//
+	int Len, OLen;												//
+
+	Len = BenchUART->SerialRead(Buff);							//
+	for(int Ptr = 0; Ptr < Len; Ptr++){							//
+		if(BenchParser.Parse((uint8_t)Buff[Ptr], &Msg)&&((Msg.Raw[0] & 0xF0) == MIDI_CC)){
+			OLen = RPiOSC::EncodeInt(Out, sizeof(Out), "/ch/01/mix/on", Msg.Raw[2]);
+			BenchSKT->SocketWrite(Out, OLen);					//
+		}
+	}
+	return NULL;
+}
+
+// ------------------------------------------------------------------------------------ //
+static int CompareU64(const void *A, const void *B)
+{
+	uint64_t VA = *(const uint64_t *)A, VB = *(const uint64_t *)B;	//
+	return (VA < VB) ? -1 : (VA > VB) ? 1 : 0;					//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Modulator tick, every slot an LFO, a new value for each of them (Nearly) every tick
+static void BenchModulator(void)
+{
+	RPiOSC *Osc = new RPiOSC();									// Not opened, nothing is sent
+	Modulator *Mod = new Modulator();							//
+	char Address[MOD_ADDRESS_MAX];								//
+	uint64_t Start;												//
+	const int Count = 200000;									//
+
+	Mod->Open(NULL, Osc);										// No loop, Tick() by hand
+	for(int I = 0; I < MOD_MAX; I++){							//
+		sprintf(Address, "/ch/%02d/mix/pan", I + 1);			//
+		Mod->Lfo(Address, true, 0, 1, MOD_SINE + (I % 4), 1 + (I % 3));	//
+	}
+	Start = CLK->Now();											//
+	for(int I = 0; I < Count; I++){								//
+		Sink += Mod->Tick();									//
+	}
+	Report("mod_tick", Count, CLK->Now() - Start);				//
+	delete Mod;													//
+	delete Osc;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// End-to-end latency, pty -> Serial -> Parser -> OSC -> UDP loopback
+static void BenchEndToEnd(void)
+{
+	int Master, Port, Got = 0, Lost = 0;						//
+	struct termios Raw;											//
+	uint64_t *Lat = new uint64_t[BENCH_E2E_COUNT];				//
+	uint64_t Start, Deadline;									//
+	uint8_t CC[3] = {MIDI_CC, 0x50, 0};							//
+	char Buff[OSC_MSG_MAX];										//
+
+	if(((Master = posix_openpt(O_RDWR | O_NOCTTY)) < 0)||(grantpt(Master) != 0)||(unlockpt(Master) != 0)){
+		printf("{\"bench\":\"e2e_latency\",\"error\":\"pty\"}\n");
+		return;
+	}
+	tcgetattr(Master, &Raw);									// Raw, bytes go through untouched
+	cfmakeraw(&Raw);											//
+	tcsetattr(Master, TCSANOW, &Raw);							//
+
+	BenchUART = new Serial();									//
+	BenchSKT = new UDPSocket();									//
+	Port = BENCH_E2E_PORT + (getpid() % 1000);					// Socket sends to itself
+	if((BenchUART->SerialOpen(ptsname(Master), 38400) < 0)||(BenchSKT->SocketConnect("127.0.0.1", Port) < 0)){
+		printf("{\"bench\":\"e2e_latency\",\"error\":\"open\"}\n");
+		close(Master);
+		return;
+	}
+	BenchUART->SetOnReadEvent(&BenchMIDIRead);					//
+	usleep(100000);												// Let threads start
+
+	for(int I = 0; I < BENCH_E2E_COUNT; I++){					//
+		CC[2] = I & 0x7F;										//
+		Start = CLK->Now();										//
+		Deadline = Start + NS_PER_SEC;							// 1s time-out
+		if(write(Master, CC, sizeof(CC)) != sizeof(CC)){		//
+			Lost++;												//
+			continue;											//
+		}
+		while((BenchSKT->SocketRead(Buff, sizeof(Buff)) <= 0)&&(CLK->Now() < Deadline)){}
+		if(CLK->Now() >= Deadline){								// Lost?
+			Lost++;												//
+			continue;											//
+		}
+		Lat[Got++] = CLK->Now() - Start;						//
+	}
+
+	BenchUART->SerialClose();									//
+	BenchSKT->SocketClose();									//
+	close(Master);												//
+
+	if(Got > 0){												//
+		qsort(Lat, Got, sizeof(uint64_t), CompareU64);			//
+		printf("{\"bench\":\"e2e_latency\",\"ops\":%d,\"lost\":%d,\"p50_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f}\n",
+			Got, Lost, Lat[Got / 2] / 1e3, Lat[(Got * 99) / 100] / 1e3, Lat[Got - 1] / 1e3);
+	}else{
+		printf("{\"bench\":\"e2e_latency\",\"ops\":0,\"lost\":%d}\n", Lost);
+	}
+	delete []Lat;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MAIN
+int main(int argc, char **argv)
+{
+	bool EndToEnd = true;										//
+	int Opt;													//
+
+	while((Opt = getopt(argc, argv, "x")) != -1){				//
+		if(Opt == 'x'){											//
+			EndToEnd = false;									//
+		}else{
+			printf("Usage: %s [-x]\r\n", argv[0]);
+			return 1;
+		}
+	}
+
+	BenchMIDIParse();											//
+	BenchOSC();													//
+	BenchTempo();												//
+	BenchTimecode();											//
+	BenchTrace();												//
+	BenchProfile();												//
+	BenchLoopTimer();											//
+	BenchMIDIMap();												//
+	BenchParamLaw();											//
+	BenchModulator();											//
+	if(EndToEnd){												//
+		BenchEndToEnd();										//
+	}
+
+	return 0;
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
@@ -0,0 +1,140 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			Trace Decoder for Linux
+Filename:		TraceDump.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Decodes a MOLink flight-recorder file (see Trace.h). Records from all
+				thread rings are merged and printed in time order.
+
+// ------------------------------------------------------------------------------------ //
+Setting up:
+
+Make - 'make tools'
+
+Execute - 'Tools/TraceDump MOLink.trace' or 'Tools/TraceDump MOLink.trace.old'
+
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <stdio.h>												//
+#include <stdlib.h>												// qsort()
+#include <string.h>												//
+#include <unistd.h>												//
+#include <fcntl.h>												// open()
+#include <sys/mman.h>											// mmap()
+#include <sys/stat.h>											// fstat()
+#include "../Trace.h"											// Trace Layout
+
+// ------------------------------------------------------------------------------------ //
+// Decoded record
+typedef struct _dumpRecord{
+	const TraceRecord *Rec;										// Record
+	int Ring;													// Ring index
+} DumpRecord;
+
+// ------------------------------------------------------------------------------------ //
+// Sort by time, then ring
+static int CompareRecord(const void *A, const void *B)
+{
+	const DumpRecord *RA = (const DumpRecord *)A;				//
+	const DumpRecord *RB = (const DumpRecord *)B;				//
+
+	if(RA->Rec->Time != RB->Rec->Time){							//
+		return (RA->Rec->Time < RB->Rec->Time) ? -1 : 1;		//
+	}
+	return RA->Ring - RB->Ring;									//
+}
+
+// ------------------------------------------------------------------------------------ //
+// MAIN
+int main(int argc, char **argv)
+{
+	int Fd;														//
+	struct stat St;												//
+	const TraceHeader *Hdr;										//
+	const TraceRing *Rings;										//
+	DumpRecord *List;											//
+	int Count = 0;												//
+	uint32_t Used;												//
+	uint64_t Head, First;										//
+
+	if(argc < 2){												// File name?
+		printf("Usage: %s <trace file>\r\n", argv[0]);
+		return 1;
+	}
+
+	if(((Fd = open(argv[1], O_RDONLY)) < 0)||(fstat(Fd, &St) != 0)){
+		printf("ERROR!!! Can't Open %s\r\n", argv[1]);
+		return 1;
+	}
+	if((size_t)St.st_size < sizeof(TraceHeader)){				// Too small?
+		printf("ERROR!!! Not a trace file\r\n");
+		return 1;
+	}
+	Hdr = (const TraceHeader *)mmap(NULL, St.st_size, PROT_READ, MAP_PRIVATE, Fd, 0);
+	if(Hdr == MAP_FAILED){										//
+		printf("ERROR!!! Can't Map %s\r\n", argv[1]);
+		return 1;
+	}
+	if((Hdr->Magic != TRACE_MAGIC)||(Hdr->Version != TRACE_VERSION)||
+	   (Hdr->Records != TRACE_RECORDS)||(Hdr->RecordSize != sizeof(TraceRecord))||
+	   ((size_t)St.st_size < sizeof(TraceHeader) + (Hdr->Threads * sizeof(TraceRing)))){
+		printf("ERROR!!! Unsupported trace file\r\n");
+		return 1;
+	}
+	Rings = (const TraceRing *)&Hdr[1];							//
+	Used = (Hdr->Used < Hdr->Threads) ? Hdr->Used : Hdr->Threads;
+
+	printf("PID %u, %u thread(s), started %llu.%09llu (realtime)\r\n", Hdr->Pid, Used,
+		(unsigned long long)(Hdr->RealStart / 1000000000ULL), (unsigned long long)(Hdr->RealStart % 1000000000ULL));
+
+	// Collect valid records from every ring
+	List = new DumpRecord[Used * TRACE_RECORDS];				//
+	for(uint32_t R = 0; R < Used; R++){							//
+		Head = Rings[R].Head;									//
+		First = 0;												//
+		if(Head > TRACE_RECORDS){								// Wrapped? The last TRACE_RECORDS are there
+			First = Head - TRACE_RECORDS;						//
+			if(Rings[R].Rec[First & (TRACE_RECORDS - 1)].Time == 0){	// Oldest being overwritten? (Time goes in last)
+				First++;										//
+			}
+		}
+		printf("Ring %u: tid %u '%.*s' %llu record(s)%s\r\n", R, Rings[R].Tid, (int)sizeof(Rings[R].Name), Rings[R].Name,
+			(unsigned long long)Head, (First > 0) ? " (wrapped)" : "");
+		for(uint64_t H = First; H < Head; H++){					//
+			List[Count].Rec = &Rings[R].Rec[H & (TRACE_RECORDS - 1)];
+			List[Count].Ring = R;								//
+			Count++;											//
+		}
+	}
+	qsort(List, Count, sizeof(DumpRecord), CompareRecord);		// Merge rings
+
+	// Print
+	printf("\r\n%16s %4s %-12s %s\r\n", "TIME (s)", "RING", "EVENT", "ARGS");
+	for(int Ptr = 0; Ptr < Count; Ptr++){						//
+		const TraceRecord *Rec = List[Ptr].Rec;					//
+		long long Rel = (long long)(Rec->Time - Hdr->MonoStart);	// Relative to open
+		printf("%6lld.%09lld %4d %-12s", Rel / 1000000000LL, Rel % 1000000000LL, List[Ptr].Ring, Trace::EventName(Rec->Event));
+		if(Rec->Event >= TRC_USER){								// Unknown event id?
+			printf(" #%u", Rec->Event);							//
+		}
+		for(int A = 0; A < TRACE_ARGS; A++){					//
+			printf(" %08X", Rec->Arg[A]);						//
+		}
+		printf("\r\n");
+	}
+
+	delete []List;												//
+	munmap((void *)Hdr, St.st_size);							//
+	close(Fd);													//
+
+	return 0;
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
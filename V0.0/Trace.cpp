@@ -0,0 +1,220 @@
+/*
+// ------------------------------------------------------------------------------------ //
+Title:			Trace (Flight Recorder) for RPi - Linux
+Filename:		Trace.cpp
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Binary flight-recorder.
+
+// ------------------------------------------------------------------------------------ //
+Notes:
+	# Each thread claims its own ring on its first Log(), so writers never share a
+	  cache line or a lock. A record is filled in place and then published by
+	  bumping the ring's Head (release store). A crash can only lose the record
+	  being written. In a wrapped ring that is the oldest slot: its Time is
+	  zeroed first and written last, so the decoder drops it if Time is 0.
+	# The file is MAP_SHARED, so the kernel keeps the pages after the process dies.
+	  The previous trace is renamed to '<FileName>.old' on open.
+	# Decode with: 'Tools/TraceDump MOLink.trace'
+// ------------------------------------------------------------------------------------ //
+*/
+
+// ------------------------------------------------------------------------------------ //
+// Includes
+#include <stdio.h>												// printf(), rename()
+#include <string.h>												// memset(), strncpy()
+#include <unistd.h>												// ftruncate(), getpid()
+#include <fcntl.h>												// open()
+#include <time.h>												// clock_gettime()
+#include <sys/mman.h>											// mmap()
+#include <sys/syscall.h>										// SYS_gettid
+#include "Trace.h"												// Trace Class
+
+// ------------------------------------------------------------------------------------ //
+// Globals
+Trace *TRC = NULL;												// Global Trace
+
+static __thread TraceRing *ThreadRing = NULL;					// Calling thread's ring
+static __thread bool ThreadFull = false;						// No ring left for this thread
+
+// ------------------------------------------------------------------------------------ //
+// Event Names
+static const char *EventNames[TRC_USER] = {
+	"NONE", "START", "THREAD", "MIDI_RX", "MIDI_TX", "MIDI_OVF",
+	"OSC_TX", "OSC_TX_ERR", "OSC_RX", "BPM", "TEMPO_MODE", "TEMPO_SEND",
+	"FTSW", "GPIO_EDGE", "MIDI_TX_OVF", "TRANSPORT", "MTC",
+	"TEMPO_SOURCE"
+};
+
+// ------------------------------------------------------------------------------------ //
+// Constructor
+Trace::Trace()
+{
+	Fd = -1;													// Initialise File Descriptor as error
+	MapSize = 0;												//
+	Hdr = NULL;													//
+	Rings = NULL;												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// De-constructor
+Trace::~Trace()
+{
+	Close();													// Unmap & Close
+}
+
+// ------------------------------------------------------------------------------------ //
+// Open (Create) Trace File and map it
+bool Trace::Open(const char *FileName)
+{
+	char OldName[256];											//
+
+	Close();													// Close any previous trace
+
+	snprintf(OldName, sizeof(OldName), "%s.old", FileName);	// Keep the last trace (e.g. after a crash)
+	rename(FileName, OldName);									//
+
+	if((Fd = open(FileName, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0){
+		printf("\r\nERROR!!! Can't Open Trace File...\r\n");
+		return false;
+	}
+
+	MapSize = sizeof(TraceHeader) + (sizeof(TraceRing) * TRACE_THREADS);
+	if(ftruncate(Fd, MapSize) != 0){							// Size file
+		printf("\r\nERROR!!! Can't Size Trace File...\r\n");
+		Close();
+		return false;
+	}
+
+	Hdr = (TraceHeader *)mmap(NULL, MapSize, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+	if(Hdr == MAP_FAILED){										// Mapped?
+		printf("\r\nERROR!!! Can't Map Trace File...\r\n");
+		Hdr = NULL;
+		Close();
+		return false;
+	}
+	Rings = (TraceRing *)&Hdr[1];								// Rings follow the header
+
+	memset(Hdr, 0, sizeof(TraceHeader));						// Fill in header
+	Hdr->Version = TRACE_VERSION;								//
+	Hdr->Threads = TRACE_THREADS;								//
+	Hdr->Records = TRACE_RECORDS;								//
+	Hdr->RecordSize = sizeof(TraceRecord);						//
+	Hdr->Pid = getpid();										//
+	Hdr->MonoStart = Now();										//
+	Hdr->RealStart = 0;											//
+	{
+		struct timespec Ts;										//
+		clock_gettime(CLOCK_REALTIME, &Ts);						//
+		Hdr->RealStart = ((uint64_t)Ts.tv_sec * 1000000000ULL) + Ts.tv_nsec;
+	}
+	__atomic_store_n(&Hdr->Magic, TRACE_MAGIC, __ATOMIC_RELEASE);	// Valid from here on
+
+	Log(TRC_START, Hdr->Pid);									//
+
+	return true;												// Return Success
+}
+
+// ------------------------------------------------------------------------------------ //
+// Close Trace File. (Data is already in the page cache, msync only hurries it along)
+void Trace::Close(void)
+{
+	if(Hdr != NULL){											// Mapped?
+		msync(Hdr, MapSize, MS_ASYNC);							// Schedule write back
+		munmap(Hdr, MapSize);									//
+		Hdr = NULL;												//
+		Rings = NULL;											//
+	}
+	if(Fd >= 0){												// Open?
+		close(Fd);												//
+		Fd = -1;												//
+	}
+}
+
+// ------------------------------------------------------------------------------------ //
+// Claim a ring for the calling thread
+TraceRing *Trace::ClaimRing(void)
+{
+	uint32_t Idx;												//
+	TraceRing *R;												//
+
+	if(ThreadFull || (Hdr == NULL)){							// Already failed?
+		return NULL;											//
+	}
+
+	Idx = __atomic_fetch_add(&Hdr->Used, 1, __ATOMIC_RELAXED);	// Next free ring
+	if(Idx >= TRACE_THREADS){									// All rings taken?
+		ThreadFull = true;										//
+		return NULL;											//
+	}
+
+	R = &Rings[Idx];											//
+	R->Tid = (uint32_t)syscall(SYS_gettid);						//
+	ThreadRing = R;												//
+	Log(TRC_THREAD, R->Tid);									//
+
+	return R;													//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Name the calling thread's ring (shown by the decoder)
+void Trace::SetThreadName(const char *Name)
+{
+	TraceRing *R = ThreadRing;									//
+
+	if((R == NULL)&&((R = ClaimRing()) == NULL)){				// No ring?
+		return;													//
+	}
+	strncpy(R->Name, Name, sizeof(R->Name) - 1);				//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Log an event. Lock-free, single writer per ring.
+void Trace::Log(uint32_t Event, uint32_t A0, uint32_t A1, uint32_t A2, uint32_t A3, uint32_t A4)
+{
+	TraceRing *R = ThreadRing;									//
+	TraceRecord *Rec;											//
+	uint64_t H;													//
+
+	if((R == NULL)&&((R = ClaimRing()) == NULL)){				// No ring?
+		return;													//
+	}
+
+	H = R->Head;												// Only this thread writes Head
+	Rec = &R->Rec[H & (TRACE_RECORDS - 1)];						//
+	__atomic_store_n(&Rec->Time, 0, __ATOMIC_RELAXED);			// Claimed, not complete
+	__atomic_thread_fence(__ATOMIC_RELEASE);					// Before the fields
+	Rec->Event = Event;											//
+	Rec->Arg[0] = A0;											//
+	Rec->Arg[1] = A1;											//
+	Rec->Arg[2] = A2;											//
+	Rec->Arg[3] = A3;											//
+	Rec->Arg[4] = A4;											//
+	__atomic_store_n(&Rec->Time, Now(), __ATOMIC_RELEASE);		// Complete
+	__atomic_store_n(&R->Head, H + 1, __ATOMIC_RELEASE);		// Publish
+}
+
+// ------------------------------------------------------------------------------------ //
+// CLOCK_MONOTONIC in nano seconds
+uint64_t Trace::Now(void)
+{
+	struct timespec Ts;											//
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);						// vDSO, no system call
+	return ((uint64_t)Ts.tv_sec * 1000000000ULL) + Ts.tv_nsec;	//
+}
+
+// ------------------------------------------------------------------------------------ //
+// Event Name
+const char *Trace::EventName(uint32_t Event)
+{
+	if((Event < TRC_USER)&&(EventNames[Event] != NULL)){		// Known?
+		return EventNames[Event];								//
+	}
+	return "USER";												//
+}
+
+// ------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------ //
@@ -0,0 +1,119 @@
+/*
+// -------------------------------------------------------------------------------------
+Title:			Trace (Flight Recorder) Header for RPi - Linux
+Filename:		Trace.h
+Author:			Paul Vilas-Boas
+Version:		0.0
+Date:			19/10/2026
+
+Description:	Binary flight-recorder. Each thread owns a lock-free ring of fixed size
+				records inside a shared mmap'd file, so the trace survives a crash and
+				can be decoded afterwards with 'Tools/TraceDump'.
+
+// -------------------------------------------------------------------------------------
+*/
+
+#ifndef _TRACE_H
+#define _TRACE_H
+
+// -------------------------------------------------------------------------------------
+// Includes
+#include <stdint.h>												// Fixed width types
+#include <stddef.h>												// size_t
+#include "config.h"												// General Configuration File
+
+// -------------------------------------------------------------------------------------
+// Constants
+#define TRACE_MAGIC			0x45434152544B4C4DULL				// "MLKTRACE"
+#define TRACE_VERSION		1									// File format version
+#define TRACE_THREADS		8									// Maximum traced threads (one ring each)
+#define TRACE_RECORDS		4096								// Records per ring (Power of 2)
+#define TRACE_ARGS			5									// Arguments per record
+
+// -------------------------------------------------------------------------------------
+// Trace Events
+enum TraceEventId
+{
+	TRC_NONE = 0,												// Unused
+	TRC_START,													// Trace opened			(pid)
+	TRC_THREAD,													// Thread ring claimed	(tid)
+	TRC_MIDI_RX,												// MIDI chunk read		(len, bytes 0-3, 4-7)
+	TRC_MIDI_TX,												// MIDI written			(len, bytes 0-3)
+	TRC_MIDI_OVF,												// MIDI buffer overflow	(len)
+	TRC_OSC_TX,													// OSC datagram sent	(len)
+	TRC_OSC_TX_ERR,												// OSC send failed		(errno)
+	TRC_OSC_RX,													// OSC datagram waiting	(len)
+	TRC_BPM,													// BPM estimate			(bpm, us)
+	TRC_TEMPO_MODE,												// Tempo mode			(auto)
+	TRC_TEMPO_SEND,												// Tempo sent to OSC	(ms tempo)
+	TRC_FTSW,													// Foot switch			(channel, result)
+	TRC_GPIO_EDGE,												// GPIO input edge		(pin, level)
+	TRC_MIDI_TX_OVF,											// MIDI OUT queue full	(len, queued)
+	TRC_TRANSPORT,												// Transport changed	(state, song position)
+	TRC_MTC,													// MIDI time code		(0 lost / 1 locked / 2 full frame, frames)
+	TRC_TEMPO_SOURCE,											// Tempo source followed	(source, bpm)
+	TRC_USER													// First free event id
+};
+
+// -------------------------------------------------------------------------------------
+// File Layout (All little-endian, native on the RPi)
+typedef struct _traceRecord{
+	uint64_t Time;												// CLOCK_MONOTONIC in nS
+	uint32_t Event;												// TraceEventId
+	uint32_t Arg[TRACE_ARGS];									// Arguments
+} TraceRecord;													// 32 bytes
+
+typedef struct _traceRing{
+	volatile uint64_t Head;										// Records written (Owner thread only)
+	uint32_t Tid;												// Owner thread ID
+	char Name[20];												// Owner thread name
+	char Pad[32];												// Align records to a cache line
+	TraceRecord Rec[TRACE_RECORDS];								// Ring
+} TraceRing;
+
+typedef struct _traceHeader{
+	uint64_t Magic;												// TRACE_MAGIC
+	uint32_t Version;											// TRACE_VERSION
+	uint32_t Threads;											// Number of rings
+	uint32_t Records;											// Records per ring
+	uint32_t RecordSize;										// sizeof(TraceRecord)
+	volatile uint32_t Used;										// Rings claimed
+	uint32_t Pid;												// Process ID
+	uint64_t MonoStart;											// CLOCK_MONOTONIC at open (nS)
+	uint64_t RealStart;											// CLOCK_REALTIME at open (nS)
+	char Pad[16];												// Pad to 64 bytes
+} TraceHeader;
+
+// -------------------------------------------------------------------------------------
+// Define Trace Class
+class Trace
+{
+private:
+	int Fd;														// Trace file
+	size_t MapSize;												// Mapping size
+	TraceHeader *Hdr;											// Mapped header
+	TraceRing *Rings;											// Mapped rings
+
+	TraceRing *ClaimRing(void);									//
+
+public:
+	Trace();													//
+	~Trace();													//
+
+	bool Open(const char *FileName);							// Create & map trace file
+	void Close(void);											//
+	void SetThreadName(const char *Name);						// Name calling thread's ring
+	void Log(uint32_t Event, uint32_t A0 = 0, uint32_t A1 = 0, uint32_t A2 = 0, uint32_t A3 = 0, uint32_t A4 = 0);
+
+	static uint64_t Now(void);									// CLOCK_MONOTONIC in nS
+	static const char *EventName(uint32_t Event);				// Event name for decoders
+};
+
+// -------------------------------------------------------------------------------------
+// Global Trace (NULL when tracing is off)
+extern Trace *TRC;												//
+
+#define TRACE(...)			do{ if(TRC != NULL){ TRC->Log(__VA_ARGS__); } }while(0)
+
+// -------------------------------------------------------------------------------------
+#endif
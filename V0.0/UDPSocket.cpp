@@ -25,8 +25,10 @@ Description:	Simple UDP Socket Library.
 #include <arpa/inet.h>
 #include <net/if.h>												// IFNAMSIZ
 #include <ifaddrs.h>											// getifaddrs()
+#include <errno.h>												// errno
 
 #include "UDPSocket.h"											//
+#include "Trace.h"												// Flight Recorder
 
 // ------------------------------------------------------------------------------------ //
 // Constructor
@@ -34,6 +36,7 @@ UDPSocket::UDPSocket(void)
 {
 	udpSocket = -1;												// Initialise File Descriptor as error
 	OnReadEventPtr = NULL;										// Clear Callback Function Pointer
+	SinkPtr = NULL;												// Write to network
 	RxThreadActive = false;										// Clear Thread Active
 	BytesAvailable = 0;											// Init.
 }
@@ -203,12 +206,18 @@ void UDPSocket::SocketWrite(const char *Msg, int Len)
 	socklen_t AddrSize;
 	
 	if(Length == 0){Length = strlen(Msg);}
+	if(SinkPtr != NULL){										// Stand-in?
+		SinkPtr(Msg, Length);									//
+		return;													//
+	}
 	if((Length > 0) && (udpSocket > 0)) {
 		// Send message to client, using serverStorage as the address
 		AddrSize = sizeof serverStorage;
 		if(sendto(udpSocket, Msg, Length, 0, (struct sockaddr *)&clientAddr, AddrSize) == -1){
-			printf("ERROR!!! Socket write failed\n");
+			TRACE(TRC_OSC_TX_ERR, errno, Length);				// Log, don't stall on the console
 			SocketClose();
+		}else{
+			TRACE(TRC_OSC_TX, Length);							//
 		}
 	}
 }
@@ -250,6 +259,13 @@ int UDPSocket::GetBytesAvailable(void)
 	return BytesAvailable;
 }
 
+// -------------------------------------------------------------------------------------
+// Divert writes to FnPtr instead of the network (Simulation). NULL to restore.
+void UDPSocket::SetSink(void (*FnPtr)(const char *, int))
+{
+	SinkPtr = FnPtr;
+}
+
 // -------------------------------------------------------------------------------------
 // Set On Read Event Function Pointer (OnReadEventPtr) / Set Callback Function
 //void Socket::SetOnReadEvent(void *(*FnPtr)(void))
@@ -284,6 +300,7 @@ void *UDPSocket::ReadThread(UDPSocket *C)
 		if(Ret != -1){											// OK?
 			C->BytesAvailable = Ret;
 			if((C->BytesAvailable > 0)&&(C->BytesAvailable != PrevBytes)){	// Bytes available?
+				TRACE(TRC_OSC_RX, C->BytesAvailable);			//
 				C->OnReadEvent();								// Call On Read Event
 				PrevBytes = C->BytesAvailable;					// 
 			}
@@ -293,6 +310,8 @@ void *UDPSocket::ReadThread(UDPSocket *C)
 		}
 	}while(C->RxThreadActive);									// Loop while RxThreadActive is set
 	C->RxThreadActive = false;									// Clear Thread Active
+	
+	return NULL;
 }
 
 // ------------------------------------------------------------------------------------ //
@@ -42,6 +42,7 @@ private:
 	bool RxThreadActive;										//
 	bool TxThreadActive;										//
 	void *(*OnReadEventPtr)(void);								//
+	void (*SinkPtr)(const char *, int);							// Write stand-in (Simulation)
 	
 	static void *ReadThread(UDPSocket *);						//
 	
@@ -62,6 +63,7 @@ public:
 	void SetBlocking(void);										//
 	int GetBytesAvailable(void);								//
 	
+	void SetSink(void (*FnPtr)(const char *, int));				// Divert writes (NULL = network)
 	void SetOnReadEvent(CallBack);								//
 	void OnReadEvent(void);										//
 };
@@ -19,6 +19,7 @@ Description:
 #define DEBUG                                     // Debug Mode
 #undef DEBUG                                      // Disable Debug Mode
 #define SETPROCESS    -20                         // Set Process Priority (-20-High, +20-Low)
+#define TRACE_FILE    "/home/pi/MOLink/MOLink.trace"  // Flight recorder file (Comment out to disable)
 
 // -------------------------------------------------------------------------------------
 // Fixed Settings
@@ -34,6 +35,19 @@ Description:
 #define LED_CH2       4                             // LED Channel 2 (GPIO_GEN4)
 #define LED_CH3       5                             // LED Channel 3 (GPIO_GEN5)
 #define STATUS_LED    7                             // Status Blue LED (GPIO_GCLK)
+#define GPIO_CHIP     "/dev/gpiochip0"              // GPIO character device for switch edges (Comment out to poll via wiringPi)
+
+// -------------------------------------------------------------------------------------
+// MIDI Settings
+#define MIDI_CLOCK_OUT                              // Send MIDI clock in Manual (tap) tempo, MOLink is master (Comment out to disable)
+#define MIDI_MTC_OUT  MTC_25                        // Send MIDI time code (MTC_24, MTC_25, MTC_30_DROP, MTC_30) with it, from 's' / 'c' (Comment out to disable)
+#define MIDI_PORTS_FILE "/home/pi/MOLink/ports.conf"  // More MIDI ports and thru routes (Skipped if missing, see MIDIPorts.cpp)
+#define MIDI_MAP_FILE   "/home/pi/MOLink/map.conf"    // MIDI to OSC map (Built in map if missing, see MIDIMap.cpp)
+
+// -------------------------------------------------------------------------------------
+// Tempo Settings
+#define TEMPO_PRIORITY  "tap clock osc mtc fixed"     // Tempo sources, first alive followed (clock, tap, mtc, osc, fixed)
+#define TEMPO_OSC_PORT  9100                          // OSC tempo input, '/tempo' <BPM> from any host (Comment out to disable)
 
 // -------------------------------------------------------------------------------------
 // Constants